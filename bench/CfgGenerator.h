@@ -0,0 +1,208 @@
+#pragma once
+
+#include <IR/include/Graph.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Seeded random CFGs for the analysis benchmarks. Every block has at most
+// two successors and is reachable from the entry (block 0).
+enum class CfgShape {
+  // structured code: straight blocks, if-then-else diamonds and loops
+  kReducible,
+  // structured code with extra edges into the middle of nearby regions
+  kIrreducible,
+  // loop nests up to 256 levels deep with short bodies
+  kNested,
+  // switches lowered to binary decision trees, some cases fall through
+  kSwitch,
+};
+
+class CfgGenerator {
+public:
+  CfgGenerator(CfgShape shape, uint32_t seed) : shape(shape), gen(seed) {}
+
+  // generate a graph of about 'size' blocks, the last region may overshoot
+  std::unique_ptr<Graph> Generate(size_t size) {
+    graph = std::make_unique<Graph>();
+    cursor = NewBlock();
+    openLoops.clear();
+
+    // leave room for the exits of the open loops
+    while (graph->GetSize() + openLoops.size() < size) {
+      GenerateRegion();
+    }
+    while (!openLoops.empty()) {
+      CloseLoop();
+    }
+    if (shape == CfgShape::kIrreducible) {
+      AddCrossEdges();
+    }
+    return std::move(graph);
+  }
+
+private:
+  static constexpr size_t kMaxDepth = 256;
+
+  BBlockPtr NewBlock() {
+    return graph->CreateBlock("B" + std::to_string(graph->GetSize()));
+  }
+
+  size_t Random(size_t bound) {
+    return std::uniform_int_distribution<size_t>(0, bound - 1)(gen);
+  }
+
+  // 'cursor' is the only block without successors, regions are appended
+  // to it and leave a new cursor
+  void Append(BBlockPtr block) {
+    graph->CreateEdge(cursor, block);
+    cursor = block;
+  }
+
+  void OpenLoop() {
+    BBlockPtr head = NewBlock();
+    Append(head);
+    openLoops.push_back(head);
+  }
+
+  void CloseLoop() {
+    BBlockPtr head = openLoops.back();
+    openLoops.pop_back();
+    // the latch branches back to the head and to the exit
+    graph->CreateEdge(cursor, head);
+    Append(NewBlock());
+  }
+
+  void Diamond() {
+    BBlockPtr thenBlock = NewBlock();
+    BBlockPtr elseBlock = NewBlock();
+    BBlockPtr join = NewBlock();
+    graph->CreateEdge(cursor, thenBlock);
+    graph->CreateEdge(cursor, elseBlock);
+    graph->CreateEdge(thenBlock, join);
+    graph->CreateEdge(elseBlock, join);
+    cursor = join;
+  }
+
+  // switch of 'numCases' cases: a binary tree of 'numCases - 1' decision
+  // blocks, every case jumps to the join or falls through to the next case
+  void Switch(size_t numCases) {
+    std::vector<BBlockPtr> cases(numCases);
+    for (auto &caseBlock : cases) {
+      caseBlock = NewBlock();
+    }
+    BBlockPtr join = NewBlock();
+    for (size_t i = 0; i < numCases; ++i) {
+      if (i + 1 < numCases && Random(4) == 0) {
+        graph->CreateEdge(cases[i], cases[i + 1]);
+      }
+      graph->CreateEdge(cases[i], join);
+    }
+
+    // decision tree over the case ranges, built breadth first
+    struct Range {
+      BBlockPtr block;
+      size_t first;
+      size_t last;
+    };
+    std::vector<Range> ranges{{cursor, 0, numCases}};
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      Range range = ranges[i];
+      size_t mid = (range.first + range.last) / 2;
+      for (auto half : {Range{nullptr, range.first, mid},
+                        Range{nullptr, mid, range.last}}) {
+        if (half.last - half.first == 1) {
+          graph->CreateEdge(range.block, cases[half.first]);
+        } else {
+          half.block = NewBlock();
+          graph->CreateEdge(range.block, half.block);
+          ranges.push_back(half);
+        }
+      }
+    }
+    cursor = join;
+  }
+
+  void GenerateRegion() {
+    switch (shape) {
+    case CfgShape::kReducible:
+    case CfgShape::kIrreducible:
+      switch (Random(8)) {
+      case 0:
+      case 1:
+        if (openLoops.size() < 8) {
+          OpenLoop();
+          return;
+        }
+        break;
+      case 2:
+      case 3:
+        if (!openLoops.empty()) {
+          CloseLoop();
+          return;
+        }
+        break;
+      case 4:
+      case 5:
+        Diamond();
+        return;
+      }
+      Append(NewBlock());
+      return;
+    case CfgShape::kNested:
+      if (openLoops.empty()) {
+        // descend to a random depth, then unwind with short bodies
+        nestDepth = 1 + Random(kMaxDepth);
+      }
+      if (openLoops.size() < nestDepth) {
+        OpenLoop();
+        if (openLoops.size() == nestDepth) {
+          nestDepth = 0;
+        }
+      } else if (Random(2) == 0) {
+        Random(2) == 0 ? Diamond() : Append(NewBlock());
+      } else {
+        CloseLoop();
+      }
+      return;
+    case CfgShape::kSwitch:
+      if (Random(4) == 0) {
+        openLoops.size() < 4 ? OpenLoop() : CloseLoop();
+      } else if (Random(4) == 0 && !openLoops.empty()) {
+        CloseLoop();
+      } else {
+        Switch(2 + Random(63));
+      }
+      return;
+    }
+  }
+
+  // give a quarter of the single successor blocks a second target up to
+  // 256 blocks ahead: jumps into the middle of loops make them irreducible
+  // without adding cycles, which would merge the whole graph into one
+  // irreducible region
+  void AddCrossEdges() {
+    const auto &blocks = graph->GetBlocks();
+    for (BBlockPtr block : blocks) {
+      size_t first = block->GetId() + 1;
+      if (block->GetSuccessors().size() == 1 && first < blocks.size() &&
+          Random(4) == 0) {
+        size_t last = std::min<size_t>(first + 256, blocks.size());
+        graph->CreateEdge(block, blocks[first + Random(last - first)]);
+      }
+    }
+  }
+
+private:
+  CfgShape shape;
+  std::mt19937 gen;
+
+  std::unique_ptr<Graph> graph;
+  BBlockPtr cursor = nullptr;
+  std::vector<BBlockPtr> openLoops;
+  size_t nestDepth = 0;
+};
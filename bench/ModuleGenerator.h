@@ -0,0 +1,58 @@
+#pragma once
+
+#include <IR/include/Module.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// About 'numInsts' instructions in 16 functions for the IR reader and
+// writer benchmarks. Blocks of 8 arithmetic instructions use random recent
+// values, every 8 blocks form a loop.
+inline std::unique_ptr<Module> GenerateModule(size_t numInsts) {
+  auto module = std::make_unique<Module>();
+  std::mt19937 gen(42);
+  size_t numBlocks = numInsts / 16 / 9;
+  for (size_t f = 0; f < 16; ++f) {
+    Graph &graph = module->CreateFunction("f" + std::to_string(f));
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < numBlocks; ++i) {
+      blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+    }
+
+    IRBuilder builder(blocks[0]);
+    std::vector<Operand *> values{builder.CreateAssign(builder.CreateImm(0))};
+    for (size_t i = 0; i < numBlocks; ++i) {
+      builder.SetBBlock(blocks[i]);
+      for (size_t j = 0; j < 8; ++j) {
+        Operand *src = values[values.size() - 1 - gen() % values.size() % 64];
+        values.push_back(j % 2 ? builder.CreateAdd(src, builder.CreateImm(j))
+                               : builder.CreateMul(src, values.back()));
+      }
+      // 'jeq' falls through to the next block
+      if (i + 1 == numBlocks) {
+        builder.CreateRet(values.back());
+      } else if (i % 8 == 7) {
+        graph.CreateEdge(blocks[i], blocks[i + 1]);
+        graph.CreateEdge(blocks[i], blocks[i - 7]);
+        builder.CreateJeq(values.back(), builder.CreateImm(0),
+                          builder.CreateLabel(blocks[i - 7]));
+      } else {
+        graph.CreateEdge(blocks[i], blocks[i + 1]);
+        builder.CreateJmp(builder.CreateLabel(blocks[i + 1]));
+      }
+    }
+  }
+  return module;
+}
+
+inline size_t CountInsts(const Module &module) {
+  size_t numInsts = 0;
+  for (size_t i = 0; i < module.GetSize(); ++i) {
+    for (const auto &block : module.GetFunction(i).GetBlocks()) {
+      numInsts += block->GetInstCount();
+    }
+  }
+  return numInsts;
+}
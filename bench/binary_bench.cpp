@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include "ModuleGenerator.h"
+
+#include <IR/include/BinaryFormat.h>
+
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+void BM_BinaryWrite(benchmark::State &state) {
+  auto module = GenerateModule(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    std::stringstream ss;
+    WriteBinary(*module, ss);
+    bytes = ss.tellp();
+  }
+  state.counters["insts/s"] = benchmark::Counter(
+      CountInsts(*module), benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["bytes/inst"] =
+      static_cast<double>(bytes) / CountInsts(*module);
+}
+
+// image in memory as if mapped, load materializes the IR
+void BM_BinaryRead(benchmark::State &state) {
+  auto module = GenerateModule(state.range(0));
+  std::stringstream ss;
+  WriteBinary(*module, ss);
+  std::string bytes = ss.str();
+  std::vector<uint64_t> image((bytes.size() + 7) / 8);
+  std::memcpy(image.data(), bytes.data(), bytes.size());
+
+  for (auto _ : state) {
+    BinaryModule view(image.data(), bytes.size());
+    auto loaded = ReadBinary(view);
+    benchmark::DoNotOptimize(loaded.get());
+  }
+  state.counters["insts/s"] = benchmark::Counter(
+      CountInsts(*module), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// walk every record of the image without materializing anything
+void BM_BinaryWalk(benchmark::State &state) {
+  auto module = GenerateModule(state.range(0));
+  std::stringstream ss;
+  WriteBinary(*module, ss);
+  std::string bytes = ss.str();
+  std::vector<uint64_t> image((bytes.size() + 7) / 8);
+  std::memcpy(image.data(), bytes.data(), bytes.size());
+
+  for (auto _ : state) {
+    BinaryModule view(image.data(), bytes.size());
+    uint64_t sum = 0;
+    for (uint32_t f = 0; f < view.GetNumFunctions(); ++f) {
+      const auto &func = view.GetFunction(f);
+      const auto *insts = view.GetInsts(func);
+      for (uint32_t i = 0; i < func.numInsts; ++i) {
+        sum += insts[i].opcode + insts[i].operands[0];
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["insts/s"] = benchmark::Counter(
+      CountInsts(*module), benchmark::Counter::kIsIterationInvariantRate);
+}
+} // namespace
+
+BENCHMARK(BM_BinaryWrite)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BinaryRead)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BinaryWalk)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
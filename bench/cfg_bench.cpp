@@ -0,0 +1,187 @@
+#include <benchmark/benchmark.h>
+
+#include "CfgGenerator.h"
+
+#include <passes/DominatorTree.h>
+#include <passes/LoopAnalysis.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+// Heap accounting: the malloc family is wrapped around the glibc entry
+// points, so containers, arenas and the benchmark library are all seen.
+// This is why the suite is a target of its own.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t align, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+std::atomic<int64_t> liveBytes{0};
+std::atomic<int64_t> peakBytes{0};
+
+void *Track(void *ptr) {
+  if (ptr) {
+    int64_t live = liveBytes += malloc_usable_size(ptr);
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+    }
+  }
+  return ptr;
+}
+
+void Untrack(void *ptr) {
+  if (ptr) {
+    liveBytes -= malloc_usable_size(ptr);
+  }
+}
+} // namespace
+
+extern "C" {
+void *malloc(size_t size) { return Track(__libc_malloc(size)); }
+
+void *calloc(size_t num, size_t size) {
+  return Track(__libc_calloc(num, size));
+}
+
+void *realloc(void *ptr, size_t size) {
+  size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+  void *newPtr = __libc_realloc(ptr, size);
+  if (newPtr || size == 0) {
+    liveBytes -= oldSize;
+    Track(newPtr);
+  }
+  return newPtr;
+}
+
+void *memalign(size_t align, size_t size) {
+  return Track(__libc_memalign(align, size));
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+  return Track(__libc_memalign(align, size));
+}
+
+int posix_memalign(void **ptr, size_t align, size_t size) {
+  if (align % sizeof(void *) != 0 || (align & (align - 1)) != 0) {
+    return EINVAL;
+  }
+  *ptr = Track(__libc_memalign(align, size));
+  return *ptr ? 0 : ENOMEM;
+}
+
+void free(void *ptr) {
+  Untrack(ptr);
+  __libc_free(ptr);
+}
+}
+
+namespace {
+// peak heap growth while 'func' runs
+template <class Func>
+int64_t MeasurePeakBytes(Func func) {
+  int64_t base = liveBytes.load();
+  peakBytes = base;
+  func();
+  return peakBytes.load() - base;
+}
+} // namespace
+#else
+namespace {
+// no allocator hooks, peak memory is not reported
+template <class Func>
+int64_t MeasurePeakBytes(Func func) {
+  func();
+  return 0;
+}
+} // namespace
+#endif
+
+namespace {
+// Run 'analysis' on a generated graph of 'state.range(0)' blocks. The
+// first run is untimed and measures the peak heap of the analysis.
+template <class Analysis>
+void RunAnalysis(benchmark::State &state, CfgShape shape, Analysis analysis) {
+  auto graph = CfgGenerator(shape, 42).Generate(state.range(0));
+  int64_t peak = MeasurePeakBytes([&] { analysis(*graph); });
+  for (auto _ : state) {
+    analysis(*graph);
+  }
+
+  // generated graphs may be slightly larger than requested
+  size_t size = graph->GetSize();
+  state.SetComplexityN(size);
+  state.counters["blocks"] = size;
+  state.counters["blocks/s"] = benchmark::Counter(
+      size, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["peakMem"] = benchmark::Counter(
+      peak, benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+  state.counters["bytes/block"] = static_cast<double>(peak) / size;
+}
+
+void BM_Dfs(benchmark::State &state, CfgShape shape) {
+  RunAnalysis(state, shape, [](const Graph &graph) {
+    auto dfs = graph.GetDfs();
+    benchmark::DoNotOptimize(dfs.data());
+  });
+}
+
+void BM_Po(benchmark::State &state, CfgShape shape) {
+  RunAnalysis(state, shape, [](const Graph &graph) {
+    auto po = graph.GetPo();
+    benchmark::DoNotOptimize(po.data());
+  });
+}
+
+void BM_DominatorTree(benchmark::State &state, CfgShape shape) {
+  RunAnalysis(state, shape, [](const Graph &graph) {
+    DominatorTree domTree(graph);
+    benchmark::DoNotOptimize(domTree.GetRoot());
+  });
+}
+
+// the dominator tree is part of the measured work
+void BM_LoopTree(benchmark::State &state, CfgShape shape) {
+  RunAnalysis(state, shape, [](const Graph &graph) {
+    LoopTree loopTree(graph);
+    benchmark::DoNotOptimize(loopTree.GetRoot());
+  });
+}
+
+// no dominator tree, irreducible loops get their bodies
+void BM_LoopTreeHavlak(benchmark::State &state, CfgShape shape) {
+  RunAnalysis(state, shape, [](const Graph &graph) {
+    LoopTree loopTree(graph, LoopTree::kHavlak);
+    benchmark::DoNotOptimize(loopTree.GetRoot());
+  });
+}
+
+void CfgSizes(benchmark::internal::Benchmark *bench) {
+  bench->RangeMultiplier(10)
+      ->Range(100, 1000000)
+      ->Unit(benchmark::kMillisecond)
+      ->Complexity();
+}
+} // namespace
+
+#define CFG_BENCHMARK(func)                                                    \
+  BENCHMARK_CAPTURE(func, reducible, CfgShape::kReducible)->Apply(CfgSizes);   \
+  BENCHMARK_CAPTURE(func, irreducible, CfgShape::kIrreducible)                 \
+      ->Apply(CfgSizes);                                                       \
+  BENCHMARK_CAPTURE(func, nested, CfgShape::kNested)->Apply(CfgSizes);         \
+  BENCHMARK_CAPTURE(func, switch, CfgShape::kSwitch)->Apply(CfgSizes)
+
+CFG_BENCHMARK(BM_Dfs);
+CFG_BENCHMARK(BM_Po);
+CFG_BENCHMARK(BM_DominatorTree);
+CFG_BENCHMARK(BM_LoopTree);
+CFG_BENCHMARK(BM_LoopTreeHavlak);
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include "ModuleGenerator.h"
+
+#include <passes/DCE.h>
+
+// every function of the module, insts/s stays flat if the pass is linear
+void BM_DCE(benchmark::State &state) {
+  size_t numInsts = 0;
+  DCE dce;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto module = GenerateModule(state.range(0));
+    numInsts = CountInsts(*module);
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < module->GetSize(); ++i) {
+      Graph &graph = module->GetFunction(i);
+      AnalysisManager am(graph);
+      dce.Run(graph, am);
+    }
+
+    state.PauseTiming();
+    module.reset();
+    state.ResumeTiming();
+  }
+  state.counters["insts"] = numInsts;
+  state.counters["erased"] = benchmark::Counter(
+      dce.GetStats().numErasedInsts, benchmark::Counter::kAvgIterations);
+  state.counters["insts/s"] = benchmark::Counter(
+      numInsts, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_DCE)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <passes/DominanceFrontier.h>
+#include <passes/DominatorTree.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<BBlockPtr> CreateBlocks(Graph &graph, size_t size) {
+  std::vector<BBlockPtr> blocks;
+  blocks.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+  }
+  return blocks;
+}
+
+// straight line with a back edge from every block to its predecessor:
+// dominator tree is a path of depth 'size'
+std::unique_ptr<Graph> CreateChain(size_t size) {
+  auto graph = std::make_unique<Graph>();
+  auto blocks = CreateBlocks(*graph, size);
+  for (size_t i = 1; i < size; ++i) {
+    graph->CreateEdge(blocks[i - 1], blocks[i]);
+    graph->CreateEdge(blocks[i], blocks[i - 1]);
+  }
+  return graph;
+}
+
+// sequence of if-then-else diamonds, every 16 diamonds are wrapped in a loop
+std::unique_ptr<Graph> CreateDiamonds(size_t size) {
+  auto graph = std::make_unique<Graph>();
+  auto blocks = CreateBlocks(*graph, size);
+  size_t loopHead = 0;
+  for (size_t i = 0; i + 3 < size; i += 3) {
+    graph->CreateEdge(blocks[i], blocks[i + 1]);
+    graph->CreateEdge(blocks[i], blocks[i + 2]);
+    graph->CreateEdge(blocks[i + 1], blocks[i + 3]);
+    graph->CreateEdge(blocks[i + 2], blocks[i + 3]);
+    if (i % 48 == 45) {
+      graph->CreateEdge(blocks[i + 3], blocks[loopHead]);
+      loopHead = i + 3;
+    }
+  }
+  return graph;
+}
+
+// chain with one more edge from every block to a random block
+std::unique_ptr<Graph> CreateRandom(size_t size) {
+  auto graph = std::make_unique<Graph>();
+  auto blocks = CreateBlocks(*graph, size);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> dist(0, size - 1);
+  for (size_t i = 1; i < size; ++i) {
+    graph->CreateEdge(blocks[i - 1], blocks[i]);
+    graph->CreateEdge(blocks[i - 1], blocks[dist(gen)]);
+  }
+  return graph;
+}
+
+template <class Generator>
+void BM_DominatorTree(benchmark::State &state, Generator generator) {
+  auto graph = generator(state.range(0));
+  for (auto _ : state) {
+    DominatorTree domTree(*graph);
+    benchmark::DoNotOptimize(domTree.GetRoot());
+  }
+  state.SetComplexityN(state.range(0));
+  state.counters["blocks/s"] = benchmark::Counter(
+      state.range(0), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// sequence of independent loops, every loop body is 8 diamonds
+std::unique_ptr<Graph> CreateLoops(size_t size) {
+  auto graph = std::make_unique<Graph>();
+  auto blocks = CreateBlocks(*graph, size);
+  size_t loopHead = 0;
+  for (size_t i = 0; i + 3 < size; i += 3) {
+    graph->CreateEdge(blocks[i], blocks[i + 1]);
+    graph->CreateEdge(blocks[i], blocks[i + 2]);
+    graph->CreateEdge(blocks[i + 1], blocks[i + 3]);
+    graph->CreateEdge(blocks[i + 2], blocks[i + 3]);
+    if (i % 24 == 21 && i + 4 < size) {
+      // latch -> head and exit to the head of the next loop
+      graph->CreateEdge(blocks[i + 3], blocks[loopHead]);
+      graph->CreateEdge(blocks[i + 3], blocks[i + 4]);
+      loopHead = i + 4;
+      ++i;
+    }
+  }
+  return graph;
+}
+
+// phi placement for 'size / 8' variables with two definitions each
+void BM_IteratedFrontier(benchmark::State &state) {
+  size_t size = state.range(0);
+  auto graph = CreateLoops(size);
+  DominatorTree domTree(*graph);
+  DominanceFrontier df(*graph, domTree);
+
+  std::vector<BBlockPtr> blocks(graph->BlockBegin(), graph->BlockEnd());
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> dist(0, size - 1);
+  std::vector<std::vector<BBlockPtr>> defs(size / 8);
+  for (auto &varDefs : defs) {
+    varDefs = {blocks[dist(gen)], blocks[dist(gen)]};
+  }
+
+  std::vector<BBlockPtr> idf;
+  size_t phis = 0;
+  for (auto _ : state) {
+    phis = 0;
+    for (const auto &varDefs : defs) {
+      df.GetIteratedFrontier(varDefs, idf);
+      phis += idf.size();
+    }
+    benchmark::DoNotOptimize(phis);
+  }
+  state.SetComplexityN(size);
+  state.counters["vars/s"] = benchmark::Counter(
+      defs.size(), benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["phis"] = phis;
+}
+} // namespace
+
+BENCHMARK_CAPTURE(BM_DominatorTree, chain, CreateChain)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(BM_DominatorTree, diamonds, CreateDiamonds)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(BM_DominatorTree, random, CreateRandom)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK(BM_IteratedFrontier)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
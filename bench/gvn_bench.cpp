@@ -0,0 +1,166 @@
+#include <benchmark/benchmark.h>
+
+#include <interp/Interpreter.h>
+#include <passes/GVN.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+// A loop around a chain of diamonds with about 'numInsts' instructions.
+// Every block computes random expressions over immediates 0..3 and either
+// recent values of the dominating blocks or a few values of the loop
+// header, the latter show up again and again.
+std::unique_ptr<Graph> CreateRedundant(size_t numInsts) {
+  auto graph = std::make_unique<Graph>();
+  std::mt19937 gen(42);
+  BBlockPtr entry = graph->CreateBlock("entry");
+  BBlockPtr header = graph->CreateBlock("header");
+  BBlockPtr exit = graph->CreateBlock("exit");
+  BBlockPtr prev = graph->CreateBlock("body");
+  graph->CreateEdge(entry, header);
+  graph->CreateEdge(header, prev);
+  graph->CreateEdge(header, exit);
+
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  builder.CreateJmp(builder.CreateLabel(header));
+  builder.SetBBlock(header);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(entry));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(entry));
+  std::vector<Operand *> common{i, sum, builder.CreateMul(i, sum),
+                                builder.CreateAdd(i, builder.CreateImm(1))};
+  builder.CreateJeq(builder.CreateCmp(i, builder.CreateImm(4)), zero,
+                    builder.CreateLabel(exit));
+
+  std::vector<Operand *> dominating(common);
+  auto compute = [&](std::vector<Operand *> &recent) {
+    auto &values = gen() % 2 ? common : recent;
+    Operand *lhs = values[values.size() - 1 - gen() % 8 % values.size()];
+    Operand *rhs = gen() % 2 ? builder.CreateImm(gen() % 4)
+                             : values[values.size() - 1 -
+                                      gen() % 8 % values.size()];
+    switch (gen() % 3) {
+    case 0:
+      return builder.CreateAdd(lhs, rhs);
+    case 1:
+      return builder.CreateMul(lhs, rhs);
+    default:
+      return builder.CreateCmp(lhs, rhs);
+    }
+  };
+
+  builder.SetBBlock(prev);
+  // 4 blocks of 4 instructions each
+  for (size_t d = 0; d < numInsts / 16; ++d) {
+    BBlockPtr then = graph->CreateBlock("then");
+    BBlockPtr other = graph->CreateBlock("else");
+    BBlockPtr join = graph->CreateBlock("join");
+    graph->CreateEdge(prev, then);
+    graph->CreateEdge(prev, other);
+    graph->CreateEdge(then, join);
+    graph->CreateEdge(other, join);
+    for (size_t j = 0; j < 2; ++j) {
+      dominating.push_back(compute(dominating));
+    }
+    builder.CreateJeq(compute(dominating), zero, builder.CreateLabel(other));
+
+    // branches see the recent dominating values only
+    auto recent = dominating.end() - std::min<size_t>(dominating.size(), 8);
+    std::vector<Operand *> thenValues(recent, dominating.end());
+    builder.SetBBlock(then);
+    for (size_t j = 0; j < 3; ++j) {
+      thenValues.push_back(compute(thenValues));
+    }
+    builder.CreateJmp(builder.CreateLabel(join));
+    std::vector<Operand *> otherValues(recent, dominating.end());
+    builder.SetBBlock(other);
+    for (size_t j = 0; j < 3; ++j) {
+      otherValues.push_back(compute(otherValues));
+    }
+    builder.CreateJmp(builder.CreateLabel(join));
+
+    builder.SetBBlock(join);
+    dominating.push_back(builder.CreatePhi(
+        thenValues.back(), builder.CreateLabel(then), otherValues.back(),
+        builder.CreateLabel(other)));
+    for (size_t j = 0; j < 3; ++j) {
+      dominating.push_back(compute(dominating));
+    }
+    prev = join;
+  }
+  graph->CreateEdge(prev, header);
+  auto iNext = builder.CreateAdd(i, builder.CreateImm(1));
+  auto sumNext = builder.CreateAdd(sum, dominating.back());
+  builder.CreateJmp(builder.CreateLabel(header));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(i)->SetOperand(3, builder.CreateLabel(prev));
+  GetInst(sum)->SetOperand(2, sumNext);
+  GetInst(sum)->SetOperand(3, builder.CreateLabel(prev));
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+  return graph;
+}
+
+size_t CountInsts(const Graph &graph) {
+  size_t numInsts = 0;
+  for (const auto &block : graph.GetBlocks()) {
+    numInsts += block->GetInstCount();
+  }
+  return numInsts;
+}
+
+// the dominator tree is computed outside of the timed region
+void BM_GVN(benchmark::State &state) {
+  size_t numInsts = 0;
+  GVN::Stats stats;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto graph = CreateRedundant(state.range(0));
+    numInsts = CountInsts(*graph);
+    AnalysisManager am(*graph);
+    am.Get<DominatorTree>();
+    GVN gvn;
+    state.ResumeTiming();
+
+    gvn.Run(*graph, am);
+
+    state.PauseTiming();
+    stats = gvn.GetStats();
+    graph.reset();
+    state.ResumeTiming();
+  }
+  state.counters["insts"] = numInsts;
+  state.counters["eliminated"] = stats.numEliminatedInsts;
+  state.counters["insts/s"] = benchmark::Counter(
+      numInsts, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// the same function before (0) and after (1) GVN
+void BM_GVNInterpreter(benchmark::State &state) {
+  auto graph = CreateRedundant(100000);
+  if (state.range(0)) {
+    AnalysisManager am(*graph);
+    GVN().Run(*graph, am);
+  }
+  Interpreter interp(*graph);
+  uint64_t executed = 0;
+  interp.Run(executed);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interp.Run());
+  }
+  state.counters["executed"] = executed;
+}
+} // namespace
+
+BENCHMARK(BM_GVN)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GVNInterpreter)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include <interp/Interpreter.h>
+
+#include <memory>
+
+namespace {
+// for (i = 0; i < n; ++i) for (j = 0; j < m; ++j) sum = sum * 3 + i * j
+std::unique_ptr<Graph> CreateNestedLoops(uint64_t n, uint64_t m) {
+  auto graph = std::make_unique<Graph>();
+  BBlockPtr entry = graph->CreateBlock("entry");
+  BBlockPtr outer = graph->CreateBlock("outer");
+  BBlockPtr inner = graph->CreateBlock("inner");
+  BBlockPtr latch = graph->CreateBlock("latch");
+  BBlockPtr exit = graph->CreateBlock("exit");
+  graph->CreateEdge(entry, outer);
+  graph->CreateEdge(outer, inner);
+  graph->CreateEdge(outer, exit);
+  graph->CreateEdge(inner, inner);
+  graph->CreateEdge(inner, latch);
+  graph->CreateEdge(latch, outer);
+
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  auto one = builder.CreateImm(1);
+  builder.CreateJmp(builder.CreateLabel(outer));
+
+  builder.SetBBlock(outer);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(latch));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(latch));
+  auto iLess = builder.CreateCmp(i, builder.CreateImm(n));
+  builder.CreateJeq(iLess, zero, builder.CreateLabel(exit));
+
+  builder.SetBBlock(inner);
+  auto j = builder.CreatePhi(zero, builder.CreateLabel(outer), zero,
+                             builder.CreateLabel(inner));
+  auto innerSum = builder.CreatePhi(sum, builder.CreateLabel(outer), zero,
+                                    builder.CreateLabel(inner));
+  auto scaled = builder.CreateMul(innerSum, builder.CreateImm(3));
+  auto innerSumNext = builder.CreateAdd(scaled, builder.CreateMul(i, j));
+  auto jNext = builder.CreateAdd(j, one);
+  builder.CreateJeq(jNext, builder.CreateImm(m), builder.CreateLabel(latch));
+  GetInst(j)->SetOperand(2, jNext);
+  GetInst(innerSum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(latch);
+  auto iNext = builder.CreateAdd(i, one);
+  builder.CreateJmp(builder.CreateLabel(outer));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(sum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+  return graph;
+}
+
+void BM_Interpreter(benchmark::State &state) {
+  auto graph = CreateNestedLoops(state.range(0), 1000);
+  Interpreter interp(*graph);
+  uint64_t executed = 0;
+  interp.Run(executed);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interp.Run());
+  }
+  state.counters["insts/s"] = benchmark::Counter(
+      executed, benchmark::Counter::kIsIterationInvariantRate);
+}
+} // namespace
+
+BENCHMARK(BM_Interpreter)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Unit(benchmark::kMillisecond);
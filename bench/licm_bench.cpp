@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+
+#include <interp/Interpreter.h>
+#include <passes/LICM.h>
+
+#include <memory>
+
+namespace {
+// for (i = 0; i < n; ++i)
+//   for (j = 0; j < n; ++j)
+//     for (k = 0; k < n; ++k)
+//       sum = sum * 3 + (i * 7 + 11 * 13) * j + k
+// the loop heads branch to the exits, so the inner loops get preheaders
+std::unique_ptr<Graph> CreateInvariantLoops(uint64_t n) {
+  auto graph = std::make_unique<Graph>();
+  BBlockPtr entry = graph->CreateBlock("entry");
+  BBlockPtr outer = graph->CreateBlock("outer");
+  BBlockPtr middle = graph->CreateBlock("middle");
+  BBlockPtr inner = graph->CreateBlock("inner");
+  BBlockPtr middleLatch = graph->CreateBlock("middleLatch");
+  BBlockPtr outerLatch = graph->CreateBlock("outerLatch");
+  BBlockPtr exit = graph->CreateBlock("exit");
+  graph->CreateEdge(entry, outer);
+  graph->CreateEdge(outer, middle);
+  graph->CreateEdge(outer, exit);
+  graph->CreateEdge(middle, inner);
+  graph->CreateEdge(middle, outerLatch);
+  graph->CreateEdge(inner, middleLatch);
+  graph->CreateEdge(inner, inner);
+  graph->CreateEdge(middleLatch, middle);
+  graph->CreateEdge(outerLatch, outer);
+
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  auto one = builder.CreateImm(1);
+  auto bound = builder.CreateImm(n);
+  builder.CreateJmp(builder.CreateLabel(outer));
+
+  builder.SetBBlock(outer);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(outerLatch));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(outerLatch));
+  builder.CreateJeq(builder.CreateCmp(i, bound), zero,
+                    builder.CreateLabel(exit));
+
+  builder.SetBBlock(middle);
+  auto j = builder.CreatePhi(zero, builder.CreateLabel(outer), zero,
+                             builder.CreateLabel(middleLatch));
+  auto middleSum = builder.CreatePhi(sum, builder.CreateLabel(outer), zero,
+                                     builder.CreateLabel(middleLatch));
+  builder.CreateJeq(builder.CreateCmp(j, bound), zero,
+                    builder.CreateLabel(outerLatch));
+
+  builder.SetBBlock(inner);
+  auto k = builder.CreatePhi(zero, builder.CreateLabel(middle), zero,
+                             builder.CreateLabel(inner));
+  auto innerSum = builder.CreatePhi(middleSum, builder.CreateLabel(middle),
+                                    zero, builder.CreateLabel(inner));
+  auto c = builder.CreateMul(builder.CreateImm(11), builder.CreateImm(13));
+  auto a = builder.CreateAdd(builder.CreateMul(i, builder.CreateImm(7)), c);
+  auto term = builder.CreateAdd(builder.CreateMul(a, j), k);
+  auto innerSumNext = builder.CreateAdd(
+      builder.CreateMul(innerSum, builder.CreateImm(3)), term);
+  auto kNext = builder.CreateAdd(k, one);
+  builder.CreateJeq(kNext, bound, builder.CreateLabel(middleLatch));
+  GetInst(k)->SetOperand(2, kNext);
+  GetInst(innerSum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(middleLatch);
+  auto jNext = builder.CreateAdd(j, one);
+  builder.CreateJmp(builder.CreateLabel(middle));
+  GetInst(j)->SetOperand(2, jNext);
+  GetInst(middleSum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(outerLatch);
+  auto iNext = builder.CreateAdd(i, one);
+  builder.CreateJmp(builder.CreateLabel(outer));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(sum)->SetOperand(2, middleSum);
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+  return graph;
+}
+
+// the same function before (0) and after (1) LICM
+void BM_LICMInterpreter(benchmark::State &state) {
+  auto graph = CreateInvariantLoops(100);
+  if (state.range(0)) {
+    AnalysisManager am(*graph);
+    LICM().Run(*graph, am);
+  }
+  Interpreter interp(*graph);
+  uint64_t executed = 0;
+  interp.Run(executed);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interp.Run());
+  }
+  state.counters["executed"] = executed;
+}
+} // namespace
+
+BENCHMARK(BM_LICMInterpreter)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <passes/Liveness.h>
+#include <passes/RegAlloc.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Sequence of loops of 8 blocks, the last loop block branches to the loop
+// head and to the next loop. Every block defines 'valuesPerBlock' values,
+// one of them is used in a random block of the next 64.
+std::unique_ptr<Graph> CreateFunction(size_t numValues,
+                                      size_t valuesPerBlock) {
+  auto graph = std::make_unique<Graph>();
+  size_t size = numValues / valuesPerBlock;
+  std::vector<BBlockPtr> blocks;
+  for (size_t i = 0; i < size; ++i) {
+    blocks.push_back(graph->CreateBlock("B" + std::to_string(i)));
+  }
+  for (size_t i = 0; i + 1 < size; ++i) {
+    graph->CreateEdge(blocks[i], blocks[i + 1]);
+    if (i % 8 == 7) {
+      graph->CreateEdge(blocks[i], blocks[i - 7]);
+    }
+  }
+
+  std::mt19937 gen(42);
+  IRBuilder builder(blocks[0]);
+  std::vector<Operand *> escaping(size);
+  for (size_t i = 0; i < size; ++i) {
+    builder.SetBBlock(blocks[i]);
+    Operand *value = builder.CreateAssign(builder.CreateImm(i));
+    for (size_t v = 1; v < valuesPerBlock; ++v) {
+      value = builder.CreateAdd(value, builder.CreateImm(v));
+    }
+    escaping[i] = value;
+  }
+  for (size_t i = 0; i + 1 < size; ++i) {
+    size_t user = std::min(size - 1, i + 1 + gen() % 64);
+    builder.SetBBlock(blocks[user]);
+    builder.CreateAdd(escaping[i], escaping[user]);
+  }
+  return graph;
+}
+
+void BM_Liveness(benchmark::State &state) {
+  auto graph = CreateFunction(state.range(0), 10);
+  LoopTree loopTree(*graph);
+  size_t visits = 0;
+  for (auto _ : state) {
+    Liveness liveness(*graph, loopTree);
+    visits = liveness.GetNumVisits();
+    benchmark::DoNotOptimize(liveness.GetNumValues());
+  }
+  state.SetComplexityN(state.range(0));
+  state.counters["visits/block"] =
+      static_cast<double>(visits) / graph->GetSize();
+  state.counters["values/s"] = benchmark::Counter(
+      state.range(0), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// allocation time and spill code for {values, registers}
+void BM_RegAlloc(benchmark::State &state) {
+  auto graph = CreateFunction(state.range(0), 10);
+  LoopTree loopTree(*graph);
+  Liveness liveness(*graph, loopTree);
+  RegAlloc::Stats stats;
+  for (auto _ : state) {
+    RegAlloc regAlloc(*graph, loopTree, liveness, state.range(1));
+    stats = regAlloc.GetStats();
+  }
+  state.counters["spilled"] = stats.numSpilled;
+  state.counters["reloads"] = stats.numReloads;
+  state.counters["spillCost"] = stats.weightedSpillCost;
+  state.counters["values/s"] = benchmark::Counter(
+      state.range(0), benchmark::Counter::kIsIterationInvariantRate);
+}
+} // namespace
+
+BENCHMARK(BM_Liveness)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK(BM_RegAlloc)
+    ->ArgsProduct({{10000, 100000}, {4, 8, 16, 32}})
+    ->Unit(benchmark::kMillisecond);
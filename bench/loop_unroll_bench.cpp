@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <interp/Interpreter.h>
+#include <passes/DCE.h>
+#include <passes/LoopUnroll.h>
+
+#include <memory>
+
+namespace {
+// for (i = 0; i < n; ++i) for (j = 0; j < m; ++j) sum = sum * 3 + i * j
+// with the test of the inner loop at its bottom
+std::unique_ptr<Graph> CreateNestedLoops(uint64_t n, uint64_t m) {
+  auto graph = std::make_unique<Graph>();
+  BBlockPtr entry = graph->CreateBlock("entry");
+  BBlockPtr outer = graph->CreateBlock("outer");
+  BBlockPtr inner = graph->CreateBlock("inner");
+  BBlockPtr latch = graph->CreateBlock("latch");
+  BBlockPtr exit = graph->CreateBlock("exit");
+  graph->CreateEdge(entry, outer);
+  graph->CreateEdge(outer, inner);
+  graph->CreateEdge(outer, exit);
+  graph->CreateEdge(inner, inner);
+  graph->CreateEdge(inner, latch);
+  graph->CreateEdge(latch, outer);
+
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  auto one = builder.CreateImm(1);
+  builder.CreateJmp(builder.CreateLabel(outer));
+
+  builder.SetBBlock(outer);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(latch));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(latch));
+  auto iLess = builder.CreateCmp(i, builder.CreateImm(n));
+  builder.CreateJeq(iLess, zero, builder.CreateLabel(exit));
+
+  builder.SetBBlock(inner);
+  auto j = builder.CreatePhi(zero, builder.CreateLabel(outer), zero,
+                             builder.CreateLabel(inner));
+  auto innerSum = builder.CreatePhi(sum, builder.CreateLabel(outer), zero,
+                                    builder.CreateLabel(inner));
+  auto scaled = builder.CreateMul(innerSum, builder.CreateImm(3));
+  auto innerSumNext = builder.CreateAdd(scaled, builder.CreateMul(i, j));
+  auto jNext = builder.CreateAdd(j, one);
+  builder.CreateJeq(jNext, builder.CreateImm(m), builder.CreateLabel(latch));
+  GetInst(j)->SetOperand(2, jNext);
+  GetInst(innerSum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(latch);
+  auto iNext = builder.CreateAdd(i, one);
+  builder.CreateJmp(builder.CreateLabel(outer));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(sum)->SetOperand(2, innerSumNext);
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+  return graph;
+}
+
+// inner trip count 'm', before (0) and after (1) unrolling and DCE of
+// the exit tests of the copies
+void BM_LoopUnrollInterpreter(benchmark::State &state) {
+  uint64_t m = state.range(0);
+  auto graph = CreateNestedLoops(100000 / m, m);
+  uint64_t expected = Interpreter(*graph).Run();
+  LoopUnroll unroll;
+  if (state.range(1)) {
+    AnalysisManager am(*graph);
+    unroll.Run(*graph, am);
+    DCE().Run(*graph, am);
+  }
+  Interpreter interp(*graph);
+  if (interp.Run() != expected) {
+    state.SkipWithError("unrolled loops compute another value");
+    return;
+  }
+  uint64_t executed = 0;
+  interp.Run(executed);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interp.Run());
+  }
+  state.counters["executed"] = executed;
+  state.counters["cloned"] = unroll.GetStats().numClonedInsts;
+}
+} // namespace
+
+BENCHMARK(BM_LoopUnrollInterpreter)
+    ->ArgsProduct({{8, 100}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
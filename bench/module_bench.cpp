@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include "CfgGenerator.h"
+
+#include <IR/include/Module.h>
+#include <passes/DominatorTree.h>
+#include <passes/LoopAnalysis.h>
+#include <support/ThreadPool.h>
+
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+// 1024 functions of 100 to 10000 blocks of mixed shapes
+std::unique_ptr<Module> CreateModule() {
+  auto module = std::make_unique<Module>();
+  std::mt19937 gen(42);
+  for (uint32_t i = 0; i < 1024; ++i) {
+    auto shape = static_cast<CfgShape>(i % 4);
+    size_t size = 100 + gen() % 9900;
+    module->AddFunction("f" + std::to_string(i),
+                        CfgGenerator(shape, i).Generate(size));
+  }
+  return module;
+}
+
+// dominator and loop trees of every function, functions in parallel
+void BM_ModuleAnalysis(benchmark::State &state) {
+  static auto module = CreateModule();
+  size_t numBlocks = 0;
+  for (size_t i = 0; i < module->GetSize(); ++i) {
+    numBlocks += module->GetFunction(i).GetSize();
+  }
+
+  ThreadPool pool(state.range(0));
+  for (auto _ : state) {
+    pool.ParallelFor(module->GetSize(), [&](size_t i) {
+      const Graph &graph = module->GetFunction(i);
+      DominatorTree domTree(graph);
+      LoopTree loopTree(graph, domTree);
+      benchmark::DoNotOptimize(loopTree.GetRoot());
+    });
+  }
+  state.counters["functions/s"] = benchmark::Counter(
+      module->GetSize(), benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["blocks/s"] = benchmark::Counter(
+      numBlocks, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["steals"] = benchmark::Counter(
+      pool.GetNumSteals(), benchmark::Counter::kAvgIterations);
+}
+} // namespace
+
+BENCHMARK(BM_ModuleAnalysis)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
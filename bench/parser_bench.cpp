@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include "ModuleGenerator.h"
+
+#include <IR/include/Parser.h>
+
+#include <sstream>
+#include <string>
+
+namespace {
+// dumped module parsed back, reports MB/s of text
+void BM_ParseModule(benchmark::State &state) {
+  auto module = GenerateModule(state.range(0));
+  std::stringstream ss;
+  module->Dump(ss);
+  std::string text = ss.str();
+
+  for (auto _ : state) {
+    Parser parser(text);
+    auto parsed = parser.ParseModule();
+    benchmark::DoNotOptimize(parsed.get());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+  state.counters["insts/s"] = benchmark::Counter(
+      CountInsts(*module), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_DumpModule(benchmark::State &state) {
+  auto module = GenerateModule(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    std::stringstream ss;
+    module->Dump(ss);
+    bytes = ss.tellp();
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+} // namespace
+
+BENCHMARK(BM_ParseModule)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DumpModule)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
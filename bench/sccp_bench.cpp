@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+
+#include <interp/Interpreter.h>
+#include <passes/SCCP.h>
+
+#include <memory>
+#include <random>
+
+namespace {
+// for (i = 0; i < n; ++i) a chain of 'size' diamonds. Two thirds of the
+// conditions are computed from constants the way a debug flag or a
+// specialized parameter would be, the rest depend on i.
+std::unique_ptr<Graph> CreateDiamonds(size_t size, uint64_t n) {
+  auto graph = std::make_unique<Graph>();
+  std::mt19937 gen(42);
+  BBlockPtr entry = graph->CreateBlock("entry");
+  BBlockPtr header = graph->CreateBlock("header");
+  BBlockPtr exit = graph->CreateBlock("exit");
+  graph->CreateEdge(entry, header);
+
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  auto flag = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(header));
+
+  builder.SetBBlock(header);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(entry));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(entry));
+  auto less = builder.CreateCmp(i, builder.CreateImm(n));
+  builder.CreateJeq(less, zero, builder.CreateLabel(exit));
+
+  BBlockPtr prev = header;
+  Operand *value = sum;
+  for (size_t d = 0; d < size; ++d) {
+    BBlockPtr cond = graph->CreateBlock("cond");
+    BBlockPtr then = graph->CreateBlock("then");
+    BBlockPtr other = graph->CreateBlock("else");
+    BBlockPtr join = graph->CreateBlock("join");
+    graph->CreateEdge(prev, cond);
+    if (prev == header) {
+      graph->CreateEdge(header, exit);
+    } else {
+      builder.CreateJmp(builder.CreateLabel(cond));
+    }
+    graph->CreateEdge(cond, then);
+    graph->CreateEdge(cond, other);
+    graph->CreateEdge(then, join);
+    graph->CreateEdge(other, join);
+
+    builder.SetBBlock(cond);
+    auto scale = builder.CreateAdd(flag, builder.CreateImm(gen() % 4));
+    auto k = builder.CreateMul(scale, builder.CreateImm(gen() % 4));
+    auto test = builder.CreateCmp(gen() % 3 ? k : i, builder.CreateImm(5));
+    builder.CreateJeq(test, zero, builder.CreateLabel(other));
+    builder.SetBBlock(then);
+    auto a = builder.CreateAdd(value, k);
+    builder.CreateJmp(builder.CreateLabel(join));
+    builder.SetBBlock(other);
+    auto b = builder.CreateMul(value, scale);
+    builder.CreateJmp(builder.CreateLabel(join));
+    builder.SetBBlock(join);
+    value = builder.CreatePhi(a, builder.CreateLabel(then), b,
+                              builder.CreateLabel(other));
+    prev = join;
+  }
+  graph->CreateEdge(prev, header);
+  auto iNext = builder.CreateAdd(i, builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(header));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(i)->SetOperand(3, builder.CreateLabel(prev));
+  GetInst(sum)->SetOperand(2, value);
+  GetInst(sum)->SetOperand(3, builder.CreateLabel(prev));
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+  return graph;
+}
+
+size_t CountInsts(const Graph &graph) {
+  size_t numInsts = 0;
+  for (const auto &block : graph.GetBlocks()) {
+    numInsts += block->GetInstCount();
+  }
+  return numInsts;
+}
+
+void BM_SCCP(benchmark::State &state) {
+  size_t numInsts = 0;
+  size_t numInstsAfter = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto graph = CreateDiamonds(state.range(0), 1);
+    AnalysisManager am(*graph);
+    SCCP sccp;
+    numInsts = CountInsts(*graph);
+    state.ResumeTiming();
+
+    sccp.Run(*graph, am);
+
+    state.PauseTiming();
+    numInstsAfter = CountInsts(*graph);
+    graph.reset();
+    state.ResumeTiming();
+  }
+  state.counters["insts"] = numInsts;
+  state.counters["instsAfter"] = numInstsAfter;
+  state.counters["insts/s"] = benchmark::Counter(
+      numInsts, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// the same function before (0) and after (1) SCCP
+void BM_SCCPInterpreter(benchmark::State &state) {
+  auto graph = CreateDiamonds(64, 10000);
+  if (state.range(0)) {
+    AnalysisManager am(*graph);
+    SCCP().Run(*graph, am);
+  }
+  Interpreter interp(*graph);
+  uint64_t executed = 0;
+  interp.Run(executed);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interp.Run());
+  }
+  state.counters["insts"] = CountInsts(*graph);
+  state.counters["executed"] = executed;
+}
+} // namespace
+
+BENCHMARK(BM_SCCP)
+    ->RangeMultiplier(8)
+    ->Range(64, 32768)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SCCPInterpreter)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
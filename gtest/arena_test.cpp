@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+
+#include <support/Arena.h>
+
+#include <cstdint>
+#include <string>
+
+namespace {
+struct Counted {
+  Counted(int &dtors) : dtors(dtors) {}
+  ~Counted() { ++dtors; }
+  int &dtors;
+};
+} // namespace
+
+TEST(Arena, alignment) {
+  Arena arena(128);
+  for (size_t i = 0; i < 100; ++i) {
+    (void)arena.Create<char>('a');
+    auto *d = arena.Create<double>(1.0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(d) % alignof(double), 0u);
+  }
+
+  // larger than slab
+  auto *big = arena.AllocateArray<uint64_t>(1024);
+  big[1023] = 42;
+  ASSERT_EQ(big[1023], 42u);
+}
+
+TEST(Arena, destructors) {
+  int dtors = 0;
+  {
+    Arena arena;
+    for (int i = 0; i < 10; ++i) {
+      arena.Create<Counted>(dtors);
+    }
+    auto *str = arena.Create<std::string>(100, 'x');
+    ASSERT_EQ(str->size(), 100u);
+    ASSERT_EQ(dtors, 0);
+  }
+  ASSERT_EQ(dtors, 10);
+}
@@ -0,0 +1,202 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/BinaryFormat.h>
+#include <support/MappedFile.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A: a0 = 1, jmp B
+// B: i = phi [a0 A] [i1 C], cmp i 10, jeq D
+// C: i1 = add i a0, jmp B
+// D: ret i
+static void CreateLoop(Graph &graph) {
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, B);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(B));
+
+  builder.SetBBlock(B);
+  auto i = builder.CreatePhi(a0, builder.CreateLabel(A), a0,
+                             builder.CreateLabel(C));
+  auto less = builder.CreateCmp(i, builder.CreateImm(10));
+  builder.CreateJeq(less, builder.CreateImm(0), builder.CreateLabel(D));
+
+  builder.SetBBlock(C);
+  auto i1 = builder.CreateAdd(i, a0);
+  builder.CreateJmp(builder.CreateLabel(B));
+  static_cast<InstOperand *>(i)->GetInst()->SetOperand(2, i1);
+
+  builder.SetBBlock(D);
+  builder.CreateRet(i);
+}
+
+static std::string Dump(const Graph &graph) {
+  std::stringstream ss;
+  for (const auto &block : graph.GetBlocks()) {
+    block->Dump(ss);
+    for (const auto &succ : block->GetSuccessors()) {
+      ss << " -> " << succ->GetName();
+    }
+    for (const auto &pred : block->GetPredessors()) {
+      ss << " <- " << pred->GetName();
+    }
+    ss << std::endl;
+  }
+  return ss.str();
+}
+
+// image copied to 8-byte aligned storage
+static std::vector<uint64_t> WriteImage(const Module &module) {
+  std::stringstream ss;
+  WriteBinary(module, ss);
+  std::string bytes = ss.str();
+  std::vector<uint64_t> image((bytes.size() + 7) / 8);
+  std::memcpy(image.data(), bytes.data(), bytes.size());
+  return image;
+}
+
+TEST(BinaryFormat, roundTrip) {
+  Module module;
+  CreateLoop(module.CreateFunction("loop"));
+  Graph &chain = module.CreateFunction("chain");
+  BBlockPtr X = chain.CreateBlock("X");
+  BBlockPtr Y = chain.CreateBlock("Y");
+  chain.CreateEdge(X, Y);
+  IRBuilder builder(X);
+  auto big = builder.CreateMul(builder.CreateImm(~uint64_t(0)),
+                               builder.CreateImm(3));
+  builder.CreateJmp(builder.CreateLabel(Y));
+  builder.SetBBlock(Y);
+  builder.CreateRet(big);
+
+  auto image = WriteImage(module);
+  BinaryModule view(image.data(), image.size() * 8);
+  ASSERT_TRUE(view.IsValid());
+
+  // records are read in place
+  ASSERT_EQ(view.GetNumFunctions(), 2u);
+  const auto &loop = view.GetFunction(0);
+  ASSERT_EQ(view.GetString(loop.name), "loop");
+  ASSERT_EQ(loop.numBlocks, 4u);
+  ASSERT_EQ(loop.numInsts, 8u);
+  ASSERT_EQ(loop.numEdges, 8u);
+  ASSERT_EQ(loop.numImms, 3u);
+  const auto &blockB = view.GetBlocks(loop)[1];
+  ASSERT_EQ(view.GetString(blockB.name), "B");
+  ASSERT_EQ(blockB.numSuccs, 2u);
+  ASSERT_EQ(blockB.numPreds, 2u);
+  const auto &phi = view.GetInsts(loop)[blockB.firstInst];
+  ASSERT_EQ(phi.opcode, OP_phi);
+  ASSERT_EQ(BinaryModule::GetOperandKind(phi.operands[1]), Operand::kLabel);
+  ASSERT_EQ(BinaryModule::GetOperandIndex(phi.operands[1]), 0u);
+  // 'i1' is defined further down
+  ASSERT_EQ(BinaryModule::GetOperandKind(phi.operands[2]), Operand::kInst);
+  ASSERT_EQ(BinaryModule::GetOperandIndex(phi.operands[2]), 5u);
+  ASSERT_EQ(view.GetImms(view.GetFunction(1))[0], ~uint64_t(0));
+
+  auto loaded = ReadBinary(view);
+  ASSERT_EQ(loaded->GetSize(), 2u);
+  for (size_t i = 0; i < module.GetSize(); ++i) {
+    ASSERT_EQ(loaded->GetName(i), module.GetName(i));
+    ASSERT_EQ(Dump(loaded->GetFunction(i)), Dump(module.GetFunction(i)));
+  }
+
+  // use lists are rebuilt
+  Graph &graph = *loaded->FindFunction("loop");
+  Inst *a0 = graph.GetBlocks()[0]->GetInstList().Front();
+  ASSERT_EQ(a0->GetName(), "A0");
+  ASSERT_EQ(a0->GetNumUses(), 2u);
+
+  // the loaded module writes the same image
+  ASSERT_EQ(WriteImage(*loaded), image);
+}
+
+TEST(BinaryFormat, mappedFile) {
+  Module module;
+  CreateLoop(module.CreateFunction("f"));
+  std::string path = testing::TempDir() + "binary_format_test.irb";
+  {
+    std::ofstream file(path, std::ios::binary);
+    WriteBinary(module, file);
+  }
+
+  auto file = MappedFile::Open(path);
+  ASSERT_NE(file, nullptr);
+  BinaryModule view(file->GetData(), file->GetSize());
+  ASSERT_TRUE(view.IsValid());
+  auto loaded = ReadBinary(view);
+  ASSERT_EQ(Dump(loaded->GetFunction(0)), Dump(module.GetFunction(0)));
+  std::remove(path.c_str());
+
+  ASSERT_EQ(MappedFile::Open(path), nullptr);
+}
+
+TEST(BinaryFormat, invalid) {
+  Module module;
+  CreateLoop(module.CreateFunction("f"));
+  auto image = WriteImage(module);
+  size_t size = image.size() * 8;
+
+  ASSERT_FALSE(BinaryModule(image.data(), 8).IsValid());
+  ASSERT_FALSE(BinaryModule(image.data(), size - 16).IsValid());
+  reinterpret_cast<char *>(image.data())[0] = 'X';
+  ASSERT_FALSE(BinaryModule(image.data(), size).IsValid());
+}
+
+TEST(BinaryFormat, corruptRecords) {
+  // every index in the records is checked before the image is read
+  Module module;
+  CreateLoop(module.CreateFunction("f"));
+  const auto image = WriteImage(module);
+  size_t size = image.size() * 8;
+  BinaryModule view(image.data(), size);
+  ASSERT_TRUE(view.IsValid());
+  const auto &func = view.GetFunction(0);
+  auto offsetOf = [&](const void *record) {
+    return static_cast<const char *>(record) -
+           reinterpret_cast<const char *>(image.data());
+  };
+
+  auto corrupt = [&](size_t offset, uint32_t value) {
+    auto copy = image;
+    std::memcpy(reinterpret_cast<char *>(copy.data()) + offset, &value,
+                sizeof(value));
+    BinaryModule corrupted(copy.data(), size);
+    ASSERT_FALSE(corrupted.IsValid()) << offset;
+    ASSERT_EQ(ReadBinary(corrupted), nullptr);
+  };
+  const auto &blockB = view.GetBlocks(func)[1];
+  const auto &phi = view.GetInsts(func)[blockB.firstInst];
+  // out of range instruction operand, label and immediate
+  corrupt(offsetOf(&phi.operands[2]),
+          BinaryModule::EncodeOperand(Operand::kInst, func.numInsts));
+  corrupt(offsetOf(&phi.operands[1]),
+          BinaryModule::EncodeOperand(Operand::kLabel, func.numBlocks));
+  corrupt(offsetOf(&phi.operands[0]),
+          BinaryModule::EncodeOperand(Operand::kImm, func.numImms));
+  corrupt(offsetOf(&phi.operands[0]), 3);
+  corrupt(offsetOf(&phi.opcode), OP_undef);
+  corrupt(offsetOf(&phi.name), view.GetNumStrings());
+  // edges and instructions outside of the function
+  corrupt(offsetOf(&view.GetEdges(func)[0]), func.numBlocks);
+  corrupt(offsetOf(&blockB.numPreds), func.numEdges);
+  corrupt(offsetOf(&blockB.firstInst), 0);
+  corrupt(offsetOf(&blockB.name), view.GetNumStrings());
+  corrupt(offsetOf(&func.name), view.GetNumStrings());
+  // a string going past the next one
+  std::string_view name = view.GetString(blockB.name);
+  corrupt(offsetOf(name.data() + name.size()), 0x41414141);
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include <support/BitVector.h>
+
+TEST(BitVector, setAndFind) {
+  BitVector bv(130);
+  ASSERT_FALSE(bv.Any());
+  bv.Set(0);
+  bv.Set(64);
+  bv.Set(129);
+  ASSERT_TRUE(bv.Test(64));
+  ASSERT_FALSE(bv.Test(65));
+  ASSERT_EQ(bv.Count(), 3u);
+
+  ASSERT_EQ(bv.FindFirst(), 0u);
+  ASSERT_EQ(bv.FindNext(1), 64u);
+  ASSERT_EQ(bv.FindNext(65), 129u);
+  ASSERT_EQ(bv.FindNext(130), BitVector::npos);
+
+  ASSERT_FALSE(bv.TestAndSet(64));
+  ASSERT_TRUE(bv.TestAndSet(65));
+  bv.Reset(0);
+  ASSERT_EQ(bv.FindFirst(), 64u);
+}
+
+TEST(BitVector, resize) {
+  BitVector bv(10, true);
+  ASSERT_EQ(bv.Count(), 10u);
+  bv.Resize(100, true);
+  ASSERT_EQ(bv.Count(), 100u);
+  bv.Resize(70);
+  ASSERT_EQ(bv.Count(), 70u);
+  bv.Resize(200);
+  ASSERT_EQ(bv.Count(), 70u);
+}
+
+TEST(BitVector, setOps) {
+  BitVector a(100), b(100), c(100);
+  a.Set(1);
+  b.Set(1);
+  b.Set(70);
+  c.Set(70);
+
+  ASSERT_TRUE(a.Union(b));
+  ASSERT_FALSE(a.Union(b));
+  ASSERT_EQ(a, b);
+
+  a.Subtract(c);
+  ASSERT_EQ(a.Count(), 1u);
+  ASSERT_TRUE(a.Test(1));
+
+  BitVector d(100);
+  ASSERT_TRUE(d.UnionWithDifference(b, a));
+  ASSERT_EQ(d, c);
+  ASSERT_FALSE(d.UnionWithDifference(b, a));
+}
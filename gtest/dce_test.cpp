@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+#include <passes/DCE.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(DCE, cycles) {
+  // B1 and C1 keep each other alive only, B3 uses itself
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 1\n"
+                "  A1 = add A0 2\n"
+                "  A2 = mul A1 A1\n"
+                "  jmp B\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ C0 C ]\n"
+                "  B1 = phi [ A0 A ] [ C1 C ]\n"
+                "  B3 = phi [ 0 A ] [ B3 C ]\n"
+                "  B2 = cmp B0 10\n"
+                "  jeq B2 0 D\n"
+                "%C:\n"
+                "  C0 = add B0 1\n"
+                "  C1 = add B1 B0\n"
+                "  jmp B\n"
+                "%D:\n"
+                "  ret B0\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+
+  AnalysisManager am(graph);
+  DCE dce;
+  ASSERT_FALSE(dce.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  jmp B\n"
+                         "%B:\n"
+                         "  B0 = phi [ 0 A ] [ C0 C ]\n"
+                         "  B2 = cmp B0 10\n"
+                         "  jeq B2 0 D\n"
+                         "%C:\n"
+                         "  C0 = add B0 1\n"
+                         "  jmp B\n"
+                         "%D:\n"
+                         "  ret B0\n");
+  ASSERT_EQ(dce.GetStats().numErasedInsts, 6u);
+  ASSERT_EQ(dce.GetStats().numErasedPhis, 2u);
+  // the dead users are gone from the use lists
+  Inst *phi = graph.GetBlocks()[1]->GetInstList().Front();
+  ASSERT_EQ(phi->GetNumUses(), 3u);
+  ASSERT_EQ(Interpreter(graph).Run(), 10u);
+
+  ASSERT_TRUE(dce.Run(graph, am).AreAllPreserved());
+}
+
+TEST(DCE, random) {
+  // straight-line code returning one of the values, what is left is used
+  std::mt19937 gen(13);
+  for (size_t round = 0; round < 20; ++round) {
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < 1 + round; ++i) {
+      blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+      if (i != 0) {
+        graph.CreateEdge(blocks[i - 1], blocks[i]);
+      }
+    }
+    IRBuilder builder(blocks[0]);
+    std::vector<Operand *> values{builder.CreateAssign(builder.CreateImm(3))};
+    for (const auto &block : blocks) {
+      builder.SetBBlock(block);
+      for (size_t i = 0; i < 8; ++i) {
+        Operand *lhs = values[gen() % values.size()];
+        Operand *rhs = values[gen() % values.size()];
+        values.push_back(gen() % 2 ? builder.CreateAdd(lhs, rhs)
+                                   : builder.CreateMul(lhs, rhs));
+      }
+    }
+    builder.CreateRet(values[values.size() / 2 + gen() % values.size() / 2]);
+    uint64_t expected = Interpreter(graph).Run();
+
+    AnalysisManager am(graph);
+    DCE dce;
+    dce.Run(graph, am);
+    ASSERT_EQ(Interpreter(graph).Run(), expected);
+    ASSERT_GT(dce.GetStats().numErasedInsts, 0u);
+    for (const auto &block : graph.GetBlocks()) {
+      for (const auto inst : block->GetInstList()) {
+        ASSERT_TRUE(inst->IsRet() || inst->HasUsers());
+      }
+    }
+  }
+}
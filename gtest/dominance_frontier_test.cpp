@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include <passes/DominanceFrontier.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(DominanceFrontier, diamondLoop) {
+  // A -> B -> C -> E -> F
+  //      B -> D -> E -> B
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr U = graph.CreateBlock("U");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, E);
+  graph.CreateEdge(D, E);
+  graph.CreateEdge(E, B);
+  graph.CreateEdge(E, F);
+  graph.CreateEdge(U, E);
+
+  DominatorTree domTree(graph);
+  DominanceFrontier df(graph, domTree);
+
+  using Blocks = std::vector<BBlockPtr>;
+  ASSERT_EQ(df.GetFrontier(A), Blocks());
+  ASSERT_EQ(df.GetFrontier(B), Blocks({B}));
+  ASSERT_EQ(df.GetFrontier(C), Blocks({E}));
+  ASSERT_EQ(df.GetFrontier(D), Blocks({E}));
+  ASSERT_EQ(df.GetFrontier(E), Blocks({B}));
+  ASSERT_EQ(df.GetFrontier(F), Blocks());
+  ASSERT_EQ(df.GetFrontier(U), Blocks());
+
+  Blocks idf;
+  df.GetIteratedFrontier({C}, idf);
+  ASSERT_EQ(idf, Blocks({B, E}));
+  df.GetIteratedFrontier({A, F}, idf);
+  ASSERT_EQ(idf, Blocks());
+  // unreachable definitions are ignored
+  df.GetIteratedFrontier({U}, idf);
+  ASSERT_EQ(idf, Blocks());
+}
+
+// iterated frontiers are compared with the fixpoint of frontiers
+TEST(DominanceFrontier, randomGraphs) {
+  std::mt19937 gen(11);
+  for (size_t iter = 0; iter < 30; ++iter) {
+    const size_t size = 50;
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < size; ++i) {
+      blocks.push_back(graph.CreateBlock(std::to_string(i)));
+    }
+    std::uniform_int_distribution<size_t> dist(0, size - 1);
+    for (size_t i = 0; i < size; ++i) {
+      graph.CreateEdge(blocks[i], blocks[dist(gen)]);
+      graph.CreateEdge(blocks[i], blocks[dist(gen)]);
+    }
+
+    DominatorTree domTree(graph);
+    DominanceFrontier df(graph, domTree);
+
+    // DF(b) = {y : b dominates a predecessor of y, b doesn't strictly
+    // dominate y}
+    for (const auto &b : blocks) {
+      if (!domTree.IsReachable(b)) {
+        continue;
+      }
+      BitVector expected(size);
+      for (const auto &y : blocks) {
+        for (const auto &pred : y->GetPredessors()) {
+          if (domTree.IsReachable(pred) && domTree.IsDominate(b, pred) &&
+              (b == y || !domTree.IsDominate(b, y))) {
+            expected.Set(y->GetId());
+          }
+        }
+      }
+      BitVector actual(size);
+      for (const auto &y : df.GetFrontier(b)) {
+        ASSERT_TRUE(actual.TestAndSet(y->GetId()));
+      }
+      ASSERT_EQ(actual, expected);
+    }
+
+    for (size_t query = 0; query < 10; ++query) {
+      std::vector<BBlockPtr> defs;
+      for (size_t i = 0; i < 1 + query % 4; ++i) {
+        defs.push_back(blocks[dist(gen)]);
+      }
+
+      BitVector expected(size);
+      bool changed = true;
+      while (changed) {
+        changed = false;
+        std::vector<BBlockPtr> sources = defs;
+        for (size_t y = expected.FindFirst(); y != BitVector::npos;
+             y = expected.FindNext(y + 1)) {
+          sources.push_back(blocks[y]);
+        }
+        for (const auto &src : sources) {
+          if (!domTree.IsReachable(src)) {
+            continue;
+          }
+          for (const auto &y : df.GetFrontier(src)) {
+            changed |= expected.TestAndSet(y->GetId());
+          }
+        }
+      }
+
+      std::vector<BBlockPtr> idf;
+      df.GetIteratedFrontier(defs, idf);
+      BitVector actual(size);
+      for (const auto &y : idf) {
+        ASSERT_TRUE(actual.TestAndSet(y->GetId()));
+      }
+      ASSERT_EQ(actual, expected);
+    }
+  }
+}
@@ -2,22 +2,19 @@
 
 #include <passes/DominatorTree.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
 TEST(DomTree, first) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
   graph.CreateEdge(B, F);
@@ -37,32 +34,30 @@ TEST(DomTree, first) {
   ASSERT_TRUE(domTree.IsDominate(F, E));
   ASSERT_TRUE(domTree.IsDominate(F, G));
   ASSERT_FALSE(domTree.IsDominate(F, D));
+
+  std::vector<std::pair<BBlockPtr, BBlockPtr>> queries = {
+      {A, G}, {F, D}, {G, E}, {B, B}};
+  bool result[4];
+  domTree.IsDominateBatch(queries.begin(), queries.end(), result);
+  ASSERT_TRUE(result[0]);
+  ASSERT_FALSE(result[1]);
+  ASSERT_FALSE(result[2]);
+  ASSERT_TRUE(result[3]);
 }
 
 TEST(DomTree, second) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
-  BBlockPtr K = std::make_shared<BBlock>("K");
-  graph.PushBlock(K);
-  BBlockPtr J = std::make_shared<BBlock>("J");
-  graph.PushBlock(J);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
+  BBlockPtr K = graph.CreateBlock("K");
+  BBlockPtr J = graph.CreateBlock("J");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
   graph.CreateEdge(C, D);
@@ -94,24 +89,15 @@ TEST(DomTree, second) {
 
 TEST(DomTree, third) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, E);
   graph.CreateEdge(E, F);
@@ -138,3 +124,171 @@ TEST(DomTree, third) {
   ASSERT_FALSE(domTree.IsDominate(D, C));
   ASSERT_FALSE(domTree.IsDominate(E, D));
 }
+
+TEST(DomTree, idomAndUnreachable) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr U = graph.CreateBlock("U");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(A, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, D);
+  graph.CreateEdge(U, D);
+
+  DominatorTree domTree(graph);
+
+  ASSERT_EQ(domTree.GetRoot()->GetBBlock(), A);
+  ASSERT_EQ(domTree.GetIDom(A), nullptr);
+  ASSERT_EQ(domTree.GetIDom(B), A);
+  ASSERT_EQ(domTree.GetIDom(C), A);
+  ASSERT_EQ(domTree.GetIDom(D), A);
+  ASSERT_EQ(domTree.GetNode(D)->GetLevel(), 1u);
+  ASSERT_FALSE(domTree.IsReachable(U));
+  ASSERT_EQ(domTree.GetIDom(U), nullptr);
+}
+
+// compare with dominator sets computed by iterative dataflow
+TEST(DomTree, randomGraphs) {
+  std::mt19937 gen(7);
+  for (size_t iter = 0; iter < 50; ++iter) {
+    const size_t size = 40;
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < size; ++i) {
+      blocks.push_back(graph.CreateBlock(std::to_string(i)));
+    }
+    std::uniform_int_distribution<size_t> dist(0, size - 1);
+    for (size_t i = 0; i < size; ++i) {
+      graph.CreateEdge(blocks[i], blocks[dist(gen)]);
+      graph.CreateEdge(blocks[i], blocks[dist(gen)]);
+    }
+
+    BitVector reachable(size);
+    (void)graph.GetDfs(blocks[0], reachable);
+
+    std::vector<BitVector> doms(size, BitVector(size, true));
+    doms[0] = BitVector(size);
+    doms[0].Set(0);
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t i = 1; i < size; ++i) {
+        BitVector newDoms(size, true);
+        for (auto pred : blocks[i]->GetPredessors()) {
+          if (reachable.Test(pred->GetId())) {
+            newDoms &= doms[pred->GetId()];
+          }
+        }
+        newDoms.Set(i);
+        if (newDoms != doms[i]) {
+          doms[i] = newDoms;
+          changed = true;
+        }
+      }
+    }
+
+    DominatorTree domTree(graph);
+    for (size_t b = 0; b < size; ++b) {
+      ASSERT_EQ(domTree.IsReachable(blocks[b]), reachable.Test(b));
+      if (!reachable.Test(b)) {
+        continue;
+      }
+      for (size_t d = 0; d < size; ++d) {
+        if (reachable.Test(d)) {
+          ASSERT_EQ(domTree.IsDominate(blocks[d], blocks[b]), doms[b].Test(d));
+        }
+      }
+    }
+  }
+}
+
+TEST(DomTree, incrementalSimple) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+
+  DominatorTree domTree(graph);
+  ASSERT_FALSE(domTree.IsReachable(D));
+
+  // shortcut around B
+  domTree.InsertEdge(graph, A, C);
+  ASSERT_EQ(domTree.GetIDom(C), A);
+  ASSERT_FALSE(domTree.IsDominate(B, C));
+
+  // D becomes reachable
+  domTree.InsertEdge(graph, C, D);
+  ASSERT_TRUE(domTree.IsReachable(D));
+  ASSERT_EQ(domTree.GetIDom(D), C);
+  ASSERT_TRUE(domTree.IsDominate(A, D));
+
+  domTree.DeleteEdge(graph, A, C);
+  ASSERT_EQ(domTree.GetIDom(C), B);
+  ASSERT_TRUE(domTree.IsDominate(B, D));
+
+  // B and everything below becomes unreachable
+  domTree.DeleteEdge(graph, A, B);
+  ASSERT_FALSE(domTree.IsReachable(B));
+  ASSERT_FALSE(domTree.IsReachable(D));
+  ASSERT_EQ(domTree.GetIDom(C), nullptr);
+  ASSERT_TRUE(domTree.Verify(graph));
+
+  domTree.ApplyUpdates(graph, {{DominatorTree::Update::kInsert, A, D},
+                               {DominatorTree::Update::kInsert, D, B}});
+  ASSERT_EQ(domTree.GetIDom(B), D);
+  ASSERT_EQ(domTree.GetIDom(C), B);
+  ASSERT_TRUE(domTree.Verify(graph));
+}
+
+// random edits checked against the tree built from scratch
+TEST(DomTree, incrementalRandom) {
+  std::mt19937 gen(13);
+  for (size_t iter = 0; iter < 30; ++iter) {
+    const size_t size = 30;
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < size; ++i) {
+      blocks.push_back(graph.CreateBlock(std::to_string(i)));
+    }
+    std::uniform_int_distribution<size_t> dist(0, size - 1);
+    for (size_t i = 0; i < size / 2; ++i) {
+      BBlockPtr from = blocks[dist(gen)];
+      if (from->GetSuccessors().size() < 2) {
+        graph.CreateEdge(from, blocks[dist(gen)]);
+      }
+    }
+
+    DominatorTree domTree(graph);
+    for (size_t step = 0; step < 200; ++step) {
+      BBlockPtr from = blocks[dist(gen)];
+      const auto &succs = from->GetSuccessors();
+      std::vector<DominatorTree::Update> updates;
+      if (succs.size() == 2 || (!succs.empty() && gen() % 2)) {
+        BBlockPtr to = succs[gen() % succs.size()];
+        updates.push_back({DominatorTree::Update::kDelete, from, to});
+      } else {
+        updates.push_back({DominatorTree::Update::kInsert, from,
+                           blocks[dist(gen)]});
+      }
+
+      const auto &update = updates.front();
+      if (step % 50 == 49) {
+        domTree.ApplyUpdates(graph, updates);
+      } else if (update.kind == DominatorTree::Update::kInsert) {
+        domTree.InsertEdge(graph, update.from, update.to);
+      } else {
+        domTree.DeleteEdge(graph, update.from, update.to);
+      }
+      ASSERT_TRUE(domTree.Verify(graph));
+    }
+
+    domTree.RemoveBlock(graph, blocks[dist(gen)]);
+    ASSERT_TRUE(domTree.Verify(graph));
+  }
+}
@@ -4,20 +4,13 @@
 
 #define INIT_FIRST_GRAPH(NAME)                                                 \
   Graph NAME;                                                                  \
-  BBlockPtr A = std::make_shared<BBlock>("A");                                 \
-  NAME.PushBlock(A);                                                           \
-  BBlockPtr B = std::make_shared<BBlock>("B");                                 \
-  NAME.PushBlock(B);                                                           \
-  BBlockPtr C = std::make_shared<BBlock>("C");                                 \
-  NAME.PushBlock(C);                                                           \
-  BBlockPtr D = std::make_shared<BBlock>("D");                                 \
-  NAME.PushBlock(D);                                                           \
-  BBlockPtr E = std::make_shared<BBlock>("E");                                 \
-  NAME.PushBlock(E);                                                           \
-  BBlockPtr F = std::make_shared<BBlock>("F");                                 \
-  NAME.PushBlock(F);                                                           \
-  BBlockPtr G = std::make_shared<BBlock>("G");                                 \
-  NAME.PushBlock(G);                                                           \
+  BBlockPtr A = NAME.CreateBlock("A");                                         \
+  BBlockPtr B = NAME.CreateBlock("B");                                         \
+  BBlockPtr C = NAME.CreateBlock("C");                                         \
+  BBlockPtr D = NAME.CreateBlock("D");                                         \
+  BBlockPtr E = NAME.CreateBlock("E");                                         \
+  BBlockPtr F = NAME.CreateBlock("F");                                         \
+  BBlockPtr G = NAME.CreateBlock("G");                                         \
   NAME.CreateEdge(A, B);                                                       \
   NAME.CreateEdge(B, C);                                                       \
   NAME.CreateEdge(B, F);                                                       \
@@ -30,28 +23,17 @@
 
 #define INIT_SECOND_GRAPH(NAME)                                                \
   Graph NAME;                                                                  \
-  BBlockPtr A = std::make_shared<BBlock>("A");                                 \
-  NAME.PushBlock(A);                                                           \
-  BBlockPtr B = std::make_shared<BBlock>("B");                                 \
-  NAME.PushBlock(B);                                                           \
-  BBlockPtr C = std::make_shared<BBlock>("C");                                 \
-  NAME.PushBlock(C);                                                           \
-  BBlockPtr D = std::make_shared<BBlock>("D");                                 \
-  NAME.PushBlock(D);                                                           \
-  BBlockPtr E = std::make_shared<BBlock>("E");                                 \
-  NAME.PushBlock(E);                                                           \
-  BBlockPtr F = std::make_shared<BBlock>("F");                                 \
-  NAME.PushBlock(F);                                                           \
-  BBlockPtr G = std::make_shared<BBlock>("G");                                 \
-  NAME.PushBlock(G);                                                           \
-  BBlockPtr H = std::make_shared<BBlock>("H");                                 \
-  NAME.PushBlock(H);                                                           \
-  BBlockPtr I = std::make_shared<BBlock>("I");                                 \
-  NAME.PushBlock(I);                                                           \
-  BBlockPtr K = std::make_shared<BBlock>("K");                                 \
-  NAME.PushBlock(K);                                                           \
-  BBlockPtr J = std::make_shared<BBlock>("J");                                 \
-  NAME.PushBlock(J);                                                           \
+  BBlockPtr A = NAME.CreateBlock("A");                                         \
+  BBlockPtr B = NAME.CreateBlock("B");                                         \
+  BBlockPtr C = NAME.CreateBlock("C");                                         \
+  BBlockPtr D = NAME.CreateBlock("D");                                         \
+  BBlockPtr E = NAME.CreateBlock("E");                                         \
+  BBlockPtr F = NAME.CreateBlock("F");                                         \
+  BBlockPtr G = NAME.CreateBlock("G");                                         \
+  BBlockPtr H = NAME.CreateBlock("H");                                         \
+  BBlockPtr I = NAME.CreateBlock("I");                                         \
+  BBlockPtr K = NAME.CreateBlock("K");                                         \
+  BBlockPtr J = NAME.CreateBlock("J");                                         \
   NAME.CreateEdge(A, B);                                                       \
   NAME.CreateEdge(B, C);                                                       \
   NAME.CreateEdge(C, D);                                                       \
@@ -69,24 +51,15 @@
 
 #define INIT_THIRD_GRAPH(NAME)                                                 \
   Graph NAME;                                                                  \
-  BBlockPtr A = std::make_shared<BBlock>("A");                                 \
-  NAME.PushBlock(A);                                                           \
-  BBlockPtr B = std::make_shared<BBlock>("B");                                 \
-  NAME.PushBlock(B);                                                           \
-  BBlockPtr C = std::make_shared<BBlock>("C");                                 \
-  NAME.PushBlock(C);                                                           \
-  BBlockPtr D = std::make_shared<BBlock>("D");                                 \
-  NAME.PushBlock(D);                                                           \
-  BBlockPtr E = std::make_shared<BBlock>("E");                                 \
-  NAME.PushBlock(E);                                                           \
-  BBlockPtr F = std::make_shared<BBlock>("F");                                 \
-  NAME.PushBlock(F);                                                           \
-  BBlockPtr G = std::make_shared<BBlock>("G");                                 \
-  NAME.PushBlock(G);                                                           \
-  BBlockPtr H = std::make_shared<BBlock>("H");                                 \
-  NAME.PushBlock(H);                                                           \
-  BBlockPtr I = std::make_shared<BBlock>("I");                                 \
-  NAME.PushBlock(I);                                                           \
+  BBlockPtr A = NAME.CreateBlock("A");                                         \
+  BBlockPtr B = NAME.CreateBlock("B");                                         \
+  BBlockPtr C = NAME.CreateBlock("C");                                         \
+  BBlockPtr D = NAME.CreateBlock("D");                                         \
+  BBlockPtr E = NAME.CreateBlock("E");                                         \
+  BBlockPtr F = NAME.CreateBlock("F");                                         \
+  BBlockPtr G = NAME.CreateBlock("G");                                         \
+  BBlockPtr H = NAME.CreateBlock("H");                                         \
+  BBlockPtr I = NAME.CreateBlock("I");                                         \
   NAME.CreateEdge(A, B);                                                       \
   NAME.CreateEdge(B, E);                                                       \
   NAME.CreateEdge(E, F);                                                       \
@@ -102,24 +75,15 @@
 
 #define INIT_THIRD_GRAPH(NAME)                                                 \
   Graph NAME;                                                                  \
-  BBlockPtr A = std::make_shared<BBlock>("A");                                 \
-  NAME.PushBlock(A);                                                           \
-  BBlockPtr B = std::make_shared<BBlock>("B");                                 \
-  NAME.PushBlock(B);                                                           \
-  BBlockPtr C = std::make_shared<BBlock>("C");                                 \
-  NAME.PushBlock(C);                                                           \
-  BBlockPtr D = std::make_shared<BBlock>("D");                                 \
-  NAME.PushBlock(D);                                                           \
-  BBlockPtr E = std::make_shared<BBlock>("E");                                 \
-  NAME.PushBlock(E);                                                           \
-  BBlockPtr F = std::make_shared<BBlock>("F");                                 \
-  NAME.PushBlock(F);                                                           \
-  BBlockPtr G = std::make_shared<BBlock>("G");                                 \
-  NAME.PushBlock(G);                                                           \
-  BBlockPtr H = std::make_shared<BBlock>("H");                                 \
-  NAME.PushBlock(H);                                                           \
-  BBlockPtr I = std::make_shared<BBlock>("I");                                 \
-  NAME.PushBlock(I);                                                           \
+  BBlockPtr A = NAME.CreateBlock("A");                                         \
+  BBlockPtr B = NAME.CreateBlock("B");                                         \
+  BBlockPtr C = NAME.CreateBlock("C");                                         \
+  BBlockPtr D = NAME.CreateBlock("D");                                         \
+  BBlockPtr E = NAME.CreateBlock("E");                                         \
+  BBlockPtr F = NAME.CreateBlock("F");                                         \
+  BBlockPtr G = NAME.CreateBlock("G");                                         \
+  BBlockPtr H = NAME.CreateBlock("H");                                         \
+  BBlockPtr I = NAME.CreateBlock("I");                                         \
   NAME.CreateEdge(A, B);                                                       \
   NAME.CreateEdge(B, E);                                                       \
   NAME.CreateEdge(E, F);                                                       \
@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+#include <passes/GVN.h>
+
+#include <random>
+#include <vector>
+
+TEST(GVN, dominators) {
+  // B and C don't see each other, D sees only A
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 5\n"
+                "  A1 = add A0 3\n"
+                "  A2 = add 3 A0\n"
+                "  A3 = cmp A0 A1\n"
+                "  jeq A3 0 C\n"
+                "%B:\n"
+                "  B0 = add A0 3\n"
+                "  B1 = assign A1\n"
+                "  B2 = mul B0 B1\n"
+                "  jmp D\n"
+                "%C:\n"
+                "  C0 = mul A1 A1\n"
+                "  C1 = cmp A1 A0\n"
+                "  jmp D\n"
+                "%D:\n"
+                "  D0 = phi [ B2 B ] [ C0 C ]\n"
+                "  D1 = mul A2 A1\n"
+                "  D2 = add D0 D1\n"
+                "  ret D2\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  uint64_t expected = Interpreter(graph).Run();
+
+  AnalysisManager am(graph);
+  GVN gvn;
+  PreservedAnalyses preserved = gvn.Run(graph, am);
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 5\n"
+                         "  A1 = add A0 3\n"
+                         "  A3 = cmp A0 A1\n"
+                         "  jeq A3 0 C\n"
+                         "%B:\n"
+                         "  B2 = mul A1 A1\n"
+                         "  jmp D\n"
+                         "%C:\n"
+                         "  C0 = mul A1 A1\n"
+                         "  C1 = cmp A1 A0\n"
+                         "  jmp D\n"
+                         "%D:\n"
+                         "  D0 = phi [ B2 B ] [ C0 C ]\n"
+                         "  D1 = mul A1 A1\n"
+                         "  D2 = add D0 D1\n"
+                         "  ret D2\n");
+  ASSERT_EQ(Interpreter(graph).Run(), expected);
+  ASSERT_EQ(gvn.GetStats().numEliminatedInsts, 2u);
+  ASSERT_EQ(gvn.GetStats().numPropagatedCopies, 1u);
+
+  // the CFG is the same
+  am.Invalidate(preserved);
+  ASSERT_NE(am.GetCached<DominatorTree>(), nullptr);
+  ASSERT_TRUE(gvn.Run(graph, am).AreAllPreserved());
+}
+
+// for (i = 0; i < 10; ++i) a chain of diamonds computing random
+// expressions of the values of the dominating blocks
+static void CreateRedundant(Graph &graph, std::mt19937 &gen, size_t size) {
+  BBlockPtr entry = graph.CreateBlock("entry");
+  BBlockPtr header = graph.CreateBlock("header");
+  BBlockPtr exit = graph.CreateBlock("exit");
+  graph.CreateEdge(entry, header);
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  builder.CreateJmp(builder.CreateLabel(header));
+
+  builder.SetBBlock(header);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(entry));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(entry));
+  std::vector<Operand *> dominating{i, sum};
+  auto compute = [&](std::vector<Operand *> &values) {
+    Operand *lhs = values[values.size() - 1 - gen() % 4 % values.size()];
+    Operand *rhs = gen() % 2 ? builder.CreateImm(gen() % 3)
+                             : values[values.size() - 1 -
+                                      gen() % 4 % values.size()];
+    switch (gen() % 3) {
+    case 0:
+      return builder.CreateAdd(lhs, rhs);
+    case 1:
+      return builder.CreateMul(lhs, rhs);
+    default:
+      return builder.CreateCmp(lhs, rhs);
+    }
+  };
+
+  BBlockPtr prev = graph.CreateBlock("body");
+  graph.CreateEdge(header, prev);
+  graph.CreateEdge(header, exit);
+  auto less = builder.CreateCmp(i, builder.CreateImm(10));
+  builder.CreateJeq(less, zero, builder.CreateLabel(exit));
+  builder.SetBBlock(prev);
+  for (size_t d = 0; d < size; ++d) {
+    BBlockPtr then = graph.CreateBlock("then");
+    BBlockPtr other = graph.CreateBlock("else");
+    BBlockPtr join = graph.CreateBlock("join");
+    graph.CreateEdge(prev, then);
+    graph.CreateEdge(prev, other);
+    graph.CreateEdge(then, join);
+    graph.CreateEdge(other, join);
+    builder.CreateJeq(compute(dominating), zero, builder.CreateLabel(other));
+
+    std::vector<Operand *> thenValues = dominating;
+    builder.SetBBlock(then);
+    for (size_t j = 0; j < 3; ++j) {
+      thenValues.push_back(compute(thenValues));
+    }
+    builder.CreateJmp(builder.CreateLabel(join));
+    std::vector<Operand *> otherValues = dominating;
+    builder.SetBBlock(other);
+    for (size_t j = 0; j < 3; ++j) {
+      otherValues.push_back(compute(otherValues));
+    }
+    builder.CreateJmp(builder.CreateLabel(join));
+
+    builder.SetBBlock(join);
+    dominating.push_back(builder.CreatePhi(
+        thenValues.back(), builder.CreateLabel(then), otherValues.back(),
+        builder.CreateLabel(other)));
+    for (size_t j = 0; j < 3; ++j) {
+      dominating.push_back(compute(dominating));
+    }
+    prev = join;
+  }
+  graph.CreateEdge(prev, header);
+  auto iNext = builder.CreateAdd(i, builder.CreateImm(1));
+  auto sumNext = builder.CreateAdd(sum, dominating.back());
+  builder.CreateJmp(builder.CreateLabel(header));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(i)->SetOperand(3, builder.CreateLabel(prev));
+  GetInst(sum)->SetOperand(2, sumNext);
+  GetInst(sum)->SetOperand(3, builder.CreateLabel(prev));
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+}
+
+TEST(GVN, random) {
+  std::mt19937 gen(11);
+  uint64_t numEliminated = 0;
+  for (size_t round = 0; round < 20; ++round) {
+    Graph graph;
+    CreateRedundant(graph, gen, 1 + round);
+    uint64_t expected = Interpreter(graph).Run();
+
+    AnalysisManager am(graph);
+    GVN gvn;
+    gvn.Run(graph, am);
+    ASSERT_EQ(Interpreter(graph).Run(), expected);
+    numEliminated += gvn.GetStats().numEliminatedInsts;
+  }
+  ASSERT_GT(numEliminated, 0u);
+}
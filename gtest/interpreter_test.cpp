@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include <interp/Interpreter.h>
+
+#include <sstream>
+
+TEST(Interpreter, straightLine) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  graph.CreateEdge(A, B);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(6));
+  auto a1 = builder.CreateMul(a0, builder.CreateImm(7));
+  builder.SetBBlock(B);
+  auto b0 = builder.CreateCmp(a1, builder.CreateImm(100));
+  builder.CreateRet(builder.CreateAdd(a1, b0));
+
+  Interpreter interp(graph);
+  uint64_t executed = 0;
+  ASSERT_EQ(interp.Run(executed), 43u);
+  // A falls through to B without a jump
+  ASSERT_EQ(executed, 5u);
+}
+
+// sum of 0..n-1
+TEST(Interpreter, loop) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, B);
+
+  IRBuilder builder(A);
+  auto zero = builder.CreateImm(0);
+  builder.CreateJmp(builder.CreateLabel(B));
+
+  builder.SetBBlock(B);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(A), zero,
+                             builder.CreateLabel(C));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(A), zero,
+                               builder.CreateLabel(C));
+  auto less = builder.CreateCmp(i, builder.CreateImm(10));
+  builder.CreateJeq(less, zero, builder.CreateLabel(D));
+
+  builder.SetBBlock(C);
+  auto sumNext = builder.CreateAdd(sum, i);
+  auto iNext = builder.CreateAdd(i, builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(B));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(sum)->SetOperand(2, sumNext);
+
+  builder.SetBBlock(D);
+  builder.CreateRet(sum);
+
+  Interpreter interp(graph);
+  ASSERT_EQ(interp.Run(), 45u);
+  // the result doesn't depend on the previous run
+  ASSERT_EQ(interp.Run(), 45u);
+}
+
+// phis swapping their values need a parallel copy
+TEST(Interpreter, swapPhis) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, B);
+  graph.CreateEdge(B, C);
+
+  IRBuilder builder(A);
+  auto one = builder.CreateImm(1);
+  auto two = builder.CreateImm(2);
+
+  builder.SetBBlock(B);
+  auto x = builder.CreatePhi(one, builder.CreateLabel(A), one,
+                             builder.CreateLabel(B));
+  auto y = builder.CreatePhi(two, builder.CreateLabel(A), two,
+                             builder.CreateLabel(B));
+  auto n = builder.CreatePhi(builder.CreateImm(0), builder.CreateLabel(A),
+                             one, builder.CreateLabel(B));
+  auto nNext = builder.CreateAdd(n, one);
+  GetInst(x)->SetOperand(2, y);
+  GetInst(y)->SetOperand(2, x);
+  GetInst(n)->SetOperand(2, nNext);
+  builder.CreateJeq(nNext, builder.CreateImm(3), builder.CreateLabel(C));
+  // B -> B is the other successor of the jeq
+
+  builder.SetBBlock(C);
+  auto x10 = builder.CreateMul(x, builder.CreateImm(10));
+  builder.CreateRet(builder.CreateAdd(x10, y));
+
+  Interpreter interp(graph);
+  // (1, 2) -> (2, 1) -> (1, 2) when the loop exits
+  ASSERT_EQ(interp.Run(), 12u);
+
+  std::ostringstream os;
+  interp.DumpBytecode(os);
+  ASSERT_FALSE(os.str().empty());
+}
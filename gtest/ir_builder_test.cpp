@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
+
+#include <sstream>
+#include <vector>
+
+static std::vector<Inst *> ToVector(BBlock::InstList &list) {
+  return std::vector<Inst *>(list.begin(), list.end());
+}
+
+TEST(IRBuilder, insertOrder) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  graph.CreateEdge(A, C);
+  graph.CreateEdge(B, C);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(C));
+
+  builder.SetBBlock(B);
+  auto b0 = builder.CreateAssign(builder.CreateImm(2));
+  builder.CreateJmp(builder.CreateLabel(C));
+
+  builder.SetBBlock(C);
+  auto c0 = builder.CreatePhi(a0, builder.CreateLabel(A), b0,
+                              builder.CreateLabel(B));
+  auto c1 = builder.CreateAdd(c0, c0);
+  // phi is inserted to the phi prefix, before the add
+  auto c2 = builder.CreatePhi(b0, builder.CreateLabel(B), a0,
+                              builder.CreateLabel(A));
+  builder.CreateRet(c1);
+
+  ASSERT_EQ(A->GetInstCount(), 2u);
+  ASSERT_EQ(C->GetInstCount(), 4u);
+
+  std::vector<Inst *> phis;
+  for (auto phi : C->GetPhis()) {
+    phis.push_back(phi);
+  }
+  ASSERT_EQ(phis.size(), 2u);
+  ASSERT_EQ(phis[0]->GetName(), "C0");
+  ASSERT_EQ(phis[1]->GetName(), "C2");
+
+  std::ostringstream os;
+  C->Dump(os);
+  ASSERT_EQ(os.str(), "%C:\n"
+                      "  C0 = phi [ A0 A ] [ B0 B ]\n"
+                      "  C2 = phi [ B0 B ] [ A0 A ]\n"
+                      "  C1 = add C0 C0\n"
+                      "  ret C1\n");
+  (void)c2;
+}
+
+TEST(IRBuilder, eraseAndMove) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  graph.CreateEdge(A, B);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  auto a1 = builder.CreateAdd(a0, builder.CreateImm(2));
+  auto a2 = builder.CreateMul(a1, a1);
+  builder.CreateJmp(builder.CreateLabel(B));
+
+  builder.SetBBlock(B);
+  builder.CreateRet(a2);
+
+  auto list = ToVector(A->GetInstList());
+  Inst *add = list[1];
+  Inst *mul = list[2];
+
+  add->EraseFromBBlock();
+  ASSERT_EQ(A->GetInstCount(), 3u);
+  ASSERT_FALSE(add->IsLinked());
+
+  Inst *ret = B->GetInstList().Front();
+  mul->MoveBefore(ret);
+  ASSERT_EQ(mul->GetBBlock(), B);
+  ASSERT_EQ(ToVector(B->GetInstList()), (std::vector<Inst *>{mul, ret}));
+  ASSERT_EQ(A->GetInstCount(), 2u);
+
+  add->MoveToEnd(B);
+  ASSERT_EQ(ToVector(B->GetInstList()), (std::vector<Inst *>{mul, ret, add}));
+}
+
+static std::vector<Inst *> Users(const Inst *inst) {
+  auto users = inst->GetUsers();
+  return std::vector<Inst *>(users.begin(), users.end());
+}
+
+TEST(IRBuilder, useDefChains) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  auto a1 = builder.CreateAdd(a0, builder.CreateImm(2));
+  auto a2 = builder.CreateMul(a1, a0);
+  auto a3 = builder.CreateAdd(a2, a2);
+  builder.CreateRet(a3);
+
+  auto list = ToVector(A->GetInstList());
+  Inst *assign = list[0];
+  Inst *add = list[1];
+  Inst *mul = list[2];
+  Inst *add2 = list[3];
+  Inst *ret = list[4];
+
+  ASSERT_EQ(Users(assign), (std::vector<Inst *>{add, mul}));
+  // one user per operand slot
+  ASSERT_EQ(Users(mul), (std::vector<Inst *>{add2, add2}));
+  ASSERT_EQ(ret->GetNumUses(), 0u);
+
+  mul->SetOperand(1, builder.CreateImm(3));
+  ASSERT_EQ(Users(assign), (std::vector<Inst *>{add}));
+
+  add->ReplaceAllUsesWith(a0);
+  ASSERT_FALSE(add->HasUsers());
+  ASSERT_EQ(Users(assign), (std::vector<Inst *>{add, mul}));
+  ASSERT_EQ(mul->GetOperand(0), a0);
+
+  mul->ReplaceAllUsesWith(builder.CreateInstOperand(assign));
+  ASSERT_EQ(assign->GetNumUses(), 4u);
+  for (const auto *use : assign->GetUses()) {
+    ASSERT_EQ(use->GetUser()->GetOperand(use->GetOperandNo())->IsInst(),
+              true);
+  }
+
+  add2->EraseFromBBlock();
+  add2->DropAllReferences();
+  ASSERT_EQ(Users(assign), (std::vector<Inst *>{add, mul}));
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+#include <passes/LICM.h>
+
+TEST(LICM, nested) {
+  // A and C already are the preheaders of the loops at B and D, D2 is
+  // invariant in both loops, D3 in the inner one only
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 5\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ E0 E ]\n"
+                "  B1 = phi [ 0 A ] [ E1 E ]\n"
+                "  B2 = cmp B0 4\n"
+                "  jeq B2 0 F\n"
+                "%C:\n"
+                "  C0 = mul B0 3\n"
+                "%D:\n"
+                "  D0 = phi [ 0 C ] [ D4 D ]\n"
+                "  D1 = phi [ B1 C ] [ D5 D ]\n"
+                "  D2 = mul A0 A0\n"
+                "  D3 = add C0 D2\n"
+                "  D5 = add D1 D3\n"
+                "  D4 = add D0 1\n"
+                "  D6 = cmp D4 3\n"
+                "  jne D6 0 D\n"
+                "%E:\n"
+                "  E0 = add B0 1\n"
+                "  E1 = assign D5\n"
+                "  jmp B\n"
+                "%F:\n"
+                "  ret B1\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  uint64_t executed = 0;
+  uint64_t expected = Interpreter(graph).Run(executed);
+
+  AnalysisManager am(graph);
+  LICM licm;
+  ASSERT_FALSE(licm.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 5\n"
+                         "  D2 = mul A0 A0\n"
+                         "%B:\n"
+                         "  B0 = phi [ 0 A ] [ E0 E ]\n"
+                         "  B1 = phi [ 0 A ] [ E1 E ]\n"
+                         "  B2 = cmp B0 4\n"
+                         "  jeq B2 0 F\n"
+                         "%C:\n"
+                         "  C0 = mul B0 3\n"
+                         "  D3 = add C0 D2\n"
+                         "%D:\n"
+                         "  D0 = phi [ 0 C ] [ D4 D ]\n"
+                         "  D1 = phi [ B1 C ] [ D5 D ]\n"
+                         "  D5 = add D1 D3\n"
+                         "  D4 = add D0 1\n"
+                         "  D6 = cmp D4 3\n"
+                         "  jne D6 0 D\n"
+                         "%E:\n"
+                         "  E0 = add B0 1\n"
+                         "  E1 = assign D5\n"
+                         "  jmp B\n"
+                         "%F:\n"
+                         "  ret B1\n");
+  // D2 moved twice
+  ASSERT_EQ(licm.GetStats().numHoistedInsts, 3u);
+  ASSERT_EQ(licm.GetStats().numCreatedPreheaders, 0u);
+
+  uint64_t hoistedExecuted = 0;
+  ASSERT_EQ(Interpreter(graph).Run(hoistedExecuted), expected);
+  ASSERT_LT(hoistedExecuted, executed);
+
+  ASSERT_TRUE(licm.Run(graph, am).AreAllPreserved());
+}
+
+TEST(LICM, guardedLoop) {
+  // A branches around the loop, its preheader goes between A and B
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 3\n"
+                "  jeq A0 0 D\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ B2 B ]\n"
+                "  B1 = mul A0 A0\n"
+                "  B2 = add B0 B1\n"
+                "  B3 = cmp B2 100\n"
+                "  jne B3 0 B\n"
+                "%C:\n"
+                "  ret B2\n"
+                "%D:\n"
+                "  ret 0\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  uint64_t expected = Interpreter(graph).Run();
+
+  AnalysisManager am(graph);
+  LICM licm;
+  ASSERT_FALSE(licm.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 3\n"
+                         "  jeq A0 0 D\n"
+                         "%B.preheader:\n"
+                         "  B1 = mul A0 A0\n"
+                         "  jmp B\n"
+                         "%B:\n"
+                         "  B0 = phi [ 0 B.preheader ] [ B2 B ]\n"
+                         "  B2 = add B0 B1\n"
+                         "  B3 = cmp B2 100\n"
+                         "  jne B3 0 B\n"
+                         "%C:\n"
+                         "  ret B2\n"
+                         "%D:\n"
+                         "  ret 0\n");
+  ASSERT_EQ(licm.GetStats().numCreatedPreheaders, 1u);
+  ASSERT_EQ(Interpreter(graph).Run(), expected);
+  ExpectRoundTrip(graph, expected);
+
+  // the new preheader is reused
+  AnalysisManager newAm(graph);
+  ASSERT_TRUE(licm.Run(graph, newAm).AreAllPreserved());
+}
+
+TEST(LICM, latchBeforeHead) {
+  // H is entered from A and B, the latch L falls through to H, so the
+  // preheader goes to the end and A and B jump to it
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 2\n"
+                "  jeq A0 0 H\n"
+                "%B:\n"
+                "  B0 = add A0 1\n"
+                "  jmp H\n"
+                "%L:\n"
+                "  L0 = add H1 1\n"
+                "%H:\n"
+                "  H0 = mul A0 3\n"
+                "  H1 = add H0 1\n"
+                "  jne H1 7 L\n"
+                "%X:\n"
+                "  ret H1\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  uint64_t expected = Interpreter(graph).Run();
+
+  AnalysisManager am(graph);
+  LICM licm;
+  licm.Run(graph, am);
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 2\n"
+                         "  jeq A0 0 H.preheader\n"
+                         "%B:\n"
+                         "  B0 = add A0 1\n"
+                         "  jmp H.preheader\n"
+                         "%L:\n"
+                         "%H:\n"
+                         "  jne H1 7 L\n"
+                         "%X:\n"
+                         "  ret H1\n"
+                         "%H.preheader:\n"
+                         "  H0 = mul A0 3\n"
+                         "  H1 = add H0 1\n"
+                         "  L0 = add H1 1\n"
+                         "  jmp H\n");
+  ASSERT_EQ(Interpreter(graph).Run(), expected);
+  ExpectRoundTrip(graph, expected);
+}
@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <passes/Liveness.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST(Liveness, loop) {
+  // A: a0 = 1, jmp B
+  // B: i = phi [a0 A] [i1 C], cmp i 10, jeq D
+  // C: i1 = add i a0, jmp B
+  // D: ret i
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, B);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(B));
+
+  builder.SetBBlock(B);
+  auto i = builder.CreatePhi(a0, builder.CreateLabel(A), a0,
+                             builder.CreateLabel(C));
+  auto less = builder.CreateCmp(i, builder.CreateImm(10));
+  builder.CreateJeq(less, builder.CreateImm(0), builder.CreateLabel(D));
+
+  builder.SetBBlock(C);
+  auto i1 = builder.CreateAdd(i, a0);
+  builder.CreateJmp(builder.CreateLabel(B));
+  GetInst(i)->SetOperand(2, i1);
+
+  builder.SetBBlock(D);
+  builder.CreateRet(i);
+
+  LoopTree loopTree(graph);
+  Liveness liveness(graph, loopTree);
+
+  // 'less' is used only in its block
+  ASSERT_EQ(liveness.GetValueIndex(GetInst(less)), Liveness::npos);
+  ASSERT_EQ(liveness.GetNumValues(), 3u);
+
+  Inst *a0Inst = GetInst(a0);
+  Inst *iInst = GetInst(i);
+  Inst *i1Inst = GetInst(i1);
+  ASSERT_TRUE(liveness.IsLiveOut(A, a0Inst));
+  ASSERT_TRUE(liveness.IsLiveIn(B, a0Inst));
+  ASSERT_TRUE(liveness.IsLiveIn(C, a0Inst));
+  ASSERT_TRUE(liveness.IsLiveOut(C, a0Inst));
+  ASSERT_FALSE(liveness.IsLiveIn(D, a0Inst));
+
+  // phi result is defined at the beginning of the block
+  ASSERT_FALSE(liveness.IsLiveIn(B, iInst));
+  ASSERT_TRUE(liveness.IsLiveOut(B, iInst));
+  ASSERT_TRUE(liveness.IsLiveIn(D, iInst));
+  ASSERT_FALSE(liveness.IsLiveOut(C, iInst));
+
+  // phi operand is live only on its edge
+  ASSERT_TRUE(liveness.IsLiveOut(C, i1Inst));
+  ASSERT_FALSE(liveness.IsLiveIn(B, i1Inst));
+}
+
+// compare with round-robin iteration of the same equations
+TEST(Liveness, randomGraphs) {
+  std::mt19937 gen(5);
+  for (size_t iter = 0; iter < 20; ++iter) {
+    const size_t size = 30;
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < size; ++i) {
+      blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+    }
+    std::uniform_int_distribution<size_t> dist(0, size - 1);
+    // forward edges and back edges to dominators keep the graph reducible
+    for (size_t i = 0; i + 1 < size; ++i) {
+      graph.CreateEdge(blocks[i], blocks[i + 1 + gen() % (size - i - 1)]);
+    }
+    DominatorTree domTree(graph);
+    for (size_t i = 1; i < size; ++i) {
+      if (gen() % 2) {
+        BBlockPtr dom = blocks[i];
+        for (size_t up = gen() % 4; up && domTree.GetIDom(dom); --up) {
+          dom = domTree.GetIDom(dom);
+        }
+        graph.CreateEdge(blocks[i], dom);
+      }
+    }
+
+    // every block defines a value and uses values of random blocks
+    IRBuilder builder(blocks[0]);
+    std::vector<Operand *> defs;
+    for (const auto &block : blocks) {
+      builder.SetBBlock(block);
+      defs.push_back(builder.CreateAssign(builder.CreateImm(0)));
+    }
+    for (const auto &block : blocks) {
+      builder.SetBBlock(block);
+      builder.CreateAdd(defs[dist(gen)], defs[dist(gen)]);
+    }
+
+    LoopTree loopTree(graph);
+    Liveness liveness(graph, loopTree);
+
+    std::vector<std::set<Inst *>> in(size);
+    std::vector<std::set<Inst *>> out(size);
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (const auto &block : blocks) {
+        std::set<Inst *> newOut;
+        for (const auto &succ : block->GetSuccessors()) {
+          newOut.insert(in[succ->GetId()].begin(), in[succ->GetId()].end());
+        }
+        std::set<Inst *> newIn = newOut;
+        Inst *def = GetInst(defs[block->GetId()]);
+        newIn.erase(def);
+        for (const auto inst : block->GetInstList()) {
+          for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+            Operand *opnd = inst->GetOperand(i);
+            if (opnd->IsInst() && GetInst(opnd)->GetBBlock() != block) {
+              newIn.insert(GetInst(opnd));
+            }
+          }
+        }
+        if (newIn != in[block->GetId()] || newOut != out[block->GetId()]) {
+          in[block->GetId()] = newIn;
+          out[block->GetId()] = newOut;
+          changed = true;
+        }
+      }
+    }
+
+    for (const auto &block : blocks) {
+      for (const auto &def : defs) {
+        Inst *inst = GetInst(def);
+        ASSERT_EQ(liveness.IsLiveIn(block, inst),
+                  in[block->GetId()].count(inst) != 0);
+        ASSERT_EQ(liveness.IsLiveOut(block, inst),
+                  out[block->GetId()].count(inst) != 0);
+      }
+    }
+  }
+}
@@ -2,23 +2,20 @@
 
 #include <passes/LoopAnalysis.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
 // 1st graph from 2nd slide of 3rd-assigment.pptx
 TEST(LoopAnalysis, first) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
   graph.CreateEdge(B, E);
@@ -47,28 +44,17 @@ TEST(LoopAnalysis, first) {
 // 2nd graph from 2nd slide of 3rd-assigment.pptx
 TEST(LoopAnalysis, second) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
-  BBlockPtr K = std::make_shared<BBlock>("K");
-  graph.PushBlock(K);
-  BBlockPtr L = std::make_shared<BBlock>("L");
-  graph.PushBlock(L);
-  BBlockPtr M = std::make_shared<BBlock>("M");
-  graph.PushBlock(M);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
+  BBlockPtr K = graph.CreateBlock("K");
+  BBlockPtr L = graph.CreateBlock("L");
+  BBlockPtr M = graph.CreateBlock("M");
 
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
@@ -115,7 +101,7 @@ TEST(LoopAnalysis, second) {
 
   // loop0: head B, back edge src M, sources I, C
   ASSERT_EQ(loop0->GetHead() == B, true);
-  ASSERT_EQ(loop0->GetBackEdges() == std::set<BBlockPtr>{M}, true);
+  ASSERT_EQ(loop0->GetBackEdges() == std::vector<BBlockPtr>{M}, true);
   ASSERT_EQ(loopTree.GetLoopNode(I) == loop0, true);
   ASSERT_EQ(loopTree.GetLoopNode(C) == loop0, true);
   // root -> loop0
@@ -123,37 +109,28 @@ TEST(LoopAnalysis, second) {
 
   // loop1: head E, back edge src F
   ASSERT_EQ(loop1->GetHead() == E, true);
-  ASSERT_EQ(loop1->GetBackEdges() == std::set<BBlockPtr>{F}, true);
+  ASSERT_EQ(loop1->GetBackEdges() == std::vector<BBlockPtr>{F}, true);
   // loop0 -> loop1
   ASSERT_EQ(loop1->GetOuterLoop() == loop0, true);
 
   // loop2: head G, back edge src H
   ASSERT_EQ(loop2->GetHead() == G, true);
-  ASSERT_EQ(loop2->GetBackEdges() == std::set<BBlockPtr>{H}, true);
+  ASSERT_EQ(loop2->GetBackEdges() == std::vector<BBlockPtr>{H}, true);
   // loop0 -> loop2
   ASSERT_EQ(loop2->GetOuterLoop() == loop0, true);
 }
 
 TEST(LoopAnalysis, third) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
 
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
@@ -199,12 +176,200 @@ TEST(LoopAnalysis, third) {
   ASSERT_EQ(loop0->GetOuterLoop() == root, true);
   ASSERT_EQ(loop0->IsReducible(), false);
   ASSERT_EQ(loop0->GetHead() == C, true);
-  ASSERT_EQ(loop0->GetBackEdges() == std::set<BBlockPtr>{E}, true);
+  ASSERT_EQ(loop0->GetBackEdges() == std::vector<BBlockPtr>{E}, true);
 
   // root -> loop1
   ASSERT_EQ(loop1->GetOuterLoop() == root, true);
   // loop1 : head B, back edge src H, sources G
   ASSERT_EQ(loop1->GetHead() == B, true);
-  ASSERT_EQ(loop1->GetBackEdges() == std::set<BBlockPtr>{H}, true);
+  ASSERT_EQ(loop1->GetBackEdges() == std::vector<BBlockPtr>{H}, true);
   ASSERT_EQ(loopTree.GetLoopNode(G) == loop1, true);
 }
+
+// loop tree over the incrementally updated dominator tree
+TEST(LoopAnalysis, sharedDomTree) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+
+  DominatorTree domTree(graph);
+  domTree.InsertEdge(graph, C, B);
+
+  LoopTree loopTree(graph, domTree);
+  const auto loop = loopTree.GetLoopNode(B);
+  ASSERT_EQ(loop->GetHead(), B);
+  ASSERT_TRUE(loop->IsReducible());
+  ASSERT_EQ(loopTree.GetLoopNode(C), loop);
+  ASSERT_EQ(loopTree.GetLoopNode(A), loopTree.GetRoot());
+}
+
+// recursion over blocks or loops would overflow the stack here
+TEST(LoopAnalysis, deepNest) {
+  const size_t depth = 5000;
+  const size_t chain = 200000;
+  Graph graph;
+  std::vector<BBlockPtr> heads;
+  BBlockPtr prev = graph.CreateBlock("entry");
+  for (size_t i = 0; i < depth; ++i) {
+    BBlockPtr head = graph.CreateBlock("H" + std::to_string(i));
+    graph.CreateEdge(prev, head);
+    heads.push_back(head);
+    prev = head;
+  }
+  // the innermost loop is a long chain
+  for (size_t i = 0; i < chain; ++i) {
+    BBlockPtr block = graph.CreateBlock("C" + std::to_string(i));
+    graph.CreateEdge(prev, block);
+    prev = block;
+  }
+  for (size_t i = depth; i-- > 0;) {
+    BBlockPtr latch = graph.CreateBlock("L" + std::to_string(i));
+    graph.CreateEdge(prev, latch);
+    graph.CreateEdge(latch, heads[i]);
+    prev = latch;
+  }
+
+  LoopTree loopTree(graph);
+  ASSERT_EQ(loopTree.GetSize(), depth + 1);
+  auto loop = loopTree.GetLoopNode(prev);
+  ASSERT_EQ(loop->GetHead(), heads[0]);
+  ASSERT_EQ(loop->GetOuterLoop(), loopTree.GetRoot());
+  for (size_t i = 0; i < depth; ++i) {
+    ASSERT_EQ(loop->GetHead(), heads[i]);
+    ASSERT_TRUE(loop->IsReducible());
+    if (i + 1 < depth) {
+      ASSERT_EQ(loop->GetInnerLoops().size(), 1u);
+      loop = loop->GetInnerLoops()[0];
+    }
+  }
+  ASSERT_EQ(loop->GetSources().size(), chain + 1);
+  ASSERT_EQ(loopTree.GetLoopNode(graph.GetBlocks()[depth + chain]), loop);
+}
+
+// irreducible loop inside of a natural loop
+TEST(LoopAnalysis, nestedIrreducible) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, D);
+  graph.CreateEdge(D, C);
+  graph.CreateEdge(D, E);
+  graph.CreateEdge(E, B);
+  graph.CreateEdge(E, F);
+
+  LoopTree loopTree(graph);
+  const auto outer = loopTree.GetLoopNode(B);
+  const auto inner = loopTree.GetLoopNode(C);
+  ASSERT_EQ(outer->GetHead(), B);
+  ASSERT_TRUE(outer->IsReducible());
+  ASSERT_EQ(outer->GetOuterLoop(), loopTree.GetRoot());
+
+  ASSERT_EQ(inner->GetHead(), C);
+  ASSERT_FALSE(inner->IsReducible());
+  ASSERT_EQ(inner->GetBackEdges(), std::vector<BBlockPtr>{D});
+  ASSERT_EQ(inner->GetOuterLoop(), outer);
+  ASSERT_EQ(loopTree.GetLoopNode(D), inner);
+  ASSERT_EQ(loopTree.GetLoopNode(E), outer);
+  ASSERT_EQ(loopTree.GetLoopNode(F), loopTree.GetRoot());
+}
+
+// graph of the 'third' test: irreducible loop C gets its body and entries
+TEST(LoopAnalysis, havlakIrreducible) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
+
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, G);
+  graph.CreateEdge(C, D);
+  graph.CreateEdge(G, H);
+  graph.CreateEdge(G, D);
+  graph.CreateEdge(H, B);
+  graph.CreateEdge(H, I);
+  graph.CreateEdge(D, E);
+  graph.CreateEdge(I, E);
+  graph.CreateEdge(I, F);
+  graph.CreateEdge(E, C);
+  graph.CreateEdge(E, F);
+
+  LoopTree loopTree(graph, LoopTree::kHavlak);
+  const auto root = loopTree.GetRoot();
+  const auto loop0 = loopTree.GetLoopNode(C);
+  const auto loop1 = loopTree.GetLoopNode(B);
+
+  ASSERT_EQ(loop0->GetHead(), C);
+  ASSERT_FALSE(loop0->IsReducible());
+  ASSERT_EQ(loop0->GetBackEdges(), std::vector<BBlockPtr>{E});
+  ASSERT_EQ(loop0->GetOuterLoop(), root);
+  ASSERT_EQ(loopTree.GetLoopNode(D), loop0);
+  ASSERT_EQ(loopTree.GetLoopNode(E), loop0);
+  // entered from G and I
+  ASSERT_EQ(loop0->GetEntries(), (std::vector<BBlockPtr>{C, D, E}));
+
+  ASSERT_EQ(loop1->GetHead(), B);
+  ASSERT_TRUE(loop1->IsReducible());
+  ASSERT_EQ(loop1->GetOuterLoop(), root);
+  ASSERT_EQ(loop1->GetEntries(), std::vector<BBlockPtr>{B});
+  ASSERT_EQ(loopTree.GetLoopNode(G), loop1);
+  ASSERT_EQ(loopTree.GetLoopNode(H), loop1);
+
+  ASSERT_EQ(loopTree.GetLoopNode(A), root);
+  ASSERT_EQ(loopTree.GetLoopNode(F), root);
+  ASSERT_EQ(loopTree.GetLoopNode(I), root);
+}
+
+static BBlockPtr HeadOf(LoopTreeNodePtr loop) {
+  return loop ? loop->GetHead() : nullptr;
+}
+
+// both constructions agree on reducible graphs
+TEST(LoopAnalysis, havlakReducible) {
+  std::mt19937 gen(7);
+  for (size_t iter = 0; iter < 20; ++iter) {
+    // chain with back edges only: every back edge target dominates its
+    // source
+    Graph graph;
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < 200; ++i) {
+      blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+    }
+    for (size_t i = 0; i + 1 < blocks.size(); ++i) {
+      graph.CreateEdge(blocks[i], blocks[i + 1]);
+      if (gen() % 3 == 0) {
+        graph.CreateEdge(blocks[i], blocks[gen() % (i + 1)]);
+      }
+    }
+
+    LoopTree natural(graph);
+    LoopTree havlak(graph, LoopTree::kHavlak);
+    ASSERT_EQ(natural.GetSize(), havlak.GetSize());
+    for (const auto &block : blocks) {
+      auto lhs = natural.GetLoopNode(block);
+      auto rhs = havlak.GetLoopNode(block);
+      ASSERT_EQ(HeadOf(lhs), HeadOf(rhs));
+      ASSERT_EQ(HeadOf(lhs->GetOuterLoop()), HeadOf(rhs->GetOuterLoop()));
+      ASSERT_EQ(lhs->GetInnerLoops().size(), rhs->GetInnerLoops().size());
+      ASSERT_TRUE(rhs == havlak.GetRoot() || rhs->IsReducible());
+      ASSERT_TRUE(rhs == havlak.GetRoot() ||
+                  rhs->GetEntries() == std::vector<BBlockPtr>{HeadOf(rhs)});
+    }
+  }
+}
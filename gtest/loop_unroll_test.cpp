@@ -0,0 +1,258 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+#include <passes/LoopUnroll.h>
+
+#include <string>
+
+TEST(LoopUnroll, full) {
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 10\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ B2 B ]\n"
+                "  B1 = phi [ A0 A ] [ B3 B ]\n"
+                "  B3 = mul B1 3\n"
+                "  B2 = add B0 1\n"
+                "  jne B2 4 B\n"
+                "%C:\n"
+                "  ret B3\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  ASSERT_EQ(Interpreter(graph).Run(), 810u);
+
+  AnalysisManager am(graph);
+  LoopUnroll unroll;
+  ASSERT_FALSE(unroll.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 10\n"
+                         "%B.1:\n"
+                         "  B3.1 = mul A0 3\n"
+                         "  B2.1 = add 0 1\n"
+                         "  jmp B.2\n"
+                         "%B.2:\n"
+                         "  B3.2 = mul B3.1 3\n"
+                         "  B2.2 = add B2.1 1\n"
+                         "  jmp B.3\n"
+                         "%B.3:\n"
+                         "  B3.3 = mul B3.2 3\n"
+                         "  B2.3 = add B2.2 1\n"
+                         "  jmp B\n"
+                         "%B:\n"
+                         "  B3 = mul B3.3 3\n"
+                         "  B2 = add B2.3 1\n"
+                         "  jmp C\n"
+                         "%C:\n"
+                         "  ret B3\n");
+  ASSERT_EQ(unroll.GetStats().numFullyUnrolled, 1u);
+  ASSERT_EQ(unroll.GetStats().numClonedInsts, 9u);
+  ASSERT_EQ(Interpreter(graph).Run(), 810u);
+  ExpectRoundTrip(graph, 810u);
+
+  // no loops left
+  AnalysisManager newAm(graph);
+  ASSERT_TRUE(unroll.Run(graph, newAm).AreAllPreserved());
+}
+
+TEST(LoopUnroll, partial) {
+  // 10 iterations don't fit in the budget, the remainder 2 is peeled and
+  // the loop runs twice over 4 copies
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 1\n"
+                "  jmp B\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ C1 C ]\n"
+                "  B1 = phi [ A0 A ] [ C0 C ]\n"
+                "  B2 = mul B1 2\n"
+                "%C:\n"
+                "  C0 = add B2 B0\n"
+                "  C1 = add B0 1\n"
+                "  jne C1 10 B\n"
+                "%D:\n"
+                "  ret C0\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  uint64_t executed = 0;
+  uint64_t expected = Interpreter(graph).Run(executed);
+
+  AnalysisManager am(graph);
+  LoopUnroll unroll(25, 4);
+  ASSERT_FALSE(unroll.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  A0 = assign 1\n"
+                         "  jmp B.1\n"
+                         "%B.1:\n"
+                         "  B2.1 = mul A0 2\n"
+                         "%C.1:\n"
+                         "  C0.1 = add B2.1 0\n"
+                         "  C1.1 = add 0 1\n"
+                         "  jmp B.2\n"
+                         "%B.2:\n"
+                         "  B2.2 = mul C0.1 2\n"
+                         "%C.2:\n"
+                         "  C0.2 = add B2.2 C1.1\n"
+                         "  C1.2 = add C1.1 1\n"
+                         "  jmp B\n"
+                         "%B:\n"
+                         "  B0 = phi [ C1.2 C.2 ] [ C1.5 C.5 ]\n"
+                         "  B1 = phi [ C0.2 C.2 ] [ C0.5 C.5 ]\n"
+                         "  B2 = mul B1 2\n"
+                         "%C:\n"
+                         "  C0 = add B2 B0\n"
+                         "  C1 = add B0 1\n"
+                         "  jmp B.3\n"
+                         "%B.3:\n"
+                         "  B2.3 = mul C0 2\n"
+                         "%C.3:\n"
+                         "  C0.3 = add B2.3 C1\n"
+                         "  C1.3 = add C1 1\n"
+                         "  jmp B.4\n"
+                         "%B.4:\n"
+                         "  B2.4 = mul C0.3 2\n"
+                         "%C.4:\n"
+                         "  C0.4 = add B2.4 C1.3\n"
+                         "  C1.4 = add C1.3 1\n"
+                         "  jmp B.5\n"
+                         "%B.5:\n"
+                         "  B2.5 = mul C0.4 2\n"
+                         "%C.5:\n"
+                         "  C0.5 = add B2.5 C1.4\n"
+                         "  C1.5 = add C1.4 1\n"
+                         "  jne C1.5 10 B\n"
+                         "%D:\n"
+                         "  ret C0.5\n");
+  ASSERT_EQ(unroll.GetStats().numPartiallyUnrolled, 1u);
+  ASSERT_EQ(unroll.GetStats().numPeeledIterations, 2u);
+  ASSERT_EQ(unroll.GetStats().numClonedInsts, 20u);
+
+  uint64_t unrolledExecuted = 0;
+  ASSERT_EQ(Interpreter(graph).Run(unrolledExecuted), expected);
+  ASSERT_LT(unrolledExecuted, executed);
+  ExpectRoundTrip(graph, expected);
+}
+
+TEST(LoopUnroll, diamondAtHead) {
+  // E merges the values from the head and from C, the phi inputs from the
+  // head of a copy name the copy of the head
+  for (uint64_t tripCount : {6, 7}) {
+    std::string text = "%A:\n"
+                       "  A0 = assign 1\n"
+                       "%B:\n"
+                       "  B0 = phi [ 0 A ] [ E1 E ]\n"
+                       "  B1 = phi [ A0 A ] [ E0 E ]\n"
+                       "  B2 = cmp B0 3\n"
+                       "  jeq B2 0 E\n"
+                       "%C:\n"
+                       "  C0 = mul B1 3\n"
+                       "%E:\n"
+                       "  E0 = phi [ B1 B ] [ C0 C ]\n"
+                       "  E1 = add B0 1\n"
+                       "  jne E1 " +
+                       std::to_string(tripCount) +
+                       " B\n"
+                       "%F:\n"
+                       "  ret E0\n";
+    Graph graph;
+    Parser parser(text);
+    ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+    uint64_t expected = Interpreter(graph).Run();
+
+    // 6 iterations are fully unrolled, 7 are peeled once and unrolled by 3
+    AnalysisManager am(graph);
+    LoopUnroll unroll(30, 3);
+    ASSERT_FALSE(unroll.Run(graph, am).AreAllPreserved());
+    ASSERT_EQ(unroll.GetStats().numFullyUnrolled, tripCount == 6 ? 1u : 0u);
+    ASSERT_EQ(unroll.GetStats().numPartiallyUnrolled,
+              tripCount == 6 ? 0u : 1u);
+    ASSERT_EQ(Dump(graph).find(" B ] [ C0."), std::string::npos)
+        << Dump(graph);
+    ASSERT_EQ(Interpreter(graph).Run(), expected) << Dump(graph);
+    ExpectRoundTrip(graph, expected);
+  }
+}
+
+TEST(LoopUnroll, unknownTripCount) {
+  // the bound is not an immediate
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 4\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ B1 B ]\n"
+                "  B1 = add B0 1\n"
+                "  jne B1 A0 B\n"
+                "%C:\n"
+                "  ret B1\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  AnalysisManager am(graph);
+  LoopUnroll unroll;
+  ASSERT_TRUE(unroll.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(unroll.GetStats().numClonedInsts, 0u);
+}
+
+TEST(LoopUnroll, longTripCount) {
+  // the trip count is past the bound of the search derived from the
+  // budget, the loop is left alone
+  Graph graph;
+  Parser parser("%A:\n"
+                "  A0 = assign 4\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ B1 B ]\n"
+                "  B1 = add B0 1\n"
+                "  jne B1 1000000 B\n"
+                "%C:\n"
+                "  ret B1\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  AnalysisManager am(graph);
+  LoopUnroll unroll;
+  ASSERT_TRUE(unroll.Run(graph, am).AreAllPreserved());
+  ASSERT_EQ(unroll.GetStats().numClonedInsts, 0u);
+}
+
+TEST(LoopUnroll, budgets) {
+  // every trip count, factor and budget computes the same value, the
+  // budget is never exceeded
+  uint64_t numFullyUnrolled = 0;
+  uint64_t numPartiallyUnrolled = 0;
+  for (uint64_t tripCount = 1; tripCount <= 12; ++tripCount) {
+    std::string text = "%A:\n"
+                       "  A0 = assign 7\n"
+                       "  jeq A0 0 D\n"
+                       "%B:\n"
+                       "  B0 = phi [ 0 A ] [ C1 C ]\n"
+                       "  B1 = phi [ A0 A ] [ C0 C ]\n"
+                       "  B2 = cmp B0 3\n"
+                       "%C:\n"
+                       "  C0 = add B1 B2\n"
+                       "  C3 = mul C0 B0\n"
+                       "  C1 = add B0 1\n"
+                       "  C2 = cmp C1 " +
+                       std::to_string(tripCount) +
+                       "\n"
+                       "  jeq C2 1 B\n"
+                       "%D:\n"
+                       "  D0 = phi [ 0 A ] [ C3 C ]\n"
+                       "  ret D0\n";
+    for (uint32_t factor = 2; factor <= 5; ++factor) {
+      for (uint32_t budget : {0, 6, 12, 30, 100}) {
+        Graph graph;
+        Parser parser(text);
+        ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+        uint64_t expected = Interpreter(graph).Run();
+
+        AnalysisManager am(graph);
+        LoopUnroll unroll(budget, factor);
+        unroll.Run(graph, am);
+        ASSERT_LE(unroll.GetStats().numClonedInsts, budget);
+        ASSERT_EQ(Interpreter(graph).Run(), expected)
+            << tripCount << " " << factor << " " << budget << "\n"
+            << Dump(graph);
+        ExpectRoundTrip(graph, expected);
+        numFullyUnrolled += unroll.GetStats().numFullyUnrolled;
+        numPartiallyUnrolled += unroll.GetStats().numPartiallyUnrolled;
+      }
+    }
+  }
+  ASSERT_GT(numFullyUnrolled, 0u);
+  ASSERT_GT(numPartiallyUnrolled, 0u);
+}
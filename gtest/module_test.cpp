@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/Module.h>
+#include <passes/DominatorTree.h>
+#include <passes/LoopAnalysis.h>
+#include <support/ThreadPool.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(ThreadPool, parallelFor) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> hits(10000);
+  pool.ParallelFor(hits.size(), [&hits](size_t i) { ++hits[i]; });
+  for (const auto &hit : hits) {
+    ASSERT_EQ(hit.load(), 1);
+  }
+
+  // the pool is reusable after Wait
+  std::atomic<size_t> sum{0};
+  for (size_t i = 0; i < 100; ++i) {
+    pool.Submit([&sum, i] { sum += i; });
+  }
+  pool.Wait();
+  ASSERT_EQ(sum.load(), 4950u);
+}
+
+TEST(ThreadPool, steal) {
+  ThreadPool pool(2);
+  // long tasks go to both queues, the worker done first steals
+  std::atomic<size_t> done{0};
+  for (size_t i = 0; i < 64; ++i) {
+    pool.Submit([&done, i] {
+      if (i % 2 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      ++done;
+    });
+  }
+  pool.Wait();
+  ASSERT_EQ(done.load(), 64u);
+  ASSERT_GT(pool.GetNumSteals(), 0u);
+}
+
+static void CreateRandomFunction(Graph &graph, size_t size, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::vector<BBlockPtr> blocks;
+  for (size_t i = 0; i < size; ++i) {
+    blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+  }
+  for (size_t i = 0; i + 1 < size; ++i) {
+    graph.CreateEdge(blocks[i], blocks[i + 1]);
+    graph.CreateEdge(blocks[i], blocks[gen() % size]);
+  }
+}
+
+TEST(Module, parallelAnalysis) {
+  Module module;
+  for (size_t i = 0; i < 64; ++i) {
+    CreateRandomFunction(module.CreateFunction("f" + std::to_string(i)), 300,
+                         i);
+  }
+  ASSERT_EQ(module.GetSize(), 64u);
+  ASSERT_EQ(module.FindFunction("f7"), &module.GetFunction(7));
+  ASSERT_EQ(module.FindFunction("g"), nullptr);
+
+  // immediate dominators and loop counts computed in parallel match the
+  // sequential results
+  std::vector<std::vector<BBlockPtr>> idoms(module.GetSize());
+  std::vector<size_t> numLoops(module.GetSize());
+  ThreadPool pool(8);
+  pool.ParallelFor(module.GetSize(), [&](size_t i) {
+    const Graph &graph = module.GetFunction(i);
+    DominatorTree domTree(graph);
+    for (const auto &block : graph.GetBlocks()) {
+      idoms[i].push_back(domTree.GetIDom(block));
+    }
+    numLoops[i] = LoopTree(graph, domTree).GetSize();
+  });
+
+  for (size_t i = 0; i < module.GetSize(); ++i) {
+    const Graph &graph = module.GetFunction(i);
+    DominatorTree domTree(graph);
+    for (const auto &block : graph.GetBlocks()) {
+      ASSERT_EQ(idoms[i][block->GetId()], domTree.GetIDom(block));
+    }
+    ASSERT_EQ(numLoops[i], LoopTree(graph, domTree).GetSize());
+  }
+}
@@ -0,0 +1,25 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/Opcode.h>
+
+// traits are usable in constant expressions
+static_assert(IsCommutative(OP_add) && !IsCommutative(OP_cmp));
+static_assert(GetNumOperands(OP_jeq) == 3);
+static_assert(IsTerminator(OP_ret) && !IsBranch(OP_ret));
+
+TEST(Opcode, traits) {
+  ASSERT_STREQ(ToString(OP_add), "add");
+  ASSERT_STREQ(ToString(OP_phi), "phi");
+  ASSERT_STREQ(ToString(OP_undef), "undef");
+
+  for (int op = 0; op < OP_undef; ++op) {
+    Opcode opcode = static_cast<Opcode>(op);
+    // terminators never define values
+    ASSERT_FALSE(IsTerminator(opcode) && HasResult(opcode));
+    // commutative operations are binary
+    ASSERT_TRUE(!IsCommutative(opcode) || GetNumOperands(opcode) == 2);
+  }
+  ASSERT_TRUE(IsBranch(OP_jmp));
+  ASSERT_TRUE(HasResult(OP_phi));
+  ASSERT_FALSE(HasResult(OP_label));
+}
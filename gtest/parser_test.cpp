@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <passes/LoopAnalysis.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char *kLoop = "%A:\n"
+                           "  A0 = assign 1\n"
+                           "  jmp B\n"
+                           "%B:\n"
+                           "  B0 = phi [ A0 A ] [ C0 C ]\n"
+                           "  B1 = cmp B0 10\n"
+                           "  jeq B1 0 D\n"
+                           "%C:\n"
+                           "  C0 = add B0 A0\n"
+                           "  jmp B\n"
+                           "%D:\n"
+                           "  ret B0\n";
+
+TEST(Parser, roundTrip) {
+  Graph graph;
+  Parser parser(kLoop);
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  ASSERT_EQ(Dump(graph), kLoop);
+
+  // edges from terminators, 'jeq' falls through first
+  const auto &blocks = graph.GetBlocks();
+  ASSERT_EQ(blocks[0]->GetSuccessors(), std::vector<BBlockPtr>{blocks[1]});
+  ASSERT_EQ(blocks[1]->GetSuccessors(),
+            (std::vector<BBlockPtr>{blocks[2], blocks[3]}));
+  ASSERT_EQ(blocks[2]->GetSuccessors(), std::vector<BBlockPtr>{blocks[1]});
+  ASSERT_TRUE(blocks[3]->GetSuccessors().empty());
+  ASSERT_EQ(LoopTree(graph).GetSize(), 2u);
+
+  // unnamed instructions are named like IRBuilder does
+  ASSERT_EQ(blocks[0]->GetInstList().Back()->GetName(), "A1");
+  // the forward reference of the phi is a use
+  Inst *add = blocks[2]->GetInstList().Front();
+  ASSERT_EQ(add->GetNumUses(), 1u);
+  ASSERT_TRUE((*add->GetUsers().begin())->IsPhi());
+}
+
+TEST(Parser, fallthrough) {
+  // blocks without terminators fall through, 'ret' ends the function
+  Graph graph;
+  Parser parser("%A:\n"
+                "%B:\n"
+                "  B0 = assign 0\n"
+                "  jne B0 1 A\n"
+                "%C:\n"
+                "  ret 0\n"
+                "%D:\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  const auto &blocks = graph.GetBlocks();
+  ASSERT_EQ(blocks[0]->GetSuccessors(), std::vector<BBlockPtr>{blocks[1]});
+  ASSERT_EQ(blocks[1]->GetSuccessors(),
+            (std::vector<BBlockPtr>{blocks[2], blocks[0]}));
+  ASSERT_TRUE(blocks[2]->GetSuccessors().empty());
+  ASSERT_TRUE(blocks[3]->GetPredessors().empty());
+}
+
+TEST(Parser, module) {
+  // random functions built with IRBuilder print and parse back
+  Module module;
+  std::mt19937 gen(7);
+  for (size_t f = 0; f < 8; ++f) {
+    Graph &graph = module.CreateFunction("f" + std::to_string(f));
+    std::vector<BBlockPtr> blocks;
+    for (size_t i = 0; i < 50; ++i) {
+      blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+    }
+    IRBuilder builder(blocks[0]);
+    std::vector<Operand *> values{builder.CreateAssign(builder.CreateImm(f))};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      builder.SetBBlock(blocks[i]);
+      for (size_t j = 0; j < 4; ++j) {
+        Operand *src = values[gen() % values.size()];
+        values.push_back(gen() % 2 ? builder.CreateAdd(src, values.back())
+                                   : builder.CreateMul(src, builder.CreateImm(
+                                                                gen())));
+      }
+      if (i + 1 == blocks.size()) {
+        builder.CreateRet(values.back());
+      } else {
+        builder.CreateJeq(values.back(), builder.CreateImm(0),
+                          builder.CreateLabel(blocks[gen() % blocks.size()]));
+      }
+    }
+  }
+
+  std::stringstream ss;
+  module.Dump(ss);
+  std::string text = ss.str();
+  Parser parser(text);
+  auto parsed = parser.ParseModule();
+  ASSERT_NE(parsed, nullptr) << parser.GetError();
+  ASSERT_EQ(parsed->GetSize(), module.GetSize());
+  std::stringstream parsedText;
+  parsed->Dump(parsedText);
+  ASSERT_EQ(parsedText.str(), text);
+  ASSERT_EQ(parsed->GetName(3), "f3");
+}
+
+TEST(Parser, errors) {
+  auto parse = [](const char *text) {
+    Graph graph;
+    Parser parser(text);
+    EXPECT_FALSE(parser.ParseGraph(graph));
+    return parser.GetError();
+  };
+  ASSERT_EQ(parse("  ret 0\n"), "line 1: instruction outside of a block");
+  ASSERT_EQ(parse("%A:\n  A0 = foo 1\n"), "line 2: unknown opcode 'foo'");
+  ASSERT_EQ(parse("%A:\n  ret X\n"), "line 2: unknown value 'X'");
+  ASSERT_EQ(parse("%A:\n  jmp X\n"), "line 2: unknown block 'X'");
+  ASSERT_EQ(parse("%A:\n%A:\n"), "line 2: block 'A' redefinition");
+  ASSERT_EQ(parse("%A:\n  X = assign 1\n  X = assign 2\n"),
+            "line 3: value 'X' redefinition");
+  ASSERT_EQ(parse("%A:\n  A0 = assign 1x\n"),
+            "line 2: invalid immediate '1x'");
+  ASSERT_EQ(parse("%A:\n  A0 = add 1\n"), "line 2: expected operand");
+  ASSERT_EQ(parse("%A:\n  ret 1 2\n"), "line 2: too many operands");
+  ASSERT_EQ(parse("%A:\n  assign 1\n"), "line 2: result name expected");
+  ASSERT_EQ(parse("%A:\n  A0 = assign 1\n  A1 = phi [ A0 A ] [ A0 A ]\n"),
+            "line 3: phi after a non-phi instruction");
+  ASSERT_EQ(parse("%A:\n  A0 = phi A0 A ] [ A0 A ]\n"),
+            "line 2: expected '['");
+  ASSERT_EQ(parse("@f:\n"), "line 1: function header in a graph");
+
+  Parser parser("%A:\n");
+  ASSERT_EQ(parser.ParseModule(), nullptr);
+  ASSERT_EQ(parser.GetError(), "line 1: expected '@function:'");
+}
@@ -0,0 +1,209 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/Parser.h>
+#include <passes/DCE.h>
+#include <passes/LICM.h>
+#include <passes/LoopUnroll.h>
+#include <passes/PassManager.h>
+#include <passes/SCCP.h>
+
+#include <sstream>
+
+// A: a0 = 1, jmp B
+// B: i = phi [a0 A] [i1 C], cmp i 10, jeq D
+// C: i1 = add i a0, jmp B
+// D: ret i
+static void CreateLoop(Graph &graph) {
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  graph.CreateEdge(A, B);
+  graph.CreateEdge(B, C);
+  graph.CreateEdge(B, D);
+  graph.CreateEdge(C, B);
+
+  IRBuilder builder(A);
+  auto a0 = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(B));
+
+  builder.SetBBlock(B);
+  auto i = builder.CreatePhi(a0, builder.CreateLabel(A), a0,
+                             builder.CreateLabel(C));
+  auto less = builder.CreateCmp(i, builder.CreateImm(10));
+  builder.CreateJeq(less, builder.CreateImm(0), builder.CreateLabel(D));
+
+  builder.SetBBlock(C);
+  auto i1 = builder.CreateAdd(i, a0);
+  builder.CreateJmp(builder.CreateLabel(B));
+  static_cast<InstOperand *>(i)->GetInst()->SetOperand(2, i1);
+
+  builder.SetBBlock(D);
+  builder.CreateRet(i);
+}
+
+namespace {
+// requests the analyses and reports a fixed set of preserved ones
+class MockPass : public FunctionPass {
+public:
+  MockPass(const char *name, PreservedAnalyses preserved)
+      : name(name), preserved(std::move(preserved)) {}
+
+  const char *GetName() const override { return name; }
+  PreservedAnalyses Run(Graph & /*graph*/, AnalysisManager &am) override {
+    am.Get<Liveness>();
+    am.Get<DominanceFrontier>();
+    return preserved;
+  }
+
+private:
+  const char *name;
+  PreservedAnalyses preserved;
+};
+} // namespace
+
+TEST(AnalysisManager, cache) {
+  Graph graph;
+  CreateLoop(graph);
+  AnalysisManager am(graph);
+  ASSERT_EQ(am.GetCached<LoopTree>(), nullptr);
+
+  LoopTree &loopTree = am.Get<LoopTree>();
+  ASSERT_EQ(&am.Get<LoopTree>(), &loopTree);
+  ASSERT_EQ(am.GetCached<LoopTree>(), &loopTree);
+  // the loop tree reused the dominator tree computed for it
+  ASSERT_NE(am.GetCached<DominatorTree>(), nullptr);
+  am.Get<DominanceFrontier>();
+  am.Get<Liveness>();
+
+  auto domStats = am.GetStats<DominatorTree>();
+  ASSERT_EQ(domStats.numComputations, 1u);
+  ASSERT_EQ(domStats.numHits, 1u);
+  auto loopStats = am.GetStats<LoopTree>();
+  ASSERT_EQ(loopStats.numComputations, 1u);
+  ASSERT_EQ(loopStats.numHits, 2u);
+  ASSERT_STREQ(loopStats.name, "LoopTree");
+
+  am.Clear();
+  ASSERT_EQ(am.GetCached<DominatorTree>(), nullptr);
+  ASSERT_EQ(am.GetCached<Liveness>(), nullptr);
+  ASSERT_EQ(am.GetStats<Liveness>().numInvalidations, 1u);
+}
+
+TEST(AnalysisManager, invalidate) {
+  Graph graph;
+  CreateLoop(graph);
+  AnalysisManager am(graph);
+  am.Get<Liveness>();
+  am.Get<DominanceFrontier>();
+
+  // nothing changed
+  am.Invalidate(PreservedAnalyses::All());
+  ASSERT_NE(am.GetCached<Liveness>(), nullptr);
+
+  // instructions changed: CFG analyses survive
+  am.Invalidate(PreservedAnalyses::CFG());
+  ASSERT_EQ(am.GetCached<Liveness>(), nullptr);
+  ASSERT_NE(am.GetCached<LoopTree>(), nullptr);
+  ASSERT_NE(am.GetCached<DominatorTree>(), nullptr);
+  ASSERT_NE(am.GetCached<DominanceFrontier>(), nullptr);
+
+  // the CFG changed but liveness was kept up to date
+  am.Get<Liveness>();
+  am.Invalidate(PreservedAnalyses::None().Preserve<Liveness>());
+  ASSERT_EQ(am.GetCached<DominatorTree>(), nullptr);
+  ASSERT_EQ(am.GetCached<DominanceFrontier>(), nullptr);
+  // built on the dropped loop tree
+  ASSERT_EQ(am.GetCached<LoopTree>(), nullptr);
+  ASSERT_EQ(am.GetCached<Liveness>(), nullptr);
+
+  // a preserved loop tree still goes with its dominator tree
+  am.Get<LoopTree>();
+  am.Get<DominanceFrontier>();
+  am.Invalidate(PreservedAnalyses::None().Preserve<LoopTree>());
+  ASSERT_EQ(am.GetCached<LoopTree>(), nullptr);
+
+  am.Get<LoopTree>();
+  am.Invalidate(PreservedAnalyses::None()
+                    .Preserve<DominatorTree>()
+                    .Preserve<LoopTree>());
+  ASSERT_NE(am.GetCached<LoopTree>(), nullptr);
+  ASSERT_EQ(am.GetStats<DominatorTree>().numComputations, 3u);
+}
+
+TEST(PassManager, run) {
+  Graph graph;
+  CreateLoop(graph);
+  AnalysisManager am(graph);
+
+  PassManager pm;
+  pm.AddPass<MockPass>("nop", PreservedAnalyses::All());
+  pm.AddPass<MockPass>("insts", PreservedAnalyses::CFG());
+  pm.AddPass<MockPass>("cfg", PreservedAnalyses::None());
+  pm.Run(graph, am);
+  pm.Run(graph, am);
+
+  // computed by "nop", then by "insts" and "cfg" in every run
+  ASSERT_EQ(am.GetStats<DominatorTree>().numComputations, 2u);
+  ASSERT_EQ(am.GetStats<Liveness>().numComputations, 4u);
+  ASSERT_EQ(am.GetStats<DominanceFrontier>().numComputations, 2u);
+  ASSERT_EQ(am.GetStats<DominanceFrontier>().numHits, 4u);
+
+  const auto &stats = pm.GetStats();
+  ASSERT_EQ(stats.size(), 3u);
+  ASSERT_STREQ(stats[1].name, "insts");
+  for (const auto &passStats : stats) {
+    ASSERT_EQ(passStats.numRuns, 2u);
+    ASSERT_GE(passStats.seconds, 0.0);
+  }
+  ASSERT_EQ(stats[0].numChanges, 0u);
+  ASSERT_EQ(stats[2].numChanges, 2u);
+
+  std::stringstream ss;
+  pm.DumpStats(ss);
+  am.DumpStats(ss);
+  ASSERT_NE(ss.str().find("insts"), std::string::npos);
+  ASSERT_NE(ss.str().find("DominanceFrontier"), std::string::npos);
+}
+
+TEST(PassManager, unchangedLiveness) {
+  // nothing to do for the passes, they renumber the instructions through
+  // Inst::SetIndex and the cached liveness still answers the same
+  Graph graph;
+  Parser parser("%A:\n"
+                "  jmp B\n"
+                "%B:\n"
+                "  B0 = phi [ 0 A ] [ C0 C ]\n"
+                "  B1 = cmp B0 10\n"
+                "  jeq B1 0 D\n"
+                "%C:\n"
+                "  C0 = add B0 1\n"
+                "  jmp B\n"
+                "%D:\n"
+                "  ret B0\n");
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+  const auto &blocks = graph.GetBlocks();
+  Inst *b0 = blocks[1]->GetInstList().Front();
+  Inst *c0 = blocks[2]->GetInstList().Front();
+
+  AnalysisManager am(graph);
+  Liveness &liveness = am.Get<Liveness>();
+  ASSERT_TRUE(liveness.IsLiveOut(blocks[1], b0));
+  ASSERT_TRUE(liveness.IsLiveOut(blocks[2], c0));
+
+  PassManager pm;
+  pm.AddPass<SCCP>();
+  pm.AddPass<LICM>();
+  pm.AddPass<LoopUnroll>();
+  pm.AddPass<DCE>();
+  pm.Run(graph, am);
+  for (const auto &passStats : pm.GetStats()) {
+    ASSERT_EQ(passStats.numChanges, 0u) << passStats.name;
+  }
+
+  ASSERT_EQ(am.GetCached<Liveness>(), &liveness);
+  ASSERT_TRUE(liveness.IsLiveOut(blocks[1], b0));
+  ASSERT_TRUE(liveness.IsLiveIn(blocks[3], b0));
+  ASSERT_TRUE(liveness.IsLiveOut(blocks[2], c0));
+  ASSERT_FALSE(liveness.IsLiveOut(blocks[1], c0));
+}
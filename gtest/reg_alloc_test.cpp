@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include <passes/RegAlloc.h>
+
+#include <sstream>
+#include <vector>
+
+// A: defines c0..c3 used after the loop
+// B: loop header, i = phi [0 A] [i1 C]
+// C: i1 = i + 1, t = i1 * i1, jmp B
+// D: returns the sum of c0..c3
+struct LoopFunction {
+  LoopFunction() {
+    A = graph.CreateBlock("A");
+    B = graph.CreateBlock("B");
+    C = graph.CreateBlock("C");
+    D = graph.CreateBlock("D");
+    graph.CreateEdge(A, B);
+    graph.CreateEdge(B, C);
+    graph.CreateEdge(B, D);
+    graph.CreateEdge(C, B);
+
+    IRBuilder builder(A);
+    for (uint64_t k = 0; k < 4; ++k) {
+      consts.push_back(builder.CreateAssign(builder.CreateImm(k)));
+    }
+    auto zero = builder.CreateImm(0);
+    builder.CreateJmp(builder.CreateLabel(B));
+
+    builder.SetBBlock(B);
+    i = builder.CreatePhi(zero, builder.CreateLabel(A), zero,
+                          builder.CreateLabel(C));
+    auto less = builder.CreateCmp(i, builder.CreateImm(100));
+    builder.CreateJeq(less, zero, builder.CreateLabel(D));
+
+    builder.SetBBlock(C);
+    i1 = builder.CreateAdd(i, builder.CreateImm(1));
+    t = builder.CreateMul(i1, i1);
+    builder.CreateJmp(builder.CreateLabel(B));
+    GetInst(i)->SetOperand(2, i1);
+
+    builder.SetBBlock(D);
+    auto sum = builder.CreateAdd(consts[0], consts[1]);
+    sum = builder.CreateAdd(sum, consts[2]);
+    sum = builder.CreateAdd(sum, consts[3]);
+    builder.CreateRet(sum);
+  }
+
+  Graph graph;
+  BBlockPtr A, B, C, D;
+  std::vector<Operand *> consts;
+  Operand *i, *i1, *t;
+};
+
+static bool Overlap(const RegAlloc::Interval &lhs,
+                    const RegAlloc::Interval &rhs) {
+  return lhs.start < rhs.end && rhs.start < lhs.end;
+}
+
+// values with overlapping intervals never share a register
+static void CheckAssignment(const RegAlloc &regAlloc) {
+  const auto &intervals = regAlloc.GetIntervals();
+  for (size_t a = 0; a < intervals.size(); ++a) {
+    for (size_t b = a + 1; b < intervals.size(); ++b) {
+      if (intervals[a].reg != RegAlloc::kSpilled &&
+          intervals[a].reg == intervals[b].reg) {
+        ASSERT_FALSE(Overlap(intervals[a], intervals[b]))
+            << intervals[a].value->GetName() << " "
+            << intervals[b].value->GetName();
+      }
+      ASSERT_LT(intervals[a].reg == RegAlloc::kSpilled
+                    ? 0
+                    : intervals[a].reg,
+                regAlloc.GetNumRegisters());
+    }
+  }
+}
+
+TEST(RegAlloc, enoughRegisters) {
+  LoopFunction func;
+  LoopTree loopTree(func.graph);
+  Liveness liveness(func.graph, loopTree);
+  RegAlloc regAlloc(func.graph, loopTree, liveness, 16);
+
+  CheckAssignment(regAlloc);
+  ASSERT_EQ(regAlloc.GetStats().numSpilled, 0u);
+  ASSERT_EQ(regAlloc.GetStats().numReloads, 0u);
+
+  // loop blocks are contiguous
+  const auto &order = regAlloc.GetLinearOrder();
+  auto posB = std::find(order.begin(), order.end(), func.B) - order.begin();
+  auto posC = std::find(order.begin(), order.end(), func.C) - order.begin();
+  ASSERT_EQ(std::abs(posB - posC), 1);
+
+  // constants live through the loop
+  const auto &c0 = regAlloc.GetInterval(GetInst(func.consts[0]));
+  const auto &i1 = regAlloc.GetInterval(GetInst(func.i1));
+  ASSERT_TRUE(Overlap(c0, i1));
+}
+
+TEST(RegAlloc, spillOutsideOfLoop) {
+  LoopFunction func;
+  LoopTree loopTree(func.graph);
+  Liveness liveness(func.graph, loopTree);
+  RegAlloc regAlloc(func.graph, loopTree, liveness, 3);
+
+  CheckAssignment(regAlloc);
+  const auto &stats = regAlloc.GetStats();
+  ASSERT_GT(stats.numSpilled, 0u);
+  ASSERT_EQ(stats.numSpillStores, stats.numSpilled);
+  ASSERT_GE(stats.numReloads, stats.numSpilled);
+
+  // values used in the loop are heavier than constants used once after it
+  ASSERT_FALSE(regAlloc.IsSpilled(GetInst(func.i)));
+  ASSERT_FALSE(regAlloc.IsSpilled(GetInst(func.i1)));
+  size_t spilledConsts = 0;
+  for (auto c : func.consts) {
+    spilledConsts += regAlloc.IsSpilled(GetInst(c));
+  }
+  ASSERT_EQ(spilledConsts, stats.numSpilled);
+
+  std::ostringstream os;
+  regAlloc.DumpReport(os);
+  ASSERT_NE(os.str().find("spilled: "), std::string::npos);
+}
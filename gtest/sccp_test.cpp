@@ -0,0 +1,212 @@
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+#include <passes/SCCP.h>
+
+#include <random>
+#include <vector>
+
+static void Parse(Graph &graph, const char *text) {
+  Parser parser(text);
+  ASSERT_TRUE(parser.ParseGraph(graph)) << parser.GetError();
+}
+
+TEST(SCCP, fold) {
+  Graph graph;
+  Parse(graph, "%A:\n"
+               "  A0 = add 2 3\n"
+               "  A1 = mul A0 4\n"
+               "  A2 = cmp A1 21\n"
+               "  A3 = add A2 A1\n"
+               "  ret A3\n");
+  AnalysisManager am(graph);
+  am.Get<DominatorTree>();
+
+  SCCP sccp;
+  PreservedAnalyses preserved = sccp.Run(graph, am);
+  am.Invalidate(preserved);
+  ASSERT_EQ(Dump(graph), "%A:\n  ret 21\n");
+  ASSERT_EQ(sccp.GetStats().numFoldedInsts, 4u);
+  // blocks and edges are the same
+  ASSERT_NE(am.GetCached<DominatorTree>(), nullptr);
+
+  // nothing left to fold
+  ASSERT_TRUE(sccp.Run(graph, am).AreAllPreserved());
+}
+
+TEST(SCCP, branch) {
+  // C is never executed, the phi only sees B
+  Graph graph;
+  Parse(graph, "%A:\n"
+               "  A0 = assign 0\n"
+               "  jeq A0 1 C\n"
+               "%B:\n"
+               "  B0 = add A0 5\n"
+               "  jmp D\n"
+               "%C:\n"
+               "  C0 = mul A0 7\n"
+               "  jmp D\n"
+               "%D:\n"
+               "  D0 = phi [ B0 B ] [ C0 C ]\n"
+               "  ret D0\n");
+  AnalysisManager am(graph);
+  am.Get<DominatorTree>();
+
+  SCCP sccp;
+  am.Invalidate(sccp.Run(graph, am));
+  ASSERT_EQ(Dump(graph), "%A:\n  jmp B\n%B:\n  jmp D\n%D:\n  ret 5\n");
+  ASSERT_EQ(am.GetCached<DominatorTree>(), nullptr);
+
+  // ids are dense again
+  const auto &blocks = graph.GetBlocks();
+  ASSERT_EQ(blocks.size(), 3u);
+  ASSERT_EQ(blocks[2]->GetId(), 2u);
+  ASSERT_EQ(blocks[2]->GetPredessors(), std::vector<BBlockPtr>{blocks[1]});
+  ASSERT_EQ(blocks[0]->GetSuccessors(), std::vector<BBlockPtr>{blocks[1]});
+
+  auto &stats = sccp.GetStats();
+  ASSERT_EQ(stats.numFoldedBranches, 1u);
+  ASSERT_EQ(stats.numErasedBlocks, 1u);
+  ASSERT_EQ(stats.numErasedInsts, 2u);
+  ASSERT_EQ(Interpreter(graph).Run(), 5u);
+}
+
+TEST(SCCP, loop) {
+  // B1 stays 1 around the loop, B0 does not
+  const char *text = "%A:\n"
+                     "  jmp B\n"
+                     "%B:\n"
+                     "  B0 = phi [ 0 A ] [ C0 F ]\n"
+                     "  B1 = phi [ 1 A ] [ C1 F ]\n"
+                     "  B2 = cmp B0 10\n"
+                     "  jeq B2 0 E\n"
+                     "%C:\n"
+                     "  C0 = add B0 B1\n"
+                     "  C1 = mul B1 1\n"
+                     "  jne C1 1 D\n"
+                     "%F:\n"
+                     "  jmp B\n"
+                     "%D:\n"
+                     "  ret 99\n"
+                     "%E:\n"
+                     "  ret B0\n";
+  Graph graph;
+  Parse(graph, text);
+
+  AnalysisManager am(graph);
+  PassManager pm;
+  pm.AddPass<SCCP>();
+  pm.Run(graph, am);
+  ASSERT_EQ(Dump(graph), "%A:\n"
+                         "  jmp B\n"
+                         "%B:\n"
+                         "  B0 = phi [ 0 A ] [ C0 F ]\n"
+                         "  B2 = cmp B0 10\n"
+                         "  jeq B2 0 E\n"
+                         "%C:\n"
+                         "  C0 = add B0 1\n"
+                         "  jmp F\n"
+                         "%F:\n"
+                         "  jmp B\n"
+                         "%E:\n"
+                         "  ret B0\n");
+  ASSERT_EQ(Interpreter(graph).Run(), 10u);
+  ASSERT_EQ(pm.GetStats()[0].numChanges, 1u);
+}
+
+// for (i = 0; i < n; ++i) a chain of diamonds, every condition is either
+// constant or depends on i
+static void CreateDiamonds(Graph &graph, std::mt19937 &gen, size_t size) {
+  BBlockPtr entry = graph.CreateBlock("entry");
+  BBlockPtr header = graph.CreateBlock("header");
+  graph.CreateEdge(entry, header);
+  IRBuilder builder(entry);
+  auto zero = builder.CreateImm(0);
+  auto flag = builder.CreateAssign(builder.CreateImm(gen() % 2));
+  builder.CreateJmp(builder.CreateLabel(header));
+
+  builder.SetBBlock(header);
+  auto i = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                             builder.CreateLabel(entry));
+  auto sum = builder.CreatePhi(zero, builder.CreateLabel(entry), zero,
+                               builder.CreateLabel(entry));
+  auto exit = graph.CreateBlock("exit");
+  BBlockPtr prev = header;
+  Operand *value = sum;
+  for (size_t d = 0; d < size; ++d) {
+    BBlockPtr cond = graph.CreateBlock("cond");
+    BBlockPtr then = graph.CreateBlock("then");
+    BBlockPtr other = graph.CreateBlock("else");
+    BBlockPtr join = graph.CreateBlock("join");
+    graph.CreateEdge(prev, cond);
+    graph.CreateEdge(cond, then);
+    graph.CreateEdge(cond, other);
+    graph.CreateEdge(then, join);
+    graph.CreateEdge(other, join);
+    if (prev == header) {
+      graph.CreateEdge(header, exit);
+      auto less = builder.CreateCmp(i, builder.CreateImm(10));
+      builder.CreateJeq(less, zero, builder.CreateLabel(exit));
+    } else {
+      builder.CreateJmp(builder.CreateLabel(cond));
+    }
+
+    builder.SetBBlock(cond);
+    auto k = builder.CreateMul(builder.CreateImm(gen() % 4),
+                               builder.CreateAdd(flag, builder.CreateImm(2)));
+    auto test = builder.CreateCmp(gen() % 3 ? k : i, builder.CreateImm(4));
+    builder.CreateJeq(test, zero, builder.CreateLabel(other));
+    builder.SetBBlock(then);
+    auto a = builder.CreateAdd(value, k);
+    builder.CreateJmp(builder.CreateLabel(join));
+    builder.SetBBlock(other);
+    auto b = builder.CreateMul(value, builder.CreateImm(3));
+    builder.CreateJmp(builder.CreateLabel(join));
+    builder.SetBBlock(join);
+    value = builder.CreatePhi(a, builder.CreateLabel(then), b,
+                              builder.CreateLabel(other));
+    prev = join;
+  }
+  graph.CreateEdge(prev, header);
+  auto iNext = builder.CreateAdd(i, builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(header));
+  GetInst(i)->SetOperand(2, iNext);
+  GetInst(i)->SetOperand(3, builder.CreateLabel(prev));
+  GetInst(sum)->SetOperand(2, value);
+  GetInst(sum)->SetOperand(3, builder.CreateLabel(prev));
+
+  builder.SetBBlock(exit);
+  builder.CreateRet(sum);
+}
+
+static size_t CountInsts(const Graph &graph) {
+  size_t numInsts = 0;
+  for (const auto &block : graph.GetBlocks()) {
+    numInsts += block->GetInstCount();
+  }
+  return numInsts;
+}
+
+TEST(SCCP, random) {
+  // the result is the same, with fewer instructions executed
+  std::mt19937 gen(5);
+  for (size_t round = 0; round < 20; ++round) {
+    Graph graph;
+    CreateDiamonds(graph, gen, 1 + round);
+    uint64_t executed = 0;
+    uint64_t expected = Interpreter(graph).Run(executed);
+    size_t numInsts = CountInsts(graph);
+
+    AnalysisManager am(graph);
+    SCCP sccp;
+    sccp.Run(graph, am);
+    uint64_t executedAfter = 0;
+    ASSERT_EQ(Interpreter(graph).Run(executedAfter), expected);
+    ASSERT_LT(executedAfter, executed);
+    ASSERT_LT(CountInsts(graph), numInsts);
+    ASSERT_EQ(graph.GetBlocks()[graph.GetSize() - 1]->GetId(),
+              graph.GetSize() - 1);
+  }
+}
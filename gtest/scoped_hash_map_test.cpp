@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include <support/ScopedHashMap.h>
+
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+TEST(ScopedHashMap, shadow) {
+  ScopedHashMap<int, int, std::hash<int>> map;
+  map.PushScope();
+  map.Insert(1, 10);
+  map.Insert(2, 20);
+
+  map.PushScope();
+  ASSERT_EQ(*map.Find(1), 10);
+  map.Insert(1, 11);
+  map.Insert(3, 30);
+  ASSERT_EQ(*map.Find(1), 11);
+  ASSERT_EQ(map.size(), 3u);
+  ASSERT_EQ(map.GetNumScopes(), 2u);
+
+  // the outer entries come back
+  map.PopScope();
+  ASSERT_EQ(*map.Find(1), 10);
+  ASSERT_EQ(*map.Find(2), 20);
+  ASSERT_EQ(map.Find(3), nullptr);
+  ASSERT_EQ(map.size(), 2u);
+
+  map.PopScope();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.Find(1), nullptr);
+}
+
+// colliding keys make the erased entries shift back
+struct BadHash {
+  size_t operator()(int key) const { return key % 8; }
+};
+
+TEST(ScopedHashMap, random) {
+  // compare with a stack of copies of a reference map
+  ScopedHashMap<int, int, BadHash> map;
+  std::vector<std::unordered_map<int, int>> reference(1);
+  std::mt19937 gen(3);
+  map.PushScope();
+  for (size_t step = 0; step < 20000; ++step) {
+    uint32_t action = gen() % 8;
+    if (action == 0 && reference.size() < 64) {
+      map.PushScope();
+      reference.push_back(reference.back());
+    } else if (action == 1 && reference.size() > 1) {
+      map.PopScope();
+      reference.pop_back();
+    } else {
+      int key = gen() % 256;
+      map.Insert(key, step);
+      reference.back()[key] = step;
+    }
+
+    int key = gen() % 256;
+    auto it = reference.back().find(key);
+    int *value = map.Find(key);
+    if (it == reference.back().end()) {
+      ASSERT_EQ(value, nullptr);
+    } else {
+      ASSERT_NE(value, nullptr);
+      ASSERT_EQ(*value, it->second);
+    }
+    ASSERT_EQ(map.size(), reference.back().size());
+  }
+}
@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include <support/StringMap.h>
+
+#include <string>
+#include <vector>
+
+TEST(StringMap, insertFind) {
+  StringMap<int> map;
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.Find("a"), nullptr);
+
+  auto [value, inserted] = map.Insert("a", 1);
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(*value, 1);
+  // the value of a present key is kept
+  auto [same, insertedAgain] = map.Insert("a", 2);
+  ASSERT_FALSE(insertedAgain);
+  ASSERT_EQ(same, value);
+  ASSERT_EQ(*map.Find("a"), 1);
+  *map.Find("a") = 3;
+  ASSERT_EQ(*map.Find("a"), 3);
+  ASSERT_EQ(map.size(), 1u);
+
+  // keys are compared by content, not by address
+  std::string key = "a";
+  ASSERT_EQ(map.Find(key), value);
+  ASSERT_EQ(map.Find("ab"), nullptr);
+}
+
+TEST(StringMap, growClear) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 10000; ++i) {
+    keys.push_back("B" + std::to_string(i));
+  }
+
+  StringMap<size_t> map;
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ASSERT_TRUE(map.Insert(keys[i], i + round).second);
+    }
+    ASSERT_EQ(map.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ASSERT_EQ(*map.Find(keys[i]), i + round);
+    }
+    ASSERT_EQ(map.Find("B10000"), nullptr);
+
+    map.Clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.Find(keys[0]), nullptr);
+  }
+}
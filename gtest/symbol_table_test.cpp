@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include <IR/include/Graph.h>
+
+#include <sstream>
+#include <string>
+
+TEST(SymbolTable, internNumbered) {
+  Arena arena;
+  SymbolTable symbols(arena);
+  SymbolId a = symbols.Intern("A");
+  ASSERT_EQ(symbols.Intern(std::string("A")), a);
+  SymbolId b = symbols.Intern("B");
+  ASSERT_NE(a, b);
+  ASSERT_EQ(symbols.GetText(b), "B");
+
+  // numbered symbols are fresh and have no text of their own
+  SymbolId a0 = symbols.CreateNumbered(a, 0);
+  SymbolId a0Again = symbols.CreateNumbered(a, 0);
+  ASSERT_NE(a0, a0Again);
+  ASSERT_TRUE(symbols.GetText(a0).empty());
+  ASSERT_EQ(symbols.GetName(a0), "A0");
+  ASSERT_EQ(symbols.GetName(symbols.CreateNumbered(a0, 12)), "A012");
+  ASSERT_EQ(symbols.GetSize(), 5u);
+
+  std::stringstream ss;
+  symbols.Dump(ss, b);
+  symbols.Dump(ss, a0);
+  ASSERT_EQ(ss.str(), "BA0");
+}
+
+TEST(SymbolTable, irNames) {
+  Graph graph;
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  graph.CreateEdge(A, B);
+  ASSERT_EQ(A->GetName(), "A");
+  ASSERT_EQ(graph.GetSymbols().Intern("B"), B->GetSymbol());
+
+  // IRBuilder names instructions by block and number without strings
+  IRBuilder builder(A);
+  auto one = builder.CreateAssign(builder.CreateImm(1));
+  builder.CreateJmp(builder.CreateLabel(B));
+  Inst *inst = static_cast<InstOperand *>(one)->GetInst();
+  ASSERT_EQ(inst->GetName(), "A0");
+  ASSERT_TRUE(graph.GetSymbols().GetText(inst->GetSymbol()).empty());
+
+  inst->SetName("one");
+  ASSERT_EQ(inst->GetSymbol(), graph.GetSymbols().Intern("one"));
+  std::stringstream ss;
+  A->Dump(ss);
+  ASSERT_EQ(ss.str(), "%A:\n  one = assign 1\n  jmp B\n");
+}
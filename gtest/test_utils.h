@@ -0,0 +1,27 @@
+#pragma once
+#include "gtest/gtest.h"
+
+#include <IR/include/Graph.h>
+#include <IR/include/Parser.h>
+#include <interp/Interpreter.h>
+
+#include <sstream>
+#include <string>
+
+// text of the blocks in layout order, the parser reads it back
+inline std::string Dump(const Graph &graph) {
+  std::stringstream ss;
+  for (const auto &block : graph.GetBlocks()) {
+    block->Dump(ss);
+  }
+  return ss.str();
+}
+
+// the dump reads back into a graph computing the same value
+inline void ExpectRoundTrip(const Graph &graph, uint64_t expected) {
+  std::string text = Dump(graph);
+  Graph parsed;
+  Parser parser(text);
+  ASSERT_TRUE(parser.ParseGraph(parsed)) << parser.GetError();
+  ASSERT_EQ(Interpreter(parsed).Run(), expected);
+}
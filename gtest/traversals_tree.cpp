@@ -4,20 +4,13 @@
 
 TEST(Traversal, first) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
   graph.CreateEdge(B, F);
@@ -39,28 +32,17 @@ TEST(Traversal, first) {
 
 TEST(Traversal, second) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
-  BBlockPtr K = std::make_shared<BBlock>("K");
-  graph.PushBlock(K);
-  BBlockPtr J = std::make_shared<BBlock>("J");
-  graph.PushBlock(J);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
+  BBlockPtr K = graph.CreateBlock("K");
+  BBlockPtr J = graph.CreateBlock("J");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, C);
   graph.CreateEdge(C, D);
@@ -87,24 +69,15 @@ TEST(Traversal, second) {
 
 TEST(Traversal, third) {
   Graph graph;
-  BBlockPtr A = std::make_shared<BBlock>("A");
-  graph.PushBlock(A);
-  BBlockPtr B = std::make_shared<BBlock>("B");
-  graph.PushBlock(B);
-  BBlockPtr C = std::make_shared<BBlock>("C");
-  graph.PushBlock(C);
-  BBlockPtr D = std::make_shared<BBlock>("D");
-  graph.PushBlock(D);
-  BBlockPtr E = std::make_shared<BBlock>("E");
-  graph.PushBlock(E);
-  BBlockPtr F = std::make_shared<BBlock>("F");
-  graph.PushBlock(F);
-  BBlockPtr G = std::make_shared<BBlock>("G");
-  graph.PushBlock(G);
-  BBlockPtr H = std::make_shared<BBlock>("H");
-  graph.PushBlock(H);
-  BBlockPtr I = std::make_shared<BBlock>("I");
-  graph.PushBlock(I);
+  BBlockPtr A = graph.CreateBlock("A");
+  BBlockPtr B = graph.CreateBlock("B");
+  BBlockPtr C = graph.CreateBlock("C");
+  BBlockPtr D = graph.CreateBlock("D");
+  BBlockPtr E = graph.CreateBlock("E");
+  BBlockPtr F = graph.CreateBlock("F");
+  BBlockPtr G = graph.CreateBlock("G");
+  BBlockPtr H = graph.CreateBlock("H");
+  BBlockPtr I = graph.CreateBlock("I");
   graph.CreateEdge(A, B);
   graph.CreateEdge(B, E);
   graph.CreateEdge(E, F);
@@ -126,3 +99,24 @@ TEST(Traversal, third) {
   std::vector<BBlockPtr> po_exp = {A, B, E, C, F, D, H, G, I};
   ASSERT_EQ(po, po_exp);
 }
+
+TEST(Traversal, longChain) {
+  const size_t size = 100000;
+  Graph graph;
+  std::vector<BBlockPtr> blocks;
+  for (size_t i = 0; i < size; ++i) {
+    blocks.push_back(graph.CreateBlock("B" + std::to_string(i)));
+    ASSERT_EQ(blocks.back()->GetId(), i);
+  }
+  for (size_t i = 1; i < size; ++i) {
+    graph.CreateEdge(blocks[i - 1], blocks[i]);
+    graph.CreateEdge(blocks[i], blocks[i - 1]);
+  }
+
+  ASSERT_EQ(graph.GetDfs(), blocks);
+  ASSERT_EQ(graph.GetPo(), blocks);
+
+  graph.RemoveBlock(blocks[1]);
+  ASSERT_TRUE(blocks[0]->GetSuccessors().empty());
+  ASSERT_EQ(graph.GetDfs(), std::vector<BBlockPtr>{blocks[0]});
+}
@@ -3,16 +3,19 @@
 #include <IR/include/Inst.h>
 #include <IR/include/Opcode.h>
 #include <IR/include/Operand.h>
+#include <IR/include/SymbolTable.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
-#include <list>
-#include <memory>
 #include <set>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include <support/IList.h>
+
 class Inst;
 class Label;
 class PhiInst;
@@ -21,31 +24,46 @@ class InstOperand;
 class ImmOperand;
 class LabelOperand;
 
+class Graph;
+class Arena;
+
 class BBlock;
-using BBlockPtr = std::shared_ptr<BBlock>;
+using BBlockPtr = BBlock *;
 
 class BBlock {
 public:
-  BBlock();
-  BBlock(const std::string &lname);
+  // blocks are created by Graph::CreateBlock and live in the graph arena
+  BBlock(Graph *graph, std::string_view lname);
 
   // non-movable, non-copyable
   BBlock(BBlock &) = delete;
   BBlock(BBlock &&) = delete;
 
-  using Iterator = std::list<std::shared_ptr<Inst>>::iterator;
-  using PhiIterator = std::list<std::shared_ptr<PhiInst>>::iterator;
+  using InstList = IList<Inst>;
+  using Iterator = InstList::Iterator;
+  // phis are always the prefix of the instruction list
+  using PhiIterator = InstList::IteratorImpl<PhiInst>;
 
   Iterator InstBegin() { return instList.begin(); }
   Iterator InstEnd() { return instList.end(); }
 
-  PhiIterator PhiBegin() { return phiList.begin(); }
-  PhiIterator PhiEnd() { return phiList.end(); }
+  PhiIterator PhiBegin() { return instList.begin(); }
+  PhiIterator PhiEnd() const;
+
+  InstList &GetInstList() { return instList; }
+  IteratorRange<PhiIterator> GetPhis() { return {PhiBegin(), PhiEnd()}; }
 
-  std::list<std::shared_ptr<Inst>> &GetInstList() { return instList; }
-  std::list<std::shared_ptr<PhiInst>> &GetPhiList() { return phiList; }
+  size_t GetInstCount() const { return instList.size(); }
 
-  void AddSucc(std::shared_ptr<BBlock> succ) {
+  // link 'inst' before 'pos', phis go to the phi prefix only
+  Iterator InsertBefore(Iterator pos, Inst *inst);
+  void PushBack(Inst *inst) { InsertBefore(InstEnd(), inst); }
+  // link phi to the end of the phi prefix
+  void PushPhi(PhiInst *phi);
+  // unlink 'inst', return iterator to the next instruction
+  Iterator Erase(Inst *inst);
+
+  void AddSucc(BBlockPtr succ) {
     auto it = std::find(successors.begin(), successors.end(), succ);
     if (it == successors.end()) {
       assert(successors.size() <= 2 && "no more than 2 successors");
@@ -53,43 +71,56 @@ public:
     }
   }
 
-  void AddPred(std::shared_ptr<BBlock> pred) {
+  void AddPred(BBlockPtr pred) {
     auto it = std::find(predessors.begin(), predessors.end(), pred);
     if (it == predessors.end()) {
       predessors.push_back(pred);
     }
   }
 
-  bool RemoveSucc(std::shared_ptr<BBlock> succ) {
+  bool RemoveSucc(BBlockPtr succ) {
     auto it = std::find(successors.begin(), successors.end(), succ);
-    return successors.erase(it) != successors.end();
+    if (it == successors.end()) {
+      return false;
+    }
+    successors.erase(it);
+    return true;
   }
 
-  bool RemovePred(std::shared_ptr<BBlock> pred) {
+  bool RemovePred(BBlockPtr pred) {
     auto it = std::find(predessors.begin(), predessors.end(), pred);
-    return predessors.erase(it) != predessors.end();
+    if (it == predessors.end()) {
+      return false;
+    }
+    predessors.erase(it);
+    return true;
   }
 
-  const std::list<std::shared_ptr<BBlock>> &GetSuccessors() const {
-    return successors;
-  }
+  const std::vector<BBlockPtr> &GetSuccessors() const { return successors; }
 
-  const std::list<std::shared_ptr<BBlock>> &GetPredessors() const {
-    return predessors;
-  }
+  const std::vector<BBlockPtr> &GetPredessors() const { return predessors; }
+
+  // dense index of the block in its graph, assigned by the graph
+  uint32_t GetId() const { return id; }
+  void SetId(uint32_t newId) { id = newId; }
+
+  Graph *GetGraph() const { return graph; }
 
-  const std::string &GetName() const { return name; };
-  void DumpDot(std::ostream &os) const { os << name; };
+  SymbolId GetSymbol() const { return name; }
+  // materialized from the symbol table of the graph
+  std::string GetName() const;
+  void DumpDot(std::ostream &os) const;
 
   void Dump(std::ostream &os) const;
 
 private:
-  std::string name;
+  Graph *graph;
+  uint32_t id = 0;
+  SymbolId name;
 
-  std::list<std::shared_ptr<Inst>> instList;
-  std::list<std::shared_ptr<PhiInst>> phiList;
-  std::list<std::shared_ptr<BBlock>> predessors;
-  std::list<std::shared_ptr<BBlock>> successors;
+  InstList instList;
+  std::vector<BBlockPtr> predessors;
+  std::vector<BBlockPtr> successors;
 };
 
 class Inserter {
@@ -99,88 +130,78 @@ public:
     assert(false && "unimplemented");
   }
 
-  Inserter(std::shared_ptr<BBlock> block)
-      : block(block), pos(block->InstBegin()), posPhi(block->PhiBegin()) {
-    instCount = std::distance(block->InstBegin(), block->InstEnd());
+  Inserter(BBlockPtr block)
+      : block(block), pos(block->InstEnd()) {
+    instCount = block->GetInstCount();
   }
 
   using Iterator = BBlock::Iterator;
   using PhiIterator = BBlock::PhiIterator;
 
-  template <class I> std::shared_ptr<Operand> Insert(std::shared_ptr<I> inst) {
+  Operand *Insert(Inst *inst) {
     ++instCount;
-    auto instList = block->GetInstList();
-    pos = instList.insert(++pos, inst);
-    return std::static_pointer_cast<Operand>(
-        std::make_shared<InstOperand>(*pos));
+    block->InsertBefore(pos, inst);
+    return CreateInstOperand(inst);
   }
 
-  std::shared_ptr<Operand> Insert(std::shared_ptr<PhiInst> phiInst) {
+  Operand *Insert(PhiInst *phiInst) {
     ++instCount;
-    auto phiList = block->GetPhiList();
-    phiList.insert(++posPhi, phiInst);
-
-    auto inst = std::static_pointer_cast<Inst>(phiInst);
-    auto instList = block->GetInstList();
-    pos = instList.insert(++pos, inst);
-    return std::static_pointer_cast<Operand>(
-        std::make_shared<InstOperand>(*pos));
+    block->PushPhi(phiInst);
+    return CreateInstOperand(phiInst);
   }
 
-  std::shared_ptr<BBlock> GetBBlock() const { return block; }
+  BBlockPtr GetBBlock() const { return block; }
 
-  void SetBBlock(std::shared_ptr<BBlock> newBlock) {
+  void SetBBlock(BBlockPtr newBlock) {
     block = newBlock;
-    instCount = std::distance(block->InstBegin(), block->InstEnd());
-    pos = block->InstBegin();
-    posPhi = block->PhiBegin();
+    instCount = block->GetInstCount();
+    pos = block->InstEnd();
   }
 
+  void SetInsertPoint(Iterator newPos) { pos = newPos; }
+
   uint64_t GetInstCount() const { return instCount; }
 
+private:
+  Operand *CreateInstOperand(Inst *inst);
+
 private:
   uint64_t instCount;
-  std::shared_ptr<BBlock> block;
+  BBlockPtr block;
   Iterator pos; // insert before position
-  PhiIterator posPhi;
 };
 
 class IRBuilder {
 public:
-  IRBuilder(std::shared_ptr<BBlock> block) : inserter(block) {}
+  IRBuilder(BBlockPtr block) : inserter(block) {}
   IRBuilder() {}
 
   using Iterator = BBlock::Iterator;
 
-  std::shared_ptr<BBlock> GetBBlock() { return inserter.GetBBlock(); }
+  BBlockPtr GetBBlock() { return inserter.GetBBlock(); }
 
-  void SetBBlock(std::shared_ptr<BBlock> newBlock) {
-    inserter.SetBBlock(newBlock);
-  }
+  void SetBBlock(BBlockPtr newBlock) { inserter.SetBBlock(newBlock); }
 
-  std::shared_ptr<Operand> CreateImm(uint64_t val);
-  std::shared_ptr<Operand> CreateAssign(std::shared_ptr<Operand> src);
-  std::shared_ptr<Operand> CreateAdd(std::shared_ptr<Operand> src0,
-                                     std::shared_ptr<Operand> src1);
-  std::shared_ptr<Operand> CreateMul(std::shared_ptr<Operand> src0,
-                                     std::shared_ptr<Operand> src1);
-  std::shared_ptr<Operand> CreateCmp(std::shared_ptr<Operand> src0,
-                                     std::shared_ptr<Operand> src1);
-  std::shared_ptr<Operand> CreateJeq(std::shared_ptr<Operand> src0,
-                                     std::shared_ptr<Operand> src1,
-                                     std::shared_ptr<LabelOperand> label);
-  std::shared_ptr<Operand> CreateJmp(std::shared_ptr<LabelOperand> label);
-  std::shared_ptr<Operand> CreateRet(std::shared_ptr<Operand> ret);
-  std::shared_ptr<Operand> CreatePhi(std::shared_ptr<Operand> src0,
-                                     std::shared_ptr<LabelOperand> pred0,
-                                     std::shared_ptr<Operand> src1,
-                                     std::shared_ptr<LabelOperand> pred1);
+  Operand *CreateImm(uint64_t val);
+  LabelOperand *CreateLabel(BBlockPtr target);
+  // operand referring to an existing instruction
+  Operand *CreateInstOperand(Inst *inst);
+  Operand *CreateAssign(Operand *src);
+  Operand *CreateAdd(Operand *src0, Operand *src1);
+  Operand *CreateMul(Operand *src0, Operand *src1);
+  Operand *CreateCmp(Operand *src0, Operand *src1);
+  Operand *CreateJeq(Operand *src0, Operand *src1, LabelOperand *label);
+  Operand *CreateJmp(LabelOperand *label);
+  Operand *CreateRet(Operand *ret);
+  Operand *CreatePhi(Operand *src0, LabelOperand *pred0, Operand *src1,
+                     LabelOperand *pred1);
 
 private:
-  std::string CreateInstName() const {
-    return inserter.GetBBlock()->GetName() +
-           std::to_string(inserter.GetInstCount());
-  }
+  // all IR objects of the function live in the arena of its graph
+  Arena &GetArena();
+
+  // block name followed by the instruction number, never built as a string
+  SymbolId CreateInstName();
 
 private:
   Inserter inserter;
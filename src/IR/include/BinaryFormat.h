@@ -0,0 +1,148 @@
+#pragma once
+
+#include <IR/include/Module.h>
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+// Binary image of a module. All records are fixed size and 8-byte aligned
+// at their offsets, an image mapped into memory is walked in place:
+//
+//   Header
+//   FunctionRecord[numFunctions]
+//   per function: BlockRecord[numBlocks], InstRecord[numInsts],
+//                 uint32_t edges[numEdges] (padded to 8), uint64_t imms[]
+//   StringTable, uint32_t offsets[numStrings + 1], char data[]
+//
+// Blocks, instructions and immediates are numbered per function. Names are
+// interned into the string table shared by all functions, strings are
+// NUL-terminated.
+class BinaryModule {
+public:
+  static constexpr char kMagic[4] = {'I', 'R', 'B', 'N'};
+  static constexpr uint32_t kVersion = 1;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t numFunctions;
+    uint32_t reserved;
+    uint64_t functionsOffset;
+    uint64_t stringsOffset;
+  };
+
+  struct FunctionRecord {
+    uint32_t name;
+    uint32_t numBlocks;
+    uint32_t numInsts;
+    uint32_t numEdges;
+    uint32_t numImms;
+    uint32_t reserved;
+    uint64_t blocksOffset;
+    uint64_t instsOffset;
+    uint64_t edgesOffset;
+    uint64_t immsOffset;
+  };
+
+  // instructions of a block are consecutive, edges of a block are its
+  // successors followed by its predecessors
+  struct BlockRecord {
+    uint32_t name;
+    uint32_t firstInst;
+    uint32_t numInsts;
+    uint32_t firstEdge;
+    uint32_t numSuccs;
+    uint32_t numPreds;
+  };
+
+  // operand kind in the low 2 bits, index of the immediate, instruction or
+  // target block in the function above them
+  using OperandRecord = uint32_t;
+
+  struct InstRecord {
+    uint16_t opcode;
+    uint16_t numOperands;
+    uint32_t name;
+    OperandRecord operands[Inst::kMaxOperands];
+  };
+
+  struct StringTable {
+    uint32_t numStrings;
+    uint32_t reserved;
+    uint64_t dataSize;
+  };
+
+  static OperandRecord EncodeOperand(Operand::OpKind kind, uint32_t index) {
+    assert(index < (1u << 30) && "operand index overflow");
+    return (index << 2) | kind;
+  }
+  static Operand::OpKind GetOperandKind(OperandRecord opnd) {
+    return static_cast<Operand::OpKind>(opnd & 3);
+  }
+  static uint32_t GetOperandIndex(OperandRecord opnd) { return opnd >> 2; }
+
+  // 'data' must stay alive and 8-byte aligned, the image is not copied
+  BinaryModule(const void *data, size_t size);
+
+  // section bounds and every index in the records are checked, a valid
+  // image is read without going out of bounds
+  bool IsValid() const { return valid; }
+
+  uint32_t GetNumFunctions() const { return header->numFunctions; }
+  const FunctionRecord &GetFunction(uint32_t idx) const {
+    assert(idx < header->numFunctions && "invalid function");
+    return functions[idx];
+  }
+
+  const BlockRecord *GetBlocks(const FunctionRecord &func) const {
+    return At<BlockRecord>(func.blocksOffset);
+  }
+  const InstRecord *GetInsts(const FunctionRecord &func) const {
+    return At<InstRecord>(func.instsOffset);
+  }
+  const uint32_t *GetEdges(const FunctionRecord &func) const {
+    return At<uint32_t>(func.edgesOffset);
+  }
+  const uint64_t *GetImms(const FunctionRecord &func) const {
+    return At<uint64_t>(func.immsOffset);
+  }
+
+  uint32_t GetNumStrings() const { return strings->numStrings; }
+  std::string_view GetString(uint32_t idx) const {
+    assert(idx < strings->numStrings && "invalid string");
+    return {stringData + stringOffsets[idx],
+            stringOffsets[idx + 1] - stringOffsets[idx] - 1};
+  }
+
+private:
+  template <class T>
+  const T *At(uint64_t offset) const {
+    return reinterpret_cast<const T *>(data + offset);
+  }
+
+  bool Validate();
+  bool ValidateStrings() const;
+  bool ValidateFunction(const FunctionRecord &func) const;
+
+private:
+  const char *data;
+  size_t size;
+  bool valid = false;
+
+  const Header *header = nullptr;
+  const FunctionRecord *functions = nullptr;
+  const StringTable *strings = nullptr;
+  const uint32_t *stringOffsets = nullptr;
+  const char *stringData = nullptr;
+};
+
+// Stream the module in one pass. Instructions and immediates are numbered
+// beforehand, names are interned while writing.
+void WriteBinary(const Module &module, std::ostream &os);
+
+// Materialize the IR of the image. Every IR object is allocated in the
+// arena of its function, the image isn't needed afterwards. nullptr if the
+// image is not valid.
+std::unique_ptr<Module> ReadBinary(const BinaryModule &image);
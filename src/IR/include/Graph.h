@@ -2,12 +2,12 @@
 
 #include <IR/include/BasicBlock.h>
 #include <IR/include/GraphTraits.h>
+#include <IR/include/SymbolTable.h>
 
 #include <list>
-#include <memory>
 #include <stack>
-
-using BBlockPtr = std::shared_ptr<BBlock>;
+#include <string>
+#include <string_view>
 
 class BBlockNode {
  public:
@@ -17,4 +17,18 @@ class BBlockNode {
 class Graph : public GraphTraits<BBlockNode> {
  public:
   using NodePtr = BBlockPtr;
+
+  Graph() : symbols(GetArena()) {}
+
+  BBlockPtr CreateBlock(std::string_view name) {
+    return CreateNode(this, name);
+  }
+
+  // names of the blocks and instructions, every function has its own
+  // table so functions can be built on different threads
+  SymbolTable &GetSymbols() { return symbols; }
+  const SymbolTable &GetSymbols() const { return symbols; }
+
+ private:
+  SymbolTable symbols;
 };
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <support/Arena.h>
+#include <support/BitVector.h>
+
+#include <cstdint>
 #include <ostream>
-#include <stack>
+#include <type_traits>
+#include <vector>
 
 template <class Node>
 class NodeTraits {
  public:
-  using NodePtr = std::shared_ptr<Node>;
+  using NodePtr = Node *;
 
   virtual void AddSucc(const NodePtr succ) = 0;
   virtual void AddPred(const NodePtr pred) = 0;
@@ -18,14 +23,28 @@ class NodeTraits {
   // for DumpDot
   virtual std::string GetName() const = 0;
   virtual void DumpDot(std::ostream &) const = 0;
+
+  // dense index of the node in its graph
+  uint32_t GetId() const { return id; }
+  void SetId(uint32_t newId) { id = newId; }
+
+ private:
+  uint32_t id = 0;
 };
 
 template <class Node>
 class GraphTraits {
  public:
   using NodePtr = typename Node::NodePtr;
+  using NodeType = std::remove_pointer_t<NodePtr>;
   using Iter = typename std::vector<NodePtr>::iterator;
 
+  GraphTraits() = default;
+
+  // nodes are owned by the graph arena
+  GraphTraits(const GraphTraits &) = delete;
+  GraphTraits(GraphTraits &&) = delete;
+
   Iter BlockBegin() {
     return nodes.begin();
   }
@@ -34,10 +53,22 @@ class GraphTraits {
   }
   const std::vector<NodePtr> &GetBlocks() const { return nodes; }
 
+  // nodes are numbered densely in push order: GetBlocks()[b->GetId()] == b
   void PushBlock(NodePtr block) {
+    block->SetId(nodes.size());
     nodes.push_back(block);
   }
 
+  // allocate node in the graph arena and push it to the graph
+  template <class... Args>
+  NodePtr CreateNode(Args &&...args) {
+    NodePtr node = arena.template Create<NodeType>(std::forward<Args>(args)...);
+    PushBlock(node);
+    return node;
+  }
+
+  Arena &GetArena() { return arena; }
+
   void CreateEdge(NodePtr from, NodePtr to) {
     assert(Contains(from) && Contains(to) && "nodes outside of graph");
     from->AddSucc(to);
@@ -51,11 +82,44 @@ class GraphTraits {
 
   void RemoveBlock(NodePtr block) {
     assert(Contains(block) && "block outside of graph");
-    for (const auto &succ : block->GetSuccessors()) {
-      RemoveEdge(block, succ);
+    while (!block->GetSuccessors().empty()) {
+      RemoveEdge(block, block->GetSuccessors().front());
+    }
+    while (!block->GetPredessors().empty()) {
+      RemoveEdge(block->GetPredessors().front(), block);
+    }
+  }
+
+  // erase the nodes marked in 'erased' (indexed by id) with their edges,
+  // the rest keep their order and are renumbered densely. Erased nodes
+  // stay in the arena.
+  void EraseBlocks(const BitVector &erased) {
+    assert(erased.size() == nodes.size() && "erased set of another graph");
+    assert(!erased.Test(0) && "the entry can't be erased");
+    for (const auto &node : nodes) {
+      if (erased.Test(node->GetId())) {
+        RemoveBlock(node);
+      }
+    }
+    size_t numKept = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (!erased.Test(i)) {
+        nodes[numKept] = nodes[i];
+        nodes[numKept]->SetId(numKept);
+        ++numKept;
+      }
     }
-    for (const auto &pred : block->GetPredessors()) {
-      RemoveEdge(pred, block);
+    nodes.resize(numKept);
+  }
+
+  // lay the nodes out in 'order', a permutation of the nodes keeping the
+  // entry first, and renumber them densely
+  void SetOrder(std::vector<NodePtr> order) {
+    assert(order.size() == nodes.size() && "not a permutation of the nodes");
+    assert(order.front() == nodes.front() && "the entry must stay first");
+    nodes = std::move(order);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      nodes[i]->SetId(i);
     }
   }
 
@@ -64,9 +128,11 @@ class GraphTraits {
   }
 
   bool Contains(const NodePtr b) const {
-    return std::find(nodes.cbegin(), nodes.cend(), b) != nodes.cend();
+    return b->GetId() < nodes.size() && nodes[b->GetId()] == b;
   }
 
+  size_t GetSize() const { return nodes.size(); }
+
   void DumpDot(std::ostream &os) const {
     os << "digraph G {" << std::endl;
     for (const auto &b : nodes) {
@@ -82,59 +148,61 @@ class GraphTraits {
   }
 
   std::vector<NodePtr> GetDfs() const {
-    std::set<NodePtr> visited;
-    return std::move(GetDfs(GetEntry(), visited));
+    BitVector visited(nodes.size());
+    return GetDfs(GetEntry(), visited);
   }
 
-  std::vector<NodePtr> GetDfs(const NodePtr start, std::set<NodePtr> &visited) const {
+  // 'visited' is indexed by node id, visited nodes are not traversed
+  std::vector<NodePtr> GetDfs(const NodePtr start, BitVector &visited) const {
+    assert(visited.size() == nodes.size() && "visited set of another graph");
     std::vector<NodePtr> dfs;
-    std::stack<NodePtr> nodesToVisit;
+    std::vector<NodePtr> nodesToVisit;
 
-    nodesToVisit.push(start);
+    nodesToVisit.push_back(start);
     while (!nodesToVisit.empty()) {
-      NodePtr curr = nodesToVisit.top();
-      nodesToVisit.pop();
+      NodePtr curr = nodesToVisit.back();
+      nodesToVisit.pop_back();
 
-      if (!visited.count(curr)) {
+      if (visited.TestAndSet(curr->GetId())) {
         dfs.push_back(curr);
-        visited.insert(curr);
 
         const auto &succs = curr->GetSuccessors();
         for_each(succs.crbegin(), succs.crend(), [&visited, &nodesToVisit](auto &succ) {
-          if (!visited.count(succ)) {
-            nodesToVisit.push(succ);
+          if (!visited.Test(succ->GetId())) {
+            nodesToVisit.push_back(succ);
           }
         });
       }
     }
 
-    return std::move(dfs);
+    return dfs;
   }
 
   std::vector<NodePtr> GetPo() const {
-    std::set<NodePtr> visited;
+    BitVector visited(nodes.size());
     std::vector<NodePtr> po;
-    std::list<NodePtr> nodesToVisit;
+    // FIFO queue: nodes are taken from 'head', pushed to the back
+    std::vector<NodePtr> nodesToVisit;
+    size_t head = 0;
     nodesToVisit.push_back(GetEntry());
 
-    while (!nodesToVisit.empty()) {
-      NodePtr curr = nodesToVisit.back();
-      nodesToVisit.pop_back();
+    while (head != nodesToVisit.size()) {
+      NodePtr curr = nodesToVisit[head++];
 
-      if (!visited.count(curr)) {
+      if (visited.TestAndSet(curr->GetId())) {
         po.push_back(curr);
-        visited.insert(curr);
         for (const auto &succ : curr->GetSuccessors()) {
-          if (!visited.count(succ)) {
-            nodesToVisit.push_front(succ);
+          if (!visited.Test(succ->GetId())) {
+            nodesToVisit.push_back(succ);
           }
         }
       }
     }
 
-    return std::move(po);
+    return po;
   }
 
  private:
+  Arena arena;
   std::vector<NodePtr> nodes;
 };
@@ -1,81 +1,201 @@
 #pragma once
 
-#include <IR/include/BasicBlock.h>
 #include <IR/include/Opcode.h>
 #include <IR/include/Operand.h>
+#include <IR/include/SymbolTable.h>
+#include <support/IList.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <initializer_list>
 #include <iostream>
-#include <list>
-#include <vector>
 
 class Operand;
+class LabelOperand;
 class BBlock;
+class Inst;
+class Arena;
 
-class Inst {
+// Operand slot of an instruction that refers to another instruction. Slot
+// is linked into the user list of the referred instruction.
+class Use : public IListNode<Use> {
 public:
-  Inst(Opcode op, const std::vector<std::shared_ptr<Operand>> &sources,
-       std::shared_ptr<BBlock> block, const std::string &name)
-      : op(op), block(block), sources(sources), name(name) {}
+  Inst *GetUser() const { return user; }
+  size_t GetOperandNo() const { return operandNo; }
 
-  Inst(const Inst &rhs) : Inst(rhs.op, rhs.sources, rhs.block, rhs.name) {}
+private:
+  friend class Inst;
+
+  Inst *user = nullptr;
+  size_t operandNo = 0;
+};
 
-  bool operator==(const Inst &rhs) {
-    // FIXME
-    return name == rhs.name;
+// instructions are linked into the instruction list of their block
+class Inst : public IListNode<Inst> {
+public:
+  static constexpr size_t kMaxOperands = 4;
+  using OperandList = std::initializer_list<Operand *>;
+  using UseList = IList<Use>;
+
+  // iterates over users of the instruction, an instruction using it
+  // several times is visited several times
+  class UserIterator {
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Inst *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Inst **;
+    using reference = Inst *;
+
+    UserIterator(UseList::Iterator it) : it(it) {}
+
+    Inst *operator*() const { return (*it)->GetUser(); }
+
+    UserIterator &operator++() {
+      ++it;
+      return *this;
+    }
+    UserIterator operator++(int) { return UserIterator(it++); }
+    UserIterator &operator--() {
+      --it;
+      return *this;
+    }
+    UserIterator operator--(int) { return UserIterator(it--); }
+
+    bool operator==(const UserIterator &rhs) const { return it == rhs.it; }
+    bool operator!=(const UserIterator &rhs) const { return it != rhs.it; }
+
+  private:
+    UseList::Iterator it;
+  };
+
+  Inst(Opcode op, OperandList sources, BBlock *block, SymbolId name)
+      : op(op), name(name), numSources(sources.size()), block(block) {
+    assert(sources.size() <= kMaxOperands && "too many operands");
+    assert(sources.size() == ::GetNumOperands(op) &&
+           "operand count doesn't match opcode");
+    std::copy(sources.begin(), sources.end(), this->sources.begin());
+    for (size_t i = 0; i < numSources; ++i) {
+      uses[i].user = this;
+      uses[i].operandNo = i;
+      LinkUse(i);
+    }
   }
 
+  // instruction of opcode 'op' with null operands allocated in 'arena',
+  // readers set the operands once forward references are resolved
+  static Inst *Create(Arena &arena, Opcode op, BBlock *block,
+                      SymbolId name);
+
+  // instructions are identified by address, they live in the graph arena
+  Inst(const Inst &) = delete;
+  Inst(Inst &&) = delete;
+
+  ~Inst() { DropAllReferences(); }
+
+  // same symbol, numbered names printed alike may still differ
+  bool operator==(const Inst &rhs) { return name == rhs.name; }
+
   bool IsPhi() const { return op == OP_phi; }
   bool IsLabel() const { return op == OP_label; }
   bool IsJmp() const { return op == OP_jmp; }
   bool IsJeq() const { return op == OP_jeq; }
   bool IsRet() const { return op == OP_ret; }
 
-  const std::string &GetName() const { return name; }
-  void SetName(const std::string &newName) { name = newName; }
-
-  std::shared_ptr<BBlock> GetBBlock() const { return block; }
+  // opcode traits, see Op.def
+  bool IsTerminator() const { return ::IsTerminator(op); }
+  bool IsBranch() const { return ::IsBranch(op); }
+  bool HasSideEffects() const { return ::HasSideEffects(op); }
+  bool HasResult() const { return ::HasResult(op); }
+  bool IsCommutative() const { return ::IsCommutative(op); }
+
+  // the name lives in the symbol table of the graph of the block
+  SymbolId GetSymbol() const { return name; }
+  void SetSymbol(SymbolId newName) { name = newName; }
+  std::string GetName() const;
+  void SetName(std::string_view newName);
+  void DumpName(std::ostream &os) const;
+
+  BBlock *GetBBlock() const { return block; }
+
+  // scratch dense number for passes keeping per-instruction state in flat
+  // arrays, set by such a pass for its own use. Any pass may renumber the
+  // instructions without reporting a change, so analyses which outlive a
+  // pass keep their own numbering.
+  uint32_t GetIndex() const { return index; }
+  void SetIndex(uint32_t newIndex) { index = newIndex; }
+
+  // unlink from the parent block
+  void EraseFromBBlock();
+  // unlink from the parent block (if any) and link before 'pos'
+  void MoveBefore(Inst *pos);
+  // unlink from the parent block (if any) and link to the end of 'dst'
+  void MoveToEnd(BBlock *dst);
 
   Opcode GetOpcode() const { return op; }
 
-  std::shared_ptr<Operand> GetOperand(size_t numOp) const {
-    assert(numOp < sources.size() && "invalid numOp");
-    return sources.at(numOp);
+  size_t GetNumOperands() const { return numSources; }
+
+  Operand *GetOperand(size_t numOp) const {
+    assert(numOp < numSources && "invalid numOp");
+    return sources[numOp];
   }
 
   // FIXME Phi inst must be handled separately
-  virtual void SetOperand(size_t numOp, std::shared_ptr<Operand> opnd) {
-    assert(numOp < sources.size() && "invalid numOp");
+  virtual void SetOperand(size_t numOp, Operand *opnd) {
+    assert(numOp < numSources && "invalid numOp");
+    UnlinkUse(numOp);
     sources[numOp] = opnd;
+    LinkUse(numOp);
   }
   virtual void Dump(std::ostream &os) const;
 
+  // operand slots of other instructions referring to this one
+  const UseList &GetUses() const { return users; }
+  IteratorRange<UserIterator> GetUsers() const {
+    return {users.begin(), users.end()};
+  }
+  bool HasUsers() const { return !users.empty(); }
+  size_t GetNumUses() const { return users.size(); }
+
+  // make every user refer to 'opnd' instead, O(number of uses)
+  void ReplaceAllUsesWith(Operand *opnd);
+  // unlink operands from user lists of the instructions they refer to,
+  // used before the instruction is thrown away
+  void DropAllReferences();
+
+private:
+  void LinkUse(size_t numOp);
+  void UnlinkUse(size_t numOp);
+
 private:
+  friend class BBlock;
+
   Opcode op;
-  std::string name;
-  std::vector<std::shared_ptr<Operand>> sources;
-  std::shared_ptr<Operand> src0;
-  std::shared_ptr<Operand> src1;
-  std::shared_ptr<BBlock> block;
+  SymbolId name;
+  std::array<Operand *, kMaxOperands> sources;
+  uint32_t numSources;
+  uint32_t index = 0;
+  BBlock *block;
+
+  std::array<Use, kMaxOperands> uses;
+  UseList users;
 };
 
 class Label : public Inst {
 public:
-  Label(std::shared_ptr<BBlock> block, const std::string &name)
-      : Inst(OP_label, std::vector<std::shared_ptr<Operand>>(), block, name) {}
+  Label(BBlock *block, SymbolId name)
+      : Inst(OP_label, {}, block, name) {}
 
   void Dump(std::ostream &os) const override;
 };
 
 class PhiInst : public Inst {
 public:
-  PhiInst(std::shared_ptr<Operand> src0, std::shared_ptr<LabelOperand> pred0,
-          std::shared_ptr<Operand> src1, std::shared_ptr<LabelOperand> pred1,
-          std::shared_ptr<BBlock> block, const std::string &name)
-      : Inst(OP_phi,
-             {src0, std::static_pointer_cast<Operand>(pred0), src1,
-              std::static_pointer_cast<Operand>(pred1)},
-             block, name) {}
+  PhiInst(Operand *src0, LabelOperand *pred0, Operand *src1,
+          LabelOperand *pred1, BBlock *block, SymbolId name)
+      : Inst(OP_phi, {src0, pred0, src1, pred1}, block, name) {}
 
   void Dump(std::ostream &os) const override;
 };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <IR/include/Graph.h>
+
+#include <cassert>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Functions of a translation unit. Every function is a Graph with its own
+// arena and IR objects never refer to another function, so different
+// functions can be analyzed and transformed on different threads.
+class Module {
+public:
+  Module() = default;
+
+  // functions are owned by the module
+  Module(const Module &) = delete;
+  Module &operator=(const Module &) = delete;
+
+  Graph &CreateFunction(const std::string &name) {
+    return AddFunction(name, std::make_unique<Graph>());
+  }
+
+  // take ownership of a graph built elsewhere
+  Graph &AddFunction(const std::string &name, std::unique_ptr<Graph> graph) {
+    assert(name2idx.count(name) == 0 && "function redefinition");
+    name2idx.emplace(name, functions.size());
+    names.push_back(name);
+    functions.push_back(std::move(graph));
+    return *functions.back();
+  }
+
+  // functions are numbered densely in creation order
+  size_t GetSize() const { return functions.size(); }
+  Graph &GetFunction(size_t idx) { return *functions[idx]; }
+  const Graph &GetFunction(size_t idx) const { return *functions[idx]; }
+  const std::string &GetName(size_t idx) const { return names[idx]; }
+
+  // nullptr if there is no function with the name
+  Graph *FindFunction(const std::string &name) const {
+    auto it = name2idx.find(name);
+    return it != name2idx.end() ? functions[it->second].get() : nullptr;
+  }
+
+  // every function as '@name:' followed by the dumps of its blocks, the
+  // format read by Parser::ParseModule
+  void Dump(std::ostream &os) const {
+    for (size_t i = 0; i < functions.size(); ++i) {
+      os << "@" << names[i] << ":" << std::endl;
+      for (const auto &block : functions[i]->GetBlocks()) {
+        block->Dump(os);
+      }
+    }
+  }
+
+private:
+  std::vector<std::string> names;
+  std::vector<std::unique_ptr<Graph>> functions;
+  std::unordered_map<std::string, size_t> name2idx;
+};
@@ -1,20 +1,65 @@
 #pragma once
 
-#include <map>
-#include <string>
+#include <cstddef>
+#include <cstdint>
 
 enum Opcode {
-#define DEF_INST(x) OP_##x,
+#define DEF_INST(x, numOperands, flags) OP_##x,
 #include "Op.def"
 #undef DEF_INST
   OP_undef
 };
 
-static std::string ToString(Opcode op) {
-  std::map<Opcode, std::string> op2str = {
-#define DEF_INST(x) {OP_##x, #x},
+enum OpcodeFlags : uint32_t {
+  OPF_none = 0,
+  // ends a basic block
+  OPF_terminator = 1 << 0,
+  // has label operands and transfers control to them
+  OPF_branch = 1 << 1,
+  // can't be removed even if the result is unused
+  OPF_sideEffects = 1 << 2,
+  // defines a value which can be used by other instructions
+  OPF_result = 1 << 3,
+  // first two operands can be swapped
+  OPF_commutative = 1 << 4,
+};
+
+struct OpcodeInfo {
+  const char *name;
+  uint32_t numOperands;
+  uint32_t flags;
+};
+
+// indexed by opcode, built at compile time from Op.def
+inline constexpr OpcodeInfo kOpcodeInfo[] = {
+#define DEF_INST(x, numOperands, flags) {#x, numOperands, flags},
 #include "Op.def"
 #undef DEF_INST
-      {OP_undef, "undef"}};
-  return op2str.at(op);
+    {"undef", 0, OPF_none}};
+
+static_assert(sizeof(kOpcodeInfo) / sizeof(kOpcodeInfo[0]) == OP_undef + 1,
+              "opcode table doesn't match opcodes");
+
+constexpr const OpcodeInfo &GetOpcodeInfo(Opcode op) {
+  return kOpcodeInfo[op];
+}
+
+constexpr const char *ToString(Opcode op) { return GetOpcodeInfo(op).name; }
+
+constexpr uint32_t GetNumOperands(Opcode op) {
+  return GetOpcodeInfo(op).numOperands;
+}
+
+constexpr bool HasFlags(Opcode op, uint32_t flags) {
+  return (GetOpcodeInfo(op).flags & flags) == flags;
+}
+
+constexpr bool IsTerminator(Opcode op) { return HasFlags(op, OPF_terminator); }
+constexpr bool IsBranch(Opcode op) { return HasFlags(op, OPF_branch); }
+constexpr bool HasSideEffects(Opcode op) {
+  return HasFlags(op, OPF_sideEffects);
+}
+constexpr bool HasResult(Opcode op) { return HasFlags(op, OPF_result); }
+constexpr bool IsCommutative(Opcode op) {
+  return HasFlags(op, OPF_commutative);
 }
@@ -1,10 +1,8 @@
 #pragma once
 
-#include <IR/include/Inst.h>
-
 #include <cassert>
+#include <cstdint>
 #include <iostream>
-#include <memory>
 #include <string>
 
 class Inst;
@@ -29,28 +27,32 @@ private:
 
 class LabelOperand final : public Operand {
 public:
-  LabelOperand(std::shared_ptr<Label> label)
-      : Operand(OpKind::kLabel), label(label) {}
-  std::shared_ptr<Label> GetLabel() const { return label; }
+  LabelOperand(Label *label) : Operand(OpKind::kLabel), label(label) {}
+  Label *GetLabel() const { return label; }
 
   void Dump(std::ostream &os) const override;
 
 private:
-  std::shared_ptr<Label> label;
+  Label *label;
 };
 
 class InstOperand final : public Operand {
 public:
-  InstOperand(std::shared_ptr<Inst> inst)
-      : Operand(OpKind::kInst), inst(inst) {}
-  std::shared_ptr<Inst> GetInst() { return inst; }
+  InstOperand(Inst *inst) : Operand(OpKind::kInst), inst(inst) {}
+  Inst *GetInst() const { return inst; }
 
   void Dump(std::ostream &os) const override;
 
 private:
-  std::shared_ptr<Inst> inst;
+  Inst *inst;
 };
 
+// instruction of a result operand, such as the ones IRBuilder returns
+inline Inst *GetInst(const Operand *opnd) {
+  assert(opnd->IsInst() && "instruction operand expected");
+  return static_cast<const InstOperand *>(opnd)->GetInst();
+}
+
 class ImmOperand final : public Operand {
 public:
   ImmOperand(uint64_t value) : Operand(OpKind::kImm), value(value) {}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <IR/include/Module.h>
+#include <support/StringMap.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads the text printed by BBlock::Dump and Module::Dump:
+//
+//   @function:
+//   %block:
+//     name = opcode operand...
+//     name = phi [ value block ] [ value block ]
+//     opcode operand...
+//
+// Operands are immediates, names of instructions or names of blocks. The
+// text is scanned once, tokens are views into it. Names are resolved in a
+// fixup pass at the end of every function, so they may refer forward.
+// Edges are rebuilt from terminators: 'jmp' goes to its target, 'jeq' and
+// 'jne' fall through to the next block and go to their target, a block
+// without a terminator falls through. Instructions printed without a name
+// get the name IRBuilder would give them.
+class Parser {
+public:
+  explicit Parser(std::string_view text) : text(text) {}
+
+  // blocks of one function into an empty graph, false on a syntax error
+  bool ParseGraph(Graph &graph);
+  // nullptr on a syntax error
+  std::unique_ptr<Module> ParseModule();
+
+  // "line N: message" of the first error
+  const std::string &GetError() const { return error; }
+
+private:
+  // name operand to resolve at the end of the function
+  struct Fixup {
+    Inst *inst;
+    uint32_t operandNo;
+    std::string_view name;
+    size_t line;
+  };
+
+  struct Value {
+    Inst *inst = nullptr;
+    // created on the first use, shared by all users
+    Operand *operand = nullptr;
+  };
+
+  // false at the end of the text, 'line' has no line break
+  bool NextLine(std::string_view &line);
+  static std::string_view NextToken(std::string_view &line);
+
+  bool ParseFunction(Graph &graph);
+  bool ParseBlock(std::string_view token, Graph &graph);
+  bool ParseInst(std::string_view line, Graph &graph);
+  bool ParseOperand(std::string_view token, Inst *inst, uint32_t operandNo,
+                    Graph &graph);
+  bool Resolve(Graph &graph);
+  void CreateEdges(Graph &graph);
+
+  bool Error(size_t line, const std::string &message);
+
+private:
+  std::string_view text;
+  size_t pos = 0;
+  size_t lineNo = 0;
+  std::string error;
+
+  // per function
+  BBlockPtr block = nullptr;
+  StringMap<BBlockPtr> blocks;
+  StringMap<Value> values;
+  std::vector<LabelOperand *> labels;
+  std::vector<Fixup> fixups;
+};
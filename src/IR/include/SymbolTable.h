@@ -0,0 +1,61 @@
+#pragma once
+
+#include <support/Arena.h>
+#include <support/StringMap.h>
+
+#include <cassert>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using SymbolId = uint32_t;
+
+// Names of the blocks and instructions of a function, referred to by dense
+// 32-bit ids. A symbol is either interned text, equal texts get the same
+// id, or a base symbol followed by a number, the way IRBuilder names
+// instructions. Numbered symbols are never built as strings, names are
+// materialized only for printing.
+class SymbolTable {
+public:
+  // interned texts are copied to 'arena'
+  explicit SymbolTable(Arena &arena) : arena(arena) {}
+
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+
+  SymbolId Intern(std::string_view name);
+  // fresh symbol printed as the name of 'base' followed by 'number'
+  SymbolId CreateNumbered(SymbolId base, uint32_t number) {
+    assert(base < symbols.size() && "invalid symbol");
+    symbols.push_back({{}, base, number});
+    return symbols.size() - 1;
+  }
+
+  size_t GetSize() const { return symbols.size(); }
+
+  // text of an interned symbol, empty for numbered symbols
+  std::string_view GetText(SymbolId id) const {
+    assert(id < symbols.size() && "invalid symbol");
+    return symbols[id].text;
+  }
+
+  std::string GetName(SymbolId id) const;
+  void Dump(std::ostream &os, SymbolId id) const;
+
+private:
+  static constexpr SymbolId kNoBase = ~SymbolId(0);
+
+  struct Symbol {
+    std::string_view text;
+    SymbolId base;
+    uint32_t number;
+  };
+
+private:
+  Arena &arena;
+  std::vector<Symbol> symbols;
+  // keys are views of the texts in the arena
+  StringMap<SymbolId> interned;
+};
@@ -1,9 +1,43 @@
 #include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
 
-BBlock::BBlock(const std::string &name) : name(name) {}
+BBlock::BBlock(Graph *graph, std::string_view name)
+    : graph(graph), name(graph->GetSymbols().Intern(name)) {}
+
+std::string BBlock::GetName() const {
+  return graph->GetSymbols().GetName(name);
+}
+
+void BBlock::DumpDot(std::ostream &os) const {
+  graph->GetSymbols().Dump(os, name);
+}
+
+BBlock::PhiIterator BBlock::PhiEnd() const {
+  auto it = instList.begin();
+  while (it != instList.end() && (*it)->IsPhi()) {
+    ++it;
+  }
+  return it;
+}
+
+BBlock::Iterator BBlock::InsertBefore(Iterator pos, Inst *inst) {
+  assert(!inst->IsPhi() || pos == InstBegin() || (*std::prev(pos))->IsPhi());
+  assert(inst->IsPhi() || pos == InstEnd() || !(*pos)->IsPhi());
+  inst->block = this;
+  return instList.Insert(pos, inst);
+}
+
+void BBlock::PushPhi(PhiInst *phi) { InsertBefore(PhiEnd(), phi); }
+
+BBlock::Iterator BBlock::Erase(Inst *inst) {
+  assert(inst->GetBBlock() == this && "instruction from another block");
+  return instList.Remove(inst);
+}
 
 void BBlock::Dump(std::ostream &os) const {
-  os << "%" << name << ":" << std::endl;
+  os << "%";
+  DumpDot(os);
+  os << ":" << std::endl;
 
   for (auto i : instList) {
     os << "  ";
@@ -12,69 +46,82 @@ void BBlock::Dump(std::ostream &os) const {
   }
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateImm(uint64_t val) {
-  return std::make_shared<ImmOperand>(val);
+Operand *Inserter::CreateInstOperand(Inst *inst) {
+  return block->GetGraph()->GetArena().Create<InstOperand>(inst);
+}
+
+Arena &IRBuilder::GetArena() { return GetBBlock()->GetGraph()->GetArena(); }
+
+SymbolId IRBuilder::CreateInstName() {
+  BBlockPtr block = inserter.GetBBlock();
+  return block->GetGraph()->GetSymbols().CreateNumbered(
+      block->GetSymbol(), inserter.GetInstCount());
+}
+
+Operand *IRBuilder::CreateImm(uint64_t val) {
+  return GetArena().Create<ImmOperand>(val);
+}
+
+Operand *IRBuilder::CreateInstOperand(Inst *inst) {
+  return GetArena().Create<InstOperand>(inst);
+}
+
+LabelOperand *IRBuilder::CreateLabel(BBlockPtr target) {
+  auto label = GetArena().Create<Label>(target, target->GetSymbol());
+  return GetArena().Create<LabelOperand>(label);
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateAssign(std::shared_ptr<Operand> src) {
+Operand *IRBuilder::CreateAssign(Operand *src) {
   assert((src->IsImm() || src->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_assign, {src}, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_assign, Inst::OperandList{src}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateAdd(std::shared_ptr<Operand> src0,
-                                              std::shared_ptr<Operand> src1) {
+Operand *IRBuilder::CreateAdd(Operand *src0, Operand *src1) {
   assert((src0->IsImm() || src0->IsInst()) &&
          (src1->IsImm() || src1->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_add, {src0, src1}, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_add, Inst::OperandList{src0, src1}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateMul(std::shared_ptr<Operand> src0,
-                                              std::shared_ptr<Operand> src1) {
+Operand *IRBuilder::CreateMul(Operand *src0, Operand *src1) {
   assert((src0->IsImm() || src0->IsInst()) &&
          (src1->IsImm() || src1->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_mul, {src0, src1}, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_mul, Inst::OperandList{src0, src1}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateCmp(std::shared_ptr<Operand> src0,
-                                              std::shared_ptr<Operand> src1) {
+Operand *IRBuilder::CreateCmp(Operand *src0, Operand *src1) {
   assert((src0->IsImm() || src0->IsInst()) &&
          (src1->IsImm() || src1->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_cmp, {src0, src1}, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_cmp, Inst::OperandList{src0, src1}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand>
-IRBuilder::CreateJeq(std::shared_ptr<Operand> src0,
-                     std::shared_ptr<Operand> src1,
-                     std::shared_ptr<LabelOperand> label) {
+Operand *IRBuilder::CreateJeq(Operand *src0, Operand *src1,
+                              LabelOperand *label) {
   assert((src0->IsImm() || src0->IsInst()) &&
          (src1->IsImm() || src1->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_jeq, {src0, src1, std::static_pointer_cast<Operand>(label)},
-           inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(
+      GetArena().Create<Inst>(OP_jeq, Inst::OperandList{src0, src1, label},
+                              GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand>
-IRBuilder::CreateJmp(std::shared_ptr<LabelOperand> label) {
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_jmp, {std::static_pointer_cast<Operand>(label)},
-           inserter.GetBBlock(), CreateInstName())));
+Operand *IRBuilder::CreateJmp(LabelOperand *label) {
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_jmp, Inst::OperandList{label}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand> IRBuilder::CreateRet(std::shared_ptr<Operand> ret) {
+Operand *IRBuilder::CreateRet(Operand *ret) {
   assert((ret->IsImm() || ret->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<Inst>(
-      Inst(OP_ret, {ret}, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<Inst>(
+      OP_ret, Inst::OperandList{ret}, GetBBlock(), CreateInstName()));
 }
 
-std::shared_ptr<Operand> IRBuilder::CreatePhi(
-    std::shared_ptr<Operand> src0, std::shared_ptr<LabelOperand> pred0,
-    std::shared_ptr<Operand> src1, std::shared_ptr<LabelOperand> pred1) {
+Operand *IRBuilder::CreatePhi(Operand *src0, LabelOperand *pred0,
+                              Operand *src1, LabelOperand *pred1) {
   assert((src0->IsImm() || src0->IsInst()) &&
          (src1->IsImm() || src1->IsInst()) && "invalid arguments");
-  return inserter.Insert(std::make_shared<PhiInst>(PhiInst(
-      src0, pred0, src1, pred1, inserter.GetBBlock(), CreateInstName())));
+  return inserter.Insert(GetArena().Create<PhiInst>(
+      src0, pred0, src1, pred1, GetBBlock(), CreateInstName()));
 }
@@ -0,0 +1,449 @@
+#include <IR/include/BinaryFormat.h>
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+uint64_t AlignUp(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+class BinaryWriter {
+public:
+  BinaryWriter(std::ostream &os) : os(os) {}
+
+  void Write(const Module &module);
+
+private:
+  using FunctionRecord = BinaryModule::FunctionRecord;
+  using BlockRecord = BinaryModule::BlockRecord;
+  using InstRecord = BinaryModule::InstRecord;
+
+  template <class T>
+  void Emit(const T *records, size_t n) {
+    os.write(reinterpret_cast<const char *>(records), sizeof(T) * n);
+    offset += sizeof(T) * n;
+  }
+  template <class T>
+  void Emit(const T &record) {
+    Emit(&record, 1);
+  }
+  void Pad() {
+    static constexpr char kZeros[8] = {};
+    uint64_t aligned = AlignUp(offset);
+    os.write(kZeros, aligned - offset);
+    offset = aligned;
+  }
+
+  // 'name' must outlive the writer
+  uint32_t Intern(std::string_view name) {
+    auto [it, inserted] = stringIds.try_emplace(name, strings.size());
+    if (inserted) {
+      strings.push_back(name);
+    }
+    return it->second;
+  }
+  // numbered symbols are materialized once per function
+  uint32_t Intern(const SymbolTable &symbols, SymbolId id) {
+    uint32_t &stringId = symbolIds[id];
+    if (stringId == kNoString) {
+      std::string_view text = symbols.GetText(id);
+      if (text.empty()) {
+        text = names.emplace_back(symbols.GetName(id));
+      }
+      stringId = Intern(text);
+    }
+    return stringId;
+  }
+
+  // sizes and offsets of the function sections, names are not interned
+  FunctionRecord Layout(const Graph &graph);
+  void WriteFunction(const Graph &graph);
+  void WriteStrings();
+
+private:
+  static constexpr uint32_t kNoString = ~uint32_t(0);
+
+  std::ostream &os;
+  uint64_t offset = 0;
+
+  std::unordered_map<std::string_view, uint32_t> stringIds;
+  std::vector<std::string_view> strings;
+  // materialized names, the deque keeps them in place
+  std::deque<std::string> names;
+
+  // per function
+  std::vector<uint32_t> symbolIds;
+  std::unordered_map<const Inst *, uint32_t> instIds;
+  std::vector<uint64_t> imms;
+  std::vector<uint32_t> edges;
+};
+
+BinaryModule::FunctionRecord BinaryWriter::Layout(const Graph &graph) {
+  FunctionRecord func = {};
+  func.numBlocks = graph.GetSize();
+  for (const auto &block : graph.GetBlocks()) {
+    func.numInsts += block->GetInstCount();
+    func.numEdges +=
+        block->GetSuccessors().size() + block->GetPredessors().size();
+    for (auto inst : block->GetInstList()) {
+      for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+        func.numImms += inst->GetOperand(i)->IsImm();
+      }
+    }
+  }
+  func.blocksOffset = offset;
+  func.instsOffset = func.blocksOffset + sizeof(BlockRecord) * func.numBlocks;
+  func.edgesOffset = func.instsOffset + sizeof(InstRecord) * func.numInsts;
+  func.immsOffset =
+      AlignUp(func.edgesOffset + sizeof(uint32_t) * func.numEdges);
+  offset = func.immsOffset + sizeof(uint64_t) * func.numImms;
+  return func;
+}
+
+void BinaryWriter::Write(const Module &module) {
+  BinaryModule::Header header = {};
+  std::memcpy(header.magic, BinaryModule::kMagic, sizeof(header.magic));
+  header.version = BinaryModule::kVersion;
+  header.numFunctions = module.GetSize();
+  header.functionsOffset = sizeof(header);
+
+  // offsets of everything are known before the first byte is written
+  offset = header.functionsOffset + sizeof(FunctionRecord) * module.GetSize();
+  std::vector<FunctionRecord> functions;
+  functions.reserve(module.GetSize());
+  for (size_t i = 0; i < module.GetSize(); ++i) {
+    functions.push_back(Layout(module.GetFunction(i)));
+    functions.back().name = Intern(module.GetName(i));
+  }
+  header.stringsOffset = offset;
+
+  offset = 0;
+  Emit(header);
+  Emit(functions.data(), functions.size());
+  for (size_t i = 0; i < module.GetSize(); ++i) {
+    assert(offset == functions[i].blocksOffset && "layout mismatch");
+    WriteFunction(module.GetFunction(i));
+  }
+  assert(offset == header.stringsOffset && "layout mismatch");
+  WriteStrings();
+}
+
+void BinaryWriter::WriteFunction(const Graph &graph) {
+  const SymbolTable &symbols = graph.GetSymbols();
+  symbolIds.assign(symbols.GetSize(), kNoString);
+  instIds.clear();
+  imms.clear();
+  edges.clear();
+
+  uint32_t numInsts = 0;
+  for (const auto &block : graph.GetBlocks()) {
+    BlockRecord record;
+    record.name = Intern(symbols, block->GetSymbol());
+    record.firstInst = numInsts;
+    record.numInsts = block->GetInstCount();
+    record.firstEdge = edges.size();
+    record.numSuccs = block->GetSuccessors().size();
+    record.numPreds = block->GetPredessors().size();
+    Emit(record);
+
+    for (const auto &succ : block->GetSuccessors()) {
+      edges.push_back(succ->GetId());
+    }
+    for (const auto &pred : block->GetPredessors()) {
+      edges.push_back(pred->GetId());
+    }
+    // operands may refer to instructions further down
+    for (auto inst : block->GetInstList()) {
+      instIds.emplace(inst, numInsts++);
+    }
+  }
+
+  for (const auto &block : graph.GetBlocks()) {
+    for (auto inst : block->GetInstList()) {
+      InstRecord record = {};
+      record.opcode = inst->GetOpcode();
+      record.numOperands = inst->GetNumOperands();
+      record.name = Intern(symbols, inst->GetSymbol());
+      for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+        Operand *opnd = inst->GetOperand(i);
+        uint32_t index;
+        if (opnd->IsImm()) {
+          index = imms.size();
+          imms.push_back(static_cast<ImmOperand *>(opnd)->GetValue());
+        } else if (opnd->IsInst()) {
+          index = instIds.at(static_cast<InstOperand *>(opnd)->GetInst());
+        } else {
+          index = static_cast<LabelOperand *>(opnd)
+                      ->GetLabel()
+                      ->GetBBlock()
+                      ->GetId();
+        }
+        record.operands[i] = BinaryModule::EncodeOperand(
+            opnd->IsImm()    ? Operand::kImm
+            : opnd->IsInst() ? Operand::kInst
+                             : Operand::kLabel,
+            index);
+      }
+      Emit(record);
+    }
+  }
+
+  Emit(edges.data(), edges.size());
+  Pad();
+  Emit(imms.data(), imms.size());
+}
+
+void BinaryWriter::WriteStrings() {
+  BinaryModule::StringTable table = {};
+  table.numStrings = strings.size();
+  std::vector<uint32_t> offsets;
+  offsets.reserve(strings.size() + 1);
+  for (const auto &str : strings) {
+    offsets.push_back(table.dataSize);
+    table.dataSize += str.size() + 1;
+  }
+  offsets.push_back(table.dataSize);
+
+  Emit(table);
+  Emit(offsets.data(), offsets.size());
+  for (const auto &str : strings) {
+    os.write(str.data(), str.size());
+    os.put('\0');
+  }
+  offset += table.dataSize;
+}
+
+class BinaryReader {
+public:
+  BinaryReader(const BinaryModule &image) : image(image) {}
+
+  void ReadFunction(const BinaryModule::FunctionRecord &func, Graph &graph);
+
+private:
+  const BinaryModule &image;
+
+  // per function, operands are shared by all users
+  std::vector<BBlockPtr> blocks;
+  std::vector<Inst *> insts;
+  std::vector<Operand *> instOperands;
+  std::vector<LabelOperand *> labels;
+};
+
+void BinaryReader::ReadFunction(const BinaryModule::FunctionRecord &func,
+                                Graph &graph) {
+  Arena &arena = graph.GetArena();
+  SymbolTable &symbols = graph.GetSymbols();
+  const BinaryModule::BlockRecord *blockRecords = image.GetBlocks(func);
+  const BinaryModule::InstRecord *instRecords = image.GetInsts(func);
+  const uint32_t *edges = image.GetEdges(func);
+  const uint64_t *imms = image.GetImms(func);
+
+  blocks.clear();
+  for (uint32_t i = 0; i < func.numBlocks; ++i) {
+    blocks.push_back(graph.CreateBlock(image.GetString(blockRecords[i].name)));
+  }
+
+  insts.clear();
+  for (uint32_t i = 0; i < func.numBlocks; ++i) {
+    const auto &record = blockRecords[i];
+    BBlockPtr block = blocks[i];
+    const uint32_t *blockEdges = edges + record.firstEdge;
+    for (uint32_t e = 0; e < record.numSuccs; ++e) {
+      block->AddSucc(blocks[blockEdges[e]]);
+    }
+    for (uint32_t e = record.numSuccs; e < record.numSuccs + record.numPreds;
+         ++e) {
+      block->AddPred(blocks[blockEdges[e]]);
+    }
+    assert(record.firstInst == insts.size() && "instructions out of order");
+    for (uint32_t j = 0; j < record.numInsts; ++j) {
+      const auto &instRecord = instRecords[record.firstInst + j];
+      auto op = static_cast<Opcode>(instRecord.opcode);
+      assert(op < OP_undef && instRecord.numOperands == GetNumOperands(op) &&
+             "invalid instruction");
+      SymbolId name = symbols.Intern(image.GetString(instRecord.name));
+      Inst *inst = Inst::Create(arena, op, block, name);
+      block->PushBack(inst);
+      insts.push_back(inst);
+    }
+  }
+  assert(insts.size() == func.numInsts && "instruction count mismatch");
+
+  instOperands.assign(insts.size(), nullptr);
+  labels.assign(blocks.size(), nullptr);
+  for (uint32_t i = 0; i < func.numInsts; ++i) {
+    const auto &record = instRecords[i];
+    for (uint32_t j = 0; j < record.numOperands; ++j) {
+      BinaryModule::OperandRecord opnd = record.operands[j];
+      uint32_t index = BinaryModule::GetOperandIndex(opnd);
+      Operand *operand = nullptr;
+      switch (BinaryModule::GetOperandKind(opnd)) {
+      case Operand::kImm:
+        assert(index < func.numImms && "invalid immediate");
+        operand = arena.Create<ImmOperand>(imms[index]);
+        break;
+      case Operand::kInst:
+        assert(index < insts.size() && "invalid instruction operand");
+        if (!instOperands[index]) {
+          instOperands[index] = arena.Create<InstOperand>(insts[index]);
+        }
+        operand = instOperands[index];
+        break;
+      case Operand::kLabel:
+        assert(index < blocks.size() && "invalid label");
+        if (!labels[index]) {
+          Label *label =
+              arena.Create<Label>(blocks[index], blocks[index]->GetSymbol());
+          labels[index] = arena.Create<LabelOperand>(label);
+        }
+        operand = labels[index];
+        break;
+      default:
+        assert(false && "invalid operand kind");
+      }
+      insts[i]->SetOperand(j, operand);
+    }
+  }
+}
+} // namespace
+
+BinaryModule::BinaryModule(const void *data, size_t size)
+    : data(static_cast<const char *>(data)), size(size) {
+  valid = Validate();
+}
+
+bool BinaryModule::Validate() {
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0 || size < sizeof(Header)) {
+    return false;
+  }
+  header = At<Header>(0);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->version != kVersion) {
+    return false;
+  }
+
+  auto fits = [this](uint64_t offset, uint64_t bytes) {
+    return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+  };
+  if (!fits(header->functionsOffset,
+            sizeof(FunctionRecord) * uint64_t(header->numFunctions)) ||
+      !fits(header->stringsOffset, sizeof(StringTable))) {
+    return false;
+  }
+  functions = At<FunctionRecord>(header->functionsOffset);
+  for (uint32_t i = 0; i < header->numFunctions; ++i) {
+    const FunctionRecord &func = functions[i];
+    if (!fits(func.blocksOffset,
+              sizeof(BlockRecord) * uint64_t(func.numBlocks)) ||
+        !fits(func.instsOffset, sizeof(InstRecord) * uint64_t(func.numInsts)) ||
+        !fits(func.edgesOffset, sizeof(uint32_t) * uint64_t(func.numEdges)) ||
+        !fits(func.immsOffset, sizeof(uint64_t) * uint64_t(func.numImms))) {
+      return false;
+    }
+  }
+
+  strings = At<StringTable>(header->stringsOffset);
+  uint64_t offsetsOffset = header->stringsOffset + sizeof(StringTable);
+  uint64_t offsetsSize = sizeof(uint32_t) * (uint64_t(strings->numStrings) + 1);
+  if (!fits(offsetsOffset, offsetsSize) ||
+      strings->dataSize > size - offsetsOffset - offsetsSize) {
+    return false;
+  }
+  stringOffsets = At<uint32_t>(offsetsOffset);
+  stringData = data + offsetsOffset + offsetsSize;
+  if (!ValidateStrings()) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header->numFunctions; ++i) {
+    if (!ValidateFunction(functions[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BinaryModule::ValidateStrings() const {
+  // every string is inside of the data and NUL-terminated
+  if (stringOffsets[0] != 0 ||
+      stringOffsets[strings->numStrings] != strings->dataSize) {
+    return false;
+  }
+  for (uint32_t i = 0; i < strings->numStrings; ++i) {
+    uint32_t end = stringOffsets[i + 1];
+    if (end <= stringOffsets[i] || end > strings->dataSize ||
+        stringData[end - 1] != '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BinaryModule::ValidateFunction(const FunctionRecord &func) const {
+  if (func.name >= strings->numStrings) {
+    return false;
+  }
+
+  const BlockRecord *blocks = GetBlocks(func);
+  const uint32_t *edges = GetEdges(func);
+  // instructions of the blocks follow each other
+  uint64_t numInsts = 0;
+  for (uint32_t i = 0; i < func.numBlocks; ++i) {
+    const BlockRecord &block = blocks[i];
+    uint64_t edgesEnd =
+        uint64_t(block.firstEdge) + block.numSuccs + block.numPreds;
+    if (block.name >= strings->numStrings || block.firstInst != numInsts ||
+        block.numSuccs > 2 || edgesEnd > func.numEdges) {
+      return false;
+    }
+    for (uint64_t e = block.firstEdge; e < edgesEnd; ++e) {
+      if (edges[e] >= func.numBlocks) {
+        return false;
+      }
+    }
+    numInsts += block.numInsts;
+  }
+  if (numInsts != func.numInsts) {
+    return false;
+  }
+
+  // number of operand targets by kind, the fourth kind doesn't exist
+  const uint32_t limits[4] = {func.numImms, func.numInsts, func.numBlocks, 0};
+  const InstRecord *insts = GetInsts(func);
+  for (uint32_t i = 0; i < func.numInsts; ++i) {
+    const InstRecord &inst = insts[i];
+    auto op = static_cast<Opcode>(inst.opcode);
+    if (inst.name >= strings->numStrings || op >= OP_undef ||
+        inst.numOperands != GetNumOperands(op)) {
+      return false;
+    }
+    for (uint32_t j = 0; j < inst.numOperands; ++j) {
+      OperandRecord opnd = inst.operands[j];
+      if (GetOperandIndex(opnd) >= limits[GetOperandKind(opnd)]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void WriteBinary(const Module &module, std::ostream &os) {
+  BinaryWriter(os).Write(module);
+}
+
+std::unique_ptr<Module> ReadBinary(const BinaryModule &image) {
+  if (!image.IsValid()) {
+    return nullptr;
+  }
+  auto module = std::make_unique<Module>();
+  BinaryReader reader(image);
+  for (uint32_t i = 0; i < image.GetNumFunctions(); ++i) {
+    const auto &func = image.GetFunction(i);
+    Graph &graph =
+        module->CreateFunction(std::string(image.GetString(func.name)));
+    reader.ReadFunction(func, graph);
+  }
+  return module;
+}
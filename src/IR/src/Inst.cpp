@@ -1,26 +1,109 @@
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
 #include <IR/include/Inst.h>
+#include <support/Arena.h>
 
 #include <algorithm>
 
+Inst *Inst::Create(Arena &arena, Opcode op, BBlock *block, SymbolId name) {
+  switch (::GetNumOperands(op)) {
+  case 0:
+    return arena.Create<Inst>(op, OperandList{}, block, name);
+  case 1:
+    return arena.Create<Inst>(op, OperandList{nullptr}, block, name);
+  case 2:
+    return arena.Create<Inst>(op, OperandList{nullptr, nullptr}, block, name);
+  case 3:
+    return arena.Create<Inst>(op, OperandList{nullptr, nullptr, nullptr},
+                              block, name);
+  default:
+    assert(op == OP_phi && "unknown opcode");
+    return arena.Create<PhiInst>(nullptr, nullptr, nullptr, nullptr, block,
+                                 name);
+  }
+}
+
+std::string Inst::GetName() const {
+  return block->GetGraph()->GetSymbols().GetName(name);
+}
+
+void Inst::SetName(std::string_view newName) {
+  name = block->GetGraph()->GetSymbols().Intern(newName);
+}
+
+void Inst::DumpName(std::ostream &os) const {
+  block->GetGraph()->GetSymbols().Dump(os, name);
+}
+
+void Inst::EraseFromBBlock() { block->Erase(this); }
+
+void Inst::MoveBefore(Inst *pos) {
+  if (IsLinked()) {
+    block->Erase(this);
+  }
+  pos->GetBBlock()->InsertBefore(BBlock::InstList::IteratorTo(pos), this);
+}
+
+void Inst::MoveToEnd(BBlock *dst) {
+  if (IsLinked()) {
+    block->Erase(this);
+  }
+  dst->PushBack(this);
+}
+
+void Inst::LinkUse(size_t numOp) {
+  Operand *opnd = sources[numOp];
+  if (opnd && opnd->IsInst()) {
+    static_cast<InstOperand *>(opnd)->GetInst()->users.PushBack(&uses[numOp]);
+  }
+}
+
+void Inst::UnlinkUse(size_t numOp) {
+  Operand *opnd = sources[numOp];
+  if (opnd && opnd->IsInst() && uses[numOp].IsLinked()) {
+    static_cast<InstOperand *>(opnd)->GetInst()->users.Remove(&uses[numOp]);
+  }
+}
+
+void Inst::ReplaceAllUsesWith(Operand *opnd) {
+  assert(!(opnd->IsInst() &&
+           static_cast<InstOperand *>(opnd)->GetInst() == this) &&
+         "replacing uses with itself");
+  while (!users.empty()) {
+    Use *use = users.Front();
+    use->GetUser()->SetOperand(use->GetOperandNo(), opnd);
+  }
+}
+
+void Inst::DropAllReferences() {
+  for (size_t i = 0; i < numSources; ++i) {
+    UnlinkUse(i);
+  }
+}
+
 void Inst::Dump(std::ostream &os) const {
-  if (!IsLabel() && !IsRet() && !IsJmp() && !IsJeq()) {
-    os << name << " = ";
+  if (HasResult()) {
+    DumpName(os);
+    os << " = ";
   }
 
   os << ToString(op);
 
   if (IsLabel()) {
-    os << " " << GetBBlock()->GetName();
+    os << " ";
+    GetBBlock()->DumpDot(os);
   } else {
-    std::for_each(sources.begin(), sources.end(), [&os](const auto &src) {
-      os << " ";
-      src->Dump(os);
-    });
+    std::for_each(sources.begin(), sources.begin() + numSources,
+                  [&os](const auto &src) {
+                    os << " ";
+                    src->Dump(os);
+                  });
   }
 }
 
 void PhiInst::Dump(std::ostream &os) const {
-  os << GetName() << " = ";
+  DumpName(os);
+  os << " = ";
   os << ToString(GetOpcode());
   os << " [ ";
   GetOperand(0)->Dump(os);
@@ -35,5 +118,6 @@ void PhiInst::Dump(std::ostream &os) const {
 }
 
 void Label::Dump(std::ostream &os) const {
-  os << ToString(GetOpcode()) << " " << GetName();
+  os << ToString(GetOpcode()) << " ";
+  DumpName(os);
 }
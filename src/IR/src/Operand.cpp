@@ -1,7 +1,8 @@
+#include <IR/include/Inst.h>
 #include <IR/include/Operand.h>
 
 void ImmOperand::Dump(std::ostream &os) const { os << value; }
 
-void InstOperand::Dump(std::ostream &os) const { os << inst->GetName(); }
+void InstOperand::Dump(std::ostream &os) const { inst->DumpName(os); }
 
-void LabelOperand::Dump(std::ostream &os) const { os << label->GetName(); }
+void LabelOperand::Dump(std::ostream &os) const { label->DumpName(os); }
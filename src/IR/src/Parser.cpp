@@ -0,0 +1,278 @@
+#include <IR/include/Parser.h>
+
+#include <charconv>
+
+namespace {
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// OP_undef if 'name' is not an opcode
+Opcode ParseOpcode(std::string_view name) {
+  static const StringMap<Opcode> opcodes = [] {
+    StringMap<Opcode> opcodes;
+    for (size_t op = 0; op < OP_undef; ++op) {
+      opcodes.Insert(ToString(static_cast<Opcode>(op)),
+                     static_cast<Opcode>(op));
+    }
+    return opcodes;
+  }();
+  const Opcode *op = opcodes.Find(name);
+  return op ? *op : OP_undef;
+}
+
+// operands naming blocks: the targets of branches, the predecessors of phis
+bool IsLabelOperand(Opcode op, uint32_t operandNo) {
+  if (op == OP_phi) {
+    return operandNo % 2 == 1;
+  }
+  return IsBranch(op) && operandNo + 1 == GetNumOperands(op);
+}
+} // namespace
+
+bool Parser::NextLine(std::string_view &line) {
+  if (pos == text.size()) {
+    return false;
+  }
+  size_t end = text.find('\n', pos);
+  if (end == std::string_view::npos) {
+    end = text.size();
+  }
+  line = text.substr(pos, end - pos);
+  pos = end == text.size() ? end : end + 1;
+  ++lineNo;
+  return true;
+}
+
+std::string_view Parser::NextToken(std::string_view &line) {
+  size_t begin = 0;
+  while (begin < line.size() && IsSpace(line[begin])) {
+    ++begin;
+  }
+  size_t end = begin;
+  while (end < line.size() && !IsSpace(line[end])) {
+    ++end;
+  }
+  std::string_view token = line.substr(begin, end - begin);
+  line.remove_prefix(end);
+  return token;
+}
+
+bool Parser::Error(size_t line, const std::string &message) {
+  error = "line " + std::to_string(line) + ": " + message;
+  return false;
+}
+
+bool Parser::ParseGraph(Graph &graph) {
+  assert(graph.GetSize() == 0 && "graph is not empty");
+  if (!ParseFunction(graph)) {
+    return false;
+  }
+  if (pos != text.size()) {
+    return Error(lineNo + 1, "function header in a graph");
+  }
+  return true;
+}
+
+std::unique_ptr<Module> Parser::ParseModule() {
+  auto module = std::make_unique<Module>();
+  std::string_view line;
+  while (NextLine(line)) {
+    std::string_view token = NextToken(line);
+    if (token.empty()) {
+      continue;
+    }
+    if (token.size() < 3 || token.front() != '@' || token.back() != ':' ||
+        !NextToken(line).empty()) {
+      Error(lineNo, "expected '@function:'");
+      return nullptr;
+    }
+    std::string name(token.substr(1, token.size() - 2));
+    if (module->FindFunction(name)) {
+      Error(lineNo, "function '" + name + "' redefinition");
+      return nullptr;
+    }
+    if (!ParseFunction(module->CreateFunction(name))) {
+      return nullptr;
+    }
+  }
+  return module;
+}
+
+bool Parser::ParseFunction(Graph &graph) {
+  block = nullptr;
+  blocks.Clear();
+  values.Clear();
+  fixups.clear();
+
+  std::string_view line;
+  size_t lineStart = pos;
+  while (NextLine(line)) {
+    std::string_view rest = line;
+    std::string_view token = NextToken(rest);
+    if (token.empty()) {
+      lineStart = pos;
+      continue;
+    }
+    if (token.front() == '@') {
+      // the next function starts, leave its header to the caller
+      pos = lineStart;
+      --lineNo;
+      break;
+    }
+    bool parsed = token.front() == '%' ? ParseBlock(token, graph) &&
+                                             NextToken(rest).empty()
+                                       : ParseInst(line, graph);
+    if (!parsed) {
+      return error.empty() ? Error(lineNo, "unexpected token") : false;
+    }
+    lineStart = pos;
+  }
+
+  if (!Resolve(graph)) {
+    return false;
+  }
+  CreateEdges(graph);
+  return true;
+}
+
+bool Parser::ParseBlock(std::string_view token, Graph &graph) {
+  if (token.size() < 3 || token.back() != ':') {
+    return Error(lineNo, "expected '%block:'");
+  }
+  std::string_view name = token.substr(1, token.size() - 2);
+  if (blocks.Find(name)) {
+    return Error(lineNo, "block '" + std::string(name) + "' redefinition");
+  }
+  block = graph.CreateBlock(name);
+  blocks.Insert(name, block);
+  return true;
+}
+
+bool Parser::ParseInst(std::string_view line, Graph &graph) {
+  if (!block) {
+    return Error(lineNo, "instruction outside of a block");
+  }
+  std::string_view name;
+  std::string_view token = NextToken(line);
+  std::string_view rest = line;
+  if (NextToken(rest) == "=") {
+    name = token;
+    line = rest;
+    token = NextToken(line);
+  }
+
+  Opcode op = ParseOpcode(token);
+  if (op == OP_undef || op == OP_label) {
+    return Error(lineNo, "unknown opcode '" + std::string(token) + "'");
+  }
+  if (name.empty() == HasResult(op)) {
+    return Error(lineNo, HasResult(op) ? "result name expected"
+                                       : "instruction has no result");
+  }
+  if (op == OP_phi && block->GetInstCount() != 0 &&
+      !block->GetInstList().Back()->IsPhi()) {
+    return Error(lineNo, "phi after a non-phi instruction");
+  }
+
+  SymbolTable &symbols = graph.GetSymbols();
+  Inst *inst = Inst::Create(
+      graph.GetArena(), op, block,
+      name.empty()
+          ? symbols.CreateNumbered(block->GetSymbol(), block->GetInstCount())
+          : symbols.Intern(name));
+  block->PushBack(inst);
+  if (!name.empty() && !values.Insert(name, Value{inst, nullptr}).second) {
+    return Error(lineNo, "value '" + std::string(name) + "' redefinition");
+  }
+
+  // phi operands are grouped as '[ value block ]'
+  for (uint32_t i = 0; i < GetNumOperands(op); ++i) {
+    if (op == OP_phi && i % 2 == 0 && NextToken(line) != "[") {
+      return Error(lineNo, "expected '['");
+    }
+    token = NextToken(line);
+    if (token.empty()) {
+      return Error(lineNo, "expected operand");
+    }
+    if (!ParseOperand(token, inst, i, graph)) {
+      return false;
+    }
+    if (op == OP_phi && i % 2 == 1 && NextToken(line) != "]") {
+      return Error(lineNo, "expected ']'");
+    }
+  }
+  if (!NextToken(line).empty()) {
+    return Error(lineNo, "too many operands");
+  }
+  return true;
+}
+
+bool Parser::ParseOperand(std::string_view token, Inst *inst,
+                          uint32_t operandNo, Graph &graph) {
+  if (IsLabelOperand(inst->GetOpcode(), operandNo) ||
+      !(token.front() >= '0' && token.front() <= '9')) {
+    fixups.push_back({inst, operandNo, token, lineNo});
+    return true;
+  }
+  uint64_t value;
+  auto [end, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  if (ec != std::errc() || end != token.data() + token.size()) {
+    return Error(lineNo, "invalid immediate '" + std::string(token) + "'");
+  }
+  inst->SetOperand(operandNo, graph.GetArena().Create<ImmOperand>(value));
+  return true;
+}
+
+bool Parser::Resolve(Graph &graph) {
+  Arena &arena = graph.GetArena();
+  labels.assign(graph.GetSize(), nullptr);
+  for (const auto &fixup : fixups) {
+    Operand *operand;
+    if (IsLabelOperand(fixup.inst->GetOpcode(), fixup.operandNo)) {
+      BBlockPtr *target = blocks.Find(fixup.name);
+      if (!target) {
+        return Error(fixup.line,
+                     "unknown block '" + std::string(fixup.name) + "'");
+      }
+      LabelOperand *&label = labels[(*target)->GetId()];
+      if (!label) {
+        label = arena.Create<LabelOperand>(
+            arena.Create<Label>(*target, (*target)->GetSymbol()));
+      }
+      operand = label;
+    } else {
+      Value *value = values.Find(fixup.name);
+      if (!value) {
+        return Error(fixup.line,
+                     "unknown value '" + std::string(fixup.name) + "'");
+      }
+      if (!value->operand) {
+        value->operand = arena.Create<InstOperand>(value->inst);
+      }
+      operand = value->operand;
+    }
+    fixup.inst->SetOperand(fixup.operandNo, operand);
+  }
+  return true;
+}
+
+void Parser::CreateEdges(Graph &graph) {
+  const auto &graphBlocks = graph.GetBlocks();
+  for (size_t i = 0; i < graphBlocks.size(); ++i) {
+    BBlockPtr curr = graphBlocks[i];
+    BBlockPtr next = i + 1 < graphBlocks.size() ? graphBlocks[i + 1] : nullptr;
+    Inst *last =
+        curr->GetInstCount() != 0 ? curr->GetInstList().Back() : nullptr;
+    if (last && last->IsRet()) {
+      continue;
+    }
+    if (next && !(last && last->IsJmp())) {
+      graph.CreateEdge(curr, next);
+    }
+    if (last && last->IsBranch()) {
+      auto *label = static_cast<LabelOperand *>(
+          last->GetOperand(last->GetNumOperands() - 1));
+      graph.CreateEdge(curr, label->GetLabel()->GetBBlock());
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include <IR/include/SymbolTable.h>
+
+#include <cstring>
+
+SymbolId SymbolTable::Intern(std::string_view name) {
+  if (const SymbolId *id = interned.Find(name)) {
+    return *id;
+  }
+  char *text = arena.AllocateArray<char>(name.size());
+  std::memcpy(text, name.data(), name.size());
+  std::string_view stored(text, name.size());
+  symbols.push_back({stored, kNoBase, 0});
+  interned.Insert(stored, symbols.size() - 1);
+  return symbols.size() - 1;
+}
+
+std::string SymbolTable::GetName(SymbolId id) const {
+  assert(id < symbols.size() && "invalid symbol");
+  const Symbol &symbol = symbols[id];
+  if (symbol.base == kNoBase) {
+    return std::string(symbol.text);
+  }
+  return GetName(symbol.base) + std::to_string(symbol.number);
+}
+
+void SymbolTable::Dump(std::ostream &os, SymbolId id) const {
+  assert(id < symbols.size() && "invalid symbol");
+  const Symbol &symbol = symbols[id];
+  if (symbol.base == kNoBase) {
+    os << symbol.text;
+    return;
+  }
+  Dump(os, symbol.base);
+  os << symbol.number;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Executes a function of the IR. The function is lowered once to a linear
+// bytecode over a flat register file: every value and every distinct
+// immediate get a register, branch targets are bytecode indices and phis
+// become moves on the incoming edges. Dispatch is threaded with computed
+// goto where the compiler supports it.
+//
+// Control flow: 'jeq a b L' ('jne') jumps to L if a == b (a != b),
+// otherwise it goes to the other successor of the block or, if there is
+// none, to the next block of the graph. A block without a terminator falls
+// through to its only successor. 'cmp a b' is 1 if a < b (unsigned),
+// 0 otherwise.
+class Interpreter {
+public:
+  explicit Interpreter(const Graph &graph);
+
+  // run from the entry, return the operand of the executed 'ret'
+  uint64_t Run();
+  // same, also count executed bytecode instructions
+  uint64_t Run(uint64_t &executed);
+
+  size_t GetBytecodeSize() const { return code.size(); }
+  size_t GetNumRegisters() const { return numRegs; }
+  void DumpBytecode(std::ostream &os) const;
+
+private:
+  enum BcOpcode : uint32_t {
+    BC_move,
+    BC_add,
+    BC_mul,
+    BC_cmp,
+    BC_jmp,
+    BC_jeq,
+    BC_jne,
+    BC_ret,
+    BC_count
+  };
+
+  // 16 bytes, 4 instructions per cache line
+  struct BcInst {
+    BcOpcode op;
+    uint32_t dst; // destination register or branch target
+    uint32_t src0;
+    uint32_t src1;
+  };
+
+  template <bool kCount> uint64_t Execute(uint64_t &executed);
+
+  // lowering
+  uint32_t GetRegister(const Operand *opnd);
+  void LowerBlock(const BBlockPtr block);
+  // emit phi moves of the edge and jump to 'succ', return index of the
+  // first emitted instruction. The jump is omitted if the edge is emitted
+  // 'last' for the block and 'succ' is laid out right after it.
+  uint32_t EmitEdge(const BBlockPtr pred, const BBlockPtr succ, bool last);
+  void Emit(BcOpcode op, uint32_t dst, uint32_t src0 = 0, uint32_t src1 = 0) {
+    code.push_back({op, dst, src0, src1});
+  }
+
+private:
+  const Graph &graph;
+
+  std::vector<BcInst> code;
+  // initial register values, immediates are preloaded
+  std::vector<uint64_t> initRegs;
+  uint32_t numRegs = 0;
+
+  // lowering state
+  std::unordered_map<const Inst *, uint32_t> inst2reg;
+  std::unordered_map<uint64_t, uint32_t> imm2reg;
+  std::vector<uint32_t> blockStart;
+  // jumps to block starts, patched after all blocks are emitted
+  std::vector<std::pair<uint32_t, BBlockPtr>> fixups;
+};
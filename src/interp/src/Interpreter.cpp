@@ -0,0 +1,294 @@
+#include <interp/Interpreter.h>
+
+#include <algorithm>
+#include <cassert>
+
+Interpreter::Interpreter(const Graph &graph) : graph(graph) {
+  if (graph.GetSize() == 0) {
+    return;
+  }
+
+  // every value gets its own register
+  for (const auto &block : graph.GetBlocks()) {
+    for (const auto inst : block->GetInstList()) {
+      if (inst->HasResult()) {
+        inst2reg.emplace(inst, numRegs++);
+        initRegs.push_back(0);
+      }
+    }
+  }
+
+  blockStart.assign(graph.GetSize(), 0);
+  for (const auto &block : graph.GetBlocks()) {
+    LowerBlock(block);
+  }
+  for (const auto &[idx, target] : fixups) {
+    code[idx].dst = blockStart[target->GetId()];
+  }
+
+  // lowering state is not needed anymore
+  inst2reg.clear();
+  imm2reg.clear();
+  fixups.clear();
+}
+
+uint32_t Interpreter::GetRegister(const Operand *opnd) {
+  if (opnd->IsImm()) {
+    uint64_t value = static_cast<const ImmOperand *>(opnd)->GetValue();
+    auto [it, inserted] = imm2reg.emplace(value, numRegs);
+    if (inserted) {
+      ++numRegs;
+      initRegs.push_back(value);
+    }
+    return it->second;
+  }
+
+  assert(opnd->IsInst() && "value operand expected");
+  auto it = inst2reg.find(static_cast<const InstOperand *>(opnd)->GetInst());
+  assert(it != inst2reg.end() && "operand is defined outside of the graph");
+  return it->second;
+}
+
+static BBlockPtr GetTarget(const Operand *opnd) {
+  assert(opnd->IsLabel() && "label operand expected");
+  return static_cast<const LabelOperand *>(opnd)->GetLabel()->GetBBlock();
+}
+
+uint32_t Interpreter::EmitEdge(const BBlockPtr pred, const BBlockPtr succ,
+                               bool last) {
+  uint32_t first = code.size();
+
+  // phis read their operands at once: (dst, src) is a parallel copy
+  std::vector<std::pair<uint32_t, uint32_t>> moves;
+  for (const auto phi : succ->GetPhis()) {
+    const Operand *src = nullptr;
+    for (size_t i = 0; i + 1 < phi->GetNumOperands(); i += 2) {
+      if (GetTarget(phi->GetOperand(i + 1)) == pred) {
+        src = phi->GetOperand(i);
+        break;
+      }
+    }
+    assert(src && "phi has no operand for the predecessor");
+    uint32_t dst = inst2reg.at(phi);
+    uint32_t srcReg = GetRegister(src);
+    if (dst != srcReg) {
+      moves.emplace_back(dst, srcReg);
+    }
+  }
+
+  bool overlap = std::any_of(moves.begin(), moves.end(), [&](auto &move) {
+    return std::any_of(moves.begin(), moves.end(),
+                       [&](auto &other) { return other.second == move.first; });
+  });
+  if (!overlap) {
+    for (const auto &[dst, src] : moves) {
+      Emit(BC_move, dst, src);
+    }
+  } else {
+    // some phi overwrites a source of another one, copy via temporaries
+    uint32_t temps = numRegs;
+    numRegs += moves.size();
+    initRegs.resize(numRegs, 0);
+    for (size_t i = 0; i < moves.size(); ++i) {
+      Emit(BC_move, temps + i, moves[i].second);
+    }
+    for (size_t i = 0; i < moves.size(); ++i) {
+      Emit(BC_move, moves[i].first, temps + i);
+    }
+  }
+
+  if (!last || succ->GetId() != pred->GetId() + 1) {
+    fixups.emplace_back(code.size(), succ);
+    Emit(BC_jmp, 0);
+  }
+  return first;
+}
+
+void Interpreter::LowerBlock(const BBlockPtr block) {
+  blockStart[block->GetId()] = code.size();
+
+  for (const auto inst : block->GetInstList()) {
+    switch (inst->GetOpcode()) {
+    case OP_phi:
+    case OP_label:
+      // phis are moves on the incoming edges
+      break;
+    case OP_assign:
+      Emit(BC_move, inst2reg.at(inst), GetRegister(inst->GetOperand(0)));
+      break;
+    case OP_add:
+    case OP_mul:
+    case OP_cmp: {
+      BcOpcode op = inst->GetOpcode() == OP_add   ? BC_add
+                    : inst->GetOpcode() == OP_mul ? BC_mul
+                                                  : BC_cmp;
+      Emit(op, inst2reg.at(inst), GetRegister(inst->GetOperand(0)),
+           GetRegister(inst->GetOperand(1)));
+      break;
+    }
+    case OP_ret:
+      Emit(BC_ret, 0, GetRegister(inst->GetOperand(0)));
+      return;
+    case OP_jmp:
+      EmitEdge(block, GetTarget(inst->GetOperand(0)), true);
+      return;
+    case OP_jeq:
+    case OP_jne: {
+      BBlockPtr taken = GetTarget(inst->GetOperand(2));
+      BBlockPtr notTaken = nullptr;
+      for (const auto &succ : block->GetSuccessors()) {
+        if (succ != taken) {
+          notTaken = succ;
+        }
+      }
+      if (!notTaken) {
+        assert(block->GetId() + 1 < graph.GetSize() &&
+               "conditional branch falls out of the function");
+        notTaken = graph.GetBlocks()[block->GetId() + 1];
+      }
+
+      uint32_t branch = code.size();
+      Emit(inst->GetOpcode() == OP_jeq ? BC_jeq : BC_jne, 0,
+           GetRegister(inst->GetOperand(0)),
+           GetRegister(inst->GetOperand(1)));
+      EmitEdge(block, notTaken, false);
+      // the taken edge gets its own moves right after
+      code[branch].dst = EmitEdge(block, taken, true);
+      return;
+    }
+    default:
+      assert(false && "unsupported instruction");
+    }
+  }
+
+  // no terminator
+  assert(block->GetSuccessors().size() == 1 &&
+         "block without terminator must have a single successor");
+  EmitEdge(block, block->GetSuccessors().front(), true);
+}
+
+uint64_t Interpreter::Run() {
+  uint64_t executed = 0;
+  return Execute<false>(executed);
+}
+
+uint64_t Interpreter::Run(uint64_t &executed) {
+  executed = 0;
+  return Execute<true>(executed);
+}
+
+#if defined(__GNUC__)
+#define INTERP_THREADED_DISPATCH
+#endif
+
+template <bool kCount> uint64_t Interpreter::Execute(uint64_t &executed) {
+  assert(!code.empty() && "nothing to execute");
+  std::vector<uint64_t> regs(initRegs);
+  uint64_t *r = regs.data();
+  const BcInst *base = code.data();
+  const BcInst *pc = base;
+
+#ifdef INTERP_THREADED_DISPATCH
+  // every handler jumps to the next one by itself, so each has its own
+  // indirect branch for the predictor
+  static const void *const handlers[BC_count] = {
+      &&L_move, &&L_add, &&L_mul, &&L_cmp,
+      &&L_jmp,  &&L_jeq, &&L_jne, &&L_ret};
+#define HANDLER(name) L_##name
+#define DISPATCH()                                                             \
+  do {                                                                         \
+    if constexpr (kCount) {                                                    \
+      ++executed;                                                              \
+    }                                                                          \
+    goto *handlers[pc->op];                                                    \
+  } while (0)
+
+  DISPATCH();
+#else
+#define HANDLER(name) case BC_##name
+#define DISPATCH() goto dispatch
+
+dispatch:
+  if constexpr (kCount) {
+    ++executed;
+  }
+  switch (pc->op) {
+#endif
+
+HANDLER(move):
+  r[pc->dst] = r[pc->src0];
+  ++pc;
+  DISPATCH();
+
+HANDLER(add):
+  r[pc->dst] = r[pc->src0] + r[pc->src1];
+  ++pc;
+  DISPATCH();
+
+HANDLER(mul):
+  r[pc->dst] = r[pc->src0] * r[pc->src1];
+  ++pc;
+  DISPATCH();
+
+HANDLER(cmp):
+  r[pc->dst] = r[pc->src0] < r[pc->src1] ? 1 : 0;
+  ++pc;
+  DISPATCH();
+
+HANDLER(jmp):
+  pc = base + pc->dst;
+  DISPATCH();
+
+HANDLER(jeq):
+  pc = r[pc->src0] == r[pc->src1] ? base + pc->dst : pc + 1;
+  DISPATCH();
+
+HANDLER(jne):
+  pc = r[pc->src0] != r[pc->src1] ? base + pc->dst : pc + 1;
+  DISPATCH();
+
+HANDLER(ret):
+  return r[pc->src0];
+
+#ifndef INTERP_THREADED_DISPATCH
+  default:
+    assert(false && "invalid bytecode");
+    return 0;
+  }
+#endif
+
+#undef HANDLER
+#undef DISPATCH
+}
+
+void Interpreter::DumpBytecode(std::ostream &os) const {
+  static const char *const names[BC_count] = {"move", "add", "mul", "cmp",
+                                              "jmp",  "jeq", "jne", "ret"};
+  for (size_t i = 0; i < code.size(); ++i) {
+    const BcInst &inst = code[i];
+    os << i << ": " << names[inst.op];
+    switch (inst.op) {
+    case BC_move:
+      os << " r" << inst.dst << " r" << inst.src0;
+      break;
+    case BC_add:
+    case BC_mul:
+    case BC_cmp:
+      os << " r" << inst.dst << " r" << inst.src0 << " r" << inst.src1;
+      break;
+    case BC_jmp:
+      os << " " << inst.dst;
+      break;
+    case BC_jeq:
+    case BC_jne:
+      os << " r" << inst.src0 << " r" << inst.src1 << " " << inst.dst;
+      break;
+    case BC_ret:
+      os << " r" << inst.src0;
+      break;
+    default:
+      break;
+    }
+    os << std::endl;
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <passes/PassManager.h>
+
+#include <cstdint>
+
+// Aggressive dead code elimination. Instructions are assumed dead until
+// proven live: terminators and instructions with side effects are live,
+// and so are the operands of live instructions. Marks go to a bitset over
+// the instructions numbered densely with Inst::SetIndex, the sweep walks
+// every block once. Unlike removing unused instructions one by one, this
+// also drops cycles of dead values, e.g. a phi used only by its own
+// increment. Time is linear in the number of instructions and operands.
+class DCE : public FunctionPass {
+public:
+  // accumulated over all runs
+  struct Stats {
+    uint64_t numErasedInsts = 0;
+    // included in numErasedInsts
+    uint64_t numErasedPhis = 0;
+  };
+
+  const char *GetName() const override { return "DCE"; }
+  PreservedAnalyses Run(Graph &graph, AnalysisManager &am) override;
+
+  const Stats &GetStats() const { return stats; }
+
+private:
+  Stats stats;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
+#include <passes/DominatorTree.h>
+
+#include <cstdint>
+#include <vector>
+
+// Dominance frontiers of all reachable blocks, computed with the
+// two-finger method of "A Simple, Fast Dominance Algorithm" by Cooper,
+// Harvey and Kennedy. Iterated frontiers are computed without them on the
+// DJ-graph, see "A Linear Time Algorithm for Placing phi-nodes" by
+// Sreedhar and Gao.
+class DominanceFrontier {
+public:
+  DominanceFrontier(const Graph &graph, const DominatorTree &domTree);
+
+  // frontier of the block, empty for unreachable blocks
+  const std::vector<BBlockPtr> &GetFrontier(const BBlockPtr block) const {
+    return frontiers[block->GetId()];
+  }
+
+  // Iterated frontier of 'defBlocks', i.e. blocks which need a phi for a
+  // variable defined in 'defBlocks'. Result is sorted by block id. Scratch
+  // state is reused and only subtrees with join edges are walked, so the
+  // cost of a query doesn't depend on the graph size.
+  void GetIteratedFrontier(const std::vector<BBlockPtr> &defBlocks,
+                           std::vector<BBlockPtr> &result);
+
+private:
+  const DominatorTree &domTree;
+
+  // flat arrays indexed by block id
+  std::vector<std::vector<BBlockPtr>> frontiers;
+  // minimal level of a join edge target over the dominator subtree, the
+  // walk skips subtrees with no join edges up to the walk root
+  std::vector<uint32_t> minJoinLevel;
+
+  // scratch marks of the iterated frontier query: a flag is set for the
+  // block iff its stamp is equal to the current epoch
+  std::vector<uint32_t> isDef;
+  std::vector<uint32_t> inQueue;
+  std::vector<uint32_t> visited;
+  uint32_t epoch = 0;
+
+  static bool Mark(std::vector<uint32_t> &stamps, uint32_t epoch,
+                   BBlockPtr block) {
+    if (stamps[block->GetId()] == epoch) {
+      return false;
+    }
+    stamps[block->GetId()] = epoch;
+    return true;
+  }
+};
@@ -3,17 +3,48 @@
 #include <IR/include/BasicBlock.h>
 #include <IR/include/Graph.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <memory>
 #include <vector>
 
 class DomTreeNode;
 
-class DomTreeNode : NodeTraits<DomTreeNode> {
+class DomTreeNode : public NodeTraits<DomTreeNode> {
  public:
-  DomTreeNode(BBlockPtr bblock) : bblock(bblock) {}
+  using NodePtr = DomTreeNode *;
+
+  DomTreeNode(BBlockPtr bblock, NodePtr idom)
+      : bblock(bblock), idom(idom), level(idom ? idom->level + 1 : 0) {}
+
+  BBlockPtr GetBBlock() const { return bblock; }
+  // immediate dominator, nullptr for the root and detached nodes
+  NodePtr GetIDom() const { return idom; }
+  // depth in the dominator tree, root has level 0
+  uint32_t GetLevel() const { return level; }
+  const std::vector<NodePtr> &GetChildren() const { return childs; }
+
+  // move the node (with its subtree) under 'newIDom', levels of the
+  // subtree are not updated
+  void SetIDom(NodePtr newIDom) {
+    if (idom) {
+      idom->RemoveSucc(this);
+    }
+    idom = newIDom;
+    if (idom) {
+      idom->AddSucc(this);
+      level = idom->level + 1;
+    }
+  }
 
-  using NodePtr = std::shared_ptr<DomTreeNode>;
+  void SetLevel(uint32_t newLevel) { level = newLevel; }
+
+  // drop all tree links, used when the whole subtree is rebuilt
+  void Detach() {
+    idom = nullptr;
+    level = 0;
+    childs.clear();
+  }
 
   void AddSucc(const NodePtr succ) override {
     childs.push_back(succ);
@@ -24,7 +55,11 @@ class DomTreeNode : NodeTraits<DomTreeNode> {
   }
 
   void RemoveSucc(const NodePtr succ) override {
-    assert(false && "unimplemented");
+    // order of children doesn't matter
+    auto it = std::find(childs.begin(), childs.end(), succ);
+    assert(it != childs.end() && "not a child");
+    *it = childs.back();
+    childs.pop_back();
   }
 
   void RemovePred(const NodePtr pred) override {
@@ -47,6 +82,8 @@ class DomTreeNode : NodeTraits<DomTreeNode> {
 
 private:
   BBlockPtr bblock;
+  NodePtr idom;
+  uint32_t level;
   std::vector<NodePtr> childs;
 };
 
@@ -54,90 +91,123 @@ class DominatorTree : public GraphTraits<DomTreeNode> {
  public:
   DominatorTree(const Graph &graph) { InitFrom(graph); }
 
+  // CFG edit, applied to the graph and to the tree
+  struct Update {
+    enum Kind { kInsert, kDelete };
+
+    Kind kind;
+    BBlockPtr from;
+    BBlockPtr to;
+  };
+
+  // Incremental updates. Insertions use the depth-based search of
+  // "An Experimental Study of Dynamic Dominators" by Georgiadis et al.,
+  // deletions rebuild only the dominator subtree of the affected region.
+  // The DFS intervals are renumbered once per call if the tree changed, so
+  // queries never modify the tree.
+  void InsertEdge(Graph &graph, BBlockPtr from, BBlockPtr to);
+  void DeleteEdge(Graph &graph, BBlockPtr from, BBlockPtr to);
+  // delete all edges of the block, the block stays in the graph
+  void RemoveBlock(Graph &graph, BBlockPtr block);
+  // apply 'updates' in order, large batches fall back to a full rebuild
+  void ApplyUpdates(Graph &graph, const std::vector<Update> &updates);
+
+  // compare with the tree built from scratch
+  bool Verify(const Graph &graph) const;
+
   // return true if 'dom' dominate 'block'
   bool IsDominate(const BBlockPtr dom, const BBlockPtr block) const {
-    assert(block2node.count(dom) > 0 && block2node.count(block) > 0 &&
+    assert(IsReachable(dom) && IsReachable(block) &&
            "dominator tree doesn't consist required blocks");
-    NodePtr domNode = block2node.at(dom);
-    NodePtr domBlock = block2node.at(block);
-
-    // find in subtree
-    std::set<NodePtr> s;
-    auto dfs = GetDfs(domNode, s);
-    return find(dfs.begin(), dfs.end(), domBlock) != dfs.end();
+    // 'block' is in the subtree of 'dom' iff its interval is nested
+    const DfsInterval &domInterval = intervals[dom->GetId()];
+    const DfsInterval &blockInterval = intervals[block->GetId()];
+    return domInterval.in <= blockInterval.in &&
+           blockInterval.out <= domInterval.out;
   }
 
-private:
-  NodePtr root;
-
-  // map from bblock to node that consist this bblock
-  std::map<BBlockPtr, NodePtr> block2node;
-
-  static std::set<BBlockPtr> diff(const std::set<BBlockPtr> &full, const std::set<BBlockPtr> &part) {
-    std::set<BBlockPtr> result;
-    for (const auto &el : full) {
-      if (part.count(el) == 0) {
-        result.insert(el);
-      }
+  // answer IsDominate for every (dom, block) pair of [first, last) into
+  // 'result', no allocations are made
+  template <class InIt, class OutIt>
+  OutIt IsDominateBatch(InIt first, InIt last, OutIt result) const {
+    for (; first != last; ++first, ++result) {
+      *result = IsDominate(first->first, first->second);
     }
-
-    return std::move(result);
-  }
-
-  // FIXME arguments are awful
-  NodePtr CreateBranch(BBlockPtr block, const std::vector<std::set<BBlockPtr>> &domSet,
-                       const std::map<BBlockPtr, size_t> block2idx) {
-    auto IsDominate = [&domSet, &block2idx](BBlockPtr dom, BBlockPtr node) {
-      size_t idx = block2idx.at(dom);
-      return domSet.at(idx).count(node) > 0;
-    };
-
-    NodePtr newBranch = std::make_shared<DomTreeNode>(block);
-    block2node.insert({block, newBranch});
-
-    size_t idx = block2idx.at(block);
-    if (!domSet[idx].empty()) {
-      for (auto &child : domSet[idx]) {
-        // if child are not dominated by any block from set
-        // then there is an edge of the dominator tree
-        bool notDominated = true;
-        for (auto &d : domSet[idx]) {
-          if (d != child && IsDominate(d, child)) {
-            notDominated = false;
-            break;
-          }
-        }
-        if (notDominated) {
-          newBranch->AddSucc(CreateBranch(child, domSet, block2idx));
-        }
-      }
-    }
-    PushBlock(newBranch);
-    return newBranch;
+    return result;
   }
 
-  void InitFrom(const Graph &graph) {
-    const BBlockPtr entry = graph.GetEntry();
-
-    // full set of visited blocks
-    std::set<BBlockPtr> full;
-    std::vector<BBlockPtr> dfs = graph.GetDfs(entry, full);
+  NodePtr GetRoot() const { return GetEntry(); }
 
-    // map from blocks to dfs idxs
-    std::map<BBlockPtr, size_t> block2idx;
+  // node of the block, nullptr if the block is unreachable
+  NodePtr GetNode(const BBlockPtr block) const {
+    if (block->GetId() >= block2node.size()) {
+      return nullptr;
+    }
+    NodePtr node = block2node[block->GetId()];
+    return node && (node->GetIDom() || node == GetRoot()) ? node : nullptr;
+  }
 
-    std::vector<std::set<BBlockPtr>> dominatorSets;
-    for (size_t i = 0; i < dfs.size(); ++i) {
-      block2idx[dfs[i]] = i;
+  bool IsReachable(const BBlockPtr block) const {
+    return GetNode(block) != nullptr;
+  }
 
-      std::set<BBlockPtr> part;
-      // mark block as visited
-      part.insert(dfs[i]);
-      (void)graph.GetDfs(entry, part);
+  // immediate dominator of the block, nullptr for entry and unreachable
+  BBlockPtr GetIDom(const BBlockPtr block) const {
+    return block->GetId() < idoms.size() ? idoms[block->GetId()] : nullptr;
+  }
 
-      dominatorSets.push_back(diff(full, part));
+private:
+  // preorder entry and exit numbers of the node in the dominator tree
+  struct DfsInterval {
+    uint32_t in = 0;
+    uint32_t out = 0;
+  };
+
+  // flat arrays indexed by block id, nodes of unreachable blocks are
+  // detached from the tree but kept for reuse
+  std::vector<BBlockPtr> idoms;
+  std::vector<NodePtr> block2node;
+  std::vector<DfsInterval> intervals;
+
+  // scratch DFS numbers for Semi-NCA, all zeros between runs
+  std::vector<uint32_t> dfsNum;
+  // scratch marks: block is marked iff stamps[id] == epoch
+  std::vector<uint32_t> stamps;
+  uint32_t epoch = 0;
+
+  uint32_t NewEpoch();
+  bool Mark(BBlockPtr block) {
+    if (stamps[block->GetId()] == epoch) {
+      return false;
     }
-
-    root = CreateBranch(graph.GetEntry(), dominatorSets, block2idx);
+    stamps[block->GetId()] = epoch;
+    return true;
+  }
+  bool IsMarked(BBlockPtr block) const {
+    return stamps[block->GetId()] == epoch;
   }
+  // mark the subtree of 'root' with a new epoch and collect it
+  void MarkSubtree(NodePtr root, std::vector<NodePtr> &subtree);
+  bool HasProperSupport(NodePtr node) const;
+
+  void ComputeDfsIntervals();
+
+  // Semi-NCA, see "Finding Dominators in Practice" by Georgiadis et al.
+  void InitFrom(const Graph &graph);
+
+  void Grow(const Graph &graph);
+  NodePtr GetOrCreateNode(BBlockPtr block);
+  void SetIDom(NodePtr node, NodePtr idom);
+  void UpdateLevels(NodePtr node);
+  NodePtr FindNCD(NodePtr lhs, NodePtr rhs) const;
+
+  // apply the edit without renumbering, true if the tree changed
+  bool InsertEdgeImpl(Graph &graph, BBlockPtr from, BBlockPtr to);
+  bool DeleteEdgeImpl(Graph &graph, BBlockPtr from, BBlockPtr to);
+
+  void InsertReachable(NodePtr from, NodePtr to);
+  void InsertUnreachable(NodePtr from, BBlockPtr to);
+  void DeleteReachable(NodePtr from, NodePtr to);
+  // recompute the dominator subtree of 'root' with Semi-NCA
+  void RebuildSubtree(NodePtr root);
 };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <passes/PassManager.h>
+
+#include <cstdint>
+
+// Dominator-based global value numbering. Blocks are visited in preorder
+// of the dominator tree with a scoped hash table of the expressions
+// computed in the dominating blocks, keyed by the opcode and the value
+// numbers of the operands. Operands of commutative instructions are
+// ordered first. A redundant instruction is replaced with its dominating
+// equivalent right away, so operands always name the leaders of their
+// values and the leader itself serves as the value number; immediates are
+// numbered by value.
+//
+// 'assign' of an instruction is a copy and is replaced with its source.
+// Phis are not numbered, every phi is a value of its own.
+class GVN : public FunctionPass {
+public:
+  // accumulated over all runs
+  struct Stats {
+    uint64_t numEliminatedInsts = 0;
+    uint64_t numPropagatedCopies = 0;
+  };
+
+  const char *GetName() const override { return "GVN"; }
+  PreservedAnalyses Run(Graph &graph, AnalysisManager &am) override;
+
+  const Stats &GetStats() const { return stats; }
+
+private:
+  Stats stats;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <passes/PassManager.h>
+
+#include <cstdint>
+
+// Loop invariant code motion. Loops of the LoopTree are visited inner
+// loops first. Every reducible loop gets a preheader: the single block
+// outside of the loop jumping to the head only, created and placed right
+// before the head when the head has several predecessors outside of the
+// loop or the only one branches elsewhere too. Side-effect-free
+// instructions whose operands are defined outside of the loop are moved
+// to the end of the preheader, so are the ones using those in turn. The
+// preheader of an inner loop belongs to the outer loop, invariants of
+// the outer loop climb further up the nest when it is visited.
+//
+// Loops with an irreducible loop inside, the loop of the entry block and
+// heads with phis and several predecessors outside of the loop are left
+// as is. Time is linear in the number of instructions times the depth of
+// the loop nest.
+class LICM : public FunctionPass {
+public:
+  // accumulated over all runs
+  struct Stats {
+    uint64_t numHoistedInsts = 0;
+    uint64_t numCreatedPreheaders = 0;
+  };
+
+  const char *GetName() const override { return "LICM"; }
+  PreservedAnalyses Run(Graph &graph, AnalysisManager &am) override;
+
+  const Stats &GetStats() const { return stats; }
+
+private:
+  Stats stats;
+};
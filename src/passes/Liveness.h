@@ -0,0 +1,79 @@
+#pragma once
+
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
+#include <passes/LoopAnalysis.h>
+#include <support/BitVector.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Live-in and live-out sets of blocks as bitvectors over densely numbered
+// values. Only values used outside of their block or by a phi are
+// numbered, values used only inside of their block are never live across
+// block boundaries and don't take space in the sets.
+//
+// Phis are handled as copies on incoming edges: an operand of a phi is
+// live-out of the corresponding predecessor, the result of a phi is
+// defined at the beginning of its block and is not live-in.
+//
+// Blocks are processed in reverse of GetPo order with blocks of every loop
+// kept together. The worklist always takes the first pending block in that
+// order, so the body of a loop reaches its fixed point before changes
+// propagate to blocks outside of the loop.
+class Liveness {
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  Liveness(const Graph &graph, const LoopTree &loopTree);
+
+  uint32_t GetNumValues() const { return values.size(); }
+  // dense number of the value, npos for values local to their block
+  uint32_t GetValueIndex(const Inst *inst) const {
+    auto it = value2idx.find(inst);
+    return it == value2idx.end() ? npos : it->second;
+  }
+  Inst *GetValue(uint32_t idx) const { return values[idx]; }
+
+  const BitVector &GetLiveIn(const BBlockPtr block) const {
+    return liveIn[block->GetId()];
+  }
+  const BitVector &GetLiveOut(const BBlockPtr block) const {
+    return liveOut[block->GetId()];
+  }
+
+  bool IsLiveIn(const BBlockPtr block, const Inst *inst) const {
+    uint32_t idx = GetValueIndex(inst);
+    return idx != npos && liveIn[block->GetId()].Test(idx);
+  }
+  bool IsLiveOut(const BBlockPtr block, const Inst *inst) const {
+    uint32_t idx = GetValueIndex(inst);
+    return idx != npos && liveOut[block->GetId()].Test(idx);
+  }
+
+  // number of block visits the solver made
+  size_t GetNumVisits() const { return numVisits; }
+  // blocks in the solving order, blocks of every loop are contiguous
+  const std::vector<BBlockPtr> &GetBlockOrder() const { return order; }
+
+private:
+  void NumberValues(const Graph &graph);
+  void ComputeLocalSets(const Graph &graph);
+  void ComputeOrder(const Graph &graph, const LoopTree &loopTree);
+  void Solve();
+
+private:
+  std::vector<Inst *> values;
+  std::unordered_map<const Inst *, uint32_t> value2idx;
+
+  // flat arrays indexed by block id, local sets are sparse
+  std::vector<std::vector<uint32_t>> gen;     // upward exposed uses
+  std::vector<std::vector<uint32_t>> kill;    // definitions
+  std::vector<std::vector<uint32_t>> phiUses; // uses by successor phis
+  std::vector<BitVector> liveIn;
+  std::vector<BitVector> liveOut;
+
+  std::vector<BBlockPtr> order;
+  size_t numVisits = 0;
+};
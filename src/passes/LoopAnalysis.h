@@ -5,30 +5,40 @@
 #include <GraphTraits.h>
 #include <passes/DominatorTree.h>
 
+#include <memory>
 #include <sstream>
+#include <vector>
 
 class LoopTreeNode;
-using LoopTreeNodePtr = std::shared_ptr<LoopTreeNode>;
+using LoopTreeNodePtr = LoopTreeNode *;
 
 class LoopTreeNode : public NodeTraits<LoopTreeNode> {
 public:
   LoopTreeNode(bool isRoot = false) : isRoot(isRoot){};
   LoopTreeNode(const BBlockPtr head, const BBlockPtr backEdge)
       : head(head), reducible(false), isRoot(false) {
-    backEdges.insert(backEdge);
+    backEdges.push_back(backEdge);
+    entries.push_back(head);
   }
 
   void MarkReducible() { reducible = true; }
   void MarkIrreducible() { reducible = false; }
-  bool IsReducible() { return reducible; }
+  bool IsReducible() const { return reducible; }
 
   BBlockPtr GetHead() const { return head; }
-  const std::set<BBlockPtr> &GetBackEdges() { return backEdges; }
-
-  void AddBackEdge(const BBlockPtr be) { backEdges.insert(be); }
+  // sources of the back edges in DFS order
+  const std::vector<BBlockPtr> &GetBackEdges() const { return backEdges; }
+  // blocks of the loop outside of its inner loops, without the head
+  const std::vector<BBlockPtr> &GetSources() const { return srcs; }
+  // blocks of the loop with predecessors outside of it, the head goes
+  // first
+  const std::vector<BBlockPtr> &GetEntries() const { return entries; }
+
+  void AddBackEdge(const BBlockPtr be) { backEdges.push_back(be); }
   void AddSource(const BBlockPtr src) { srcs.push_back(src); }
+  void AddEntry(const BBlockPtr entry) { entries.push_back(entry); }
 
-  const LoopTreeNodePtr GetOuterLoop() const { return parent; }
+  LoopTreeNodePtr GetOuterLoop() const { return parent; }
   const std::vector<LoopTreeNodePtr> &GetInnerLoops() const { return childs; }
 
 public:
@@ -50,74 +60,89 @@ public:
   void DumpDot(std::ostream &os) const override;
 
 private:
-  BBlockPtr bblock;
-
-  std::set<BBlockPtr> backEdges;
-  BBlockPtr head;
+  std::vector<BBlockPtr> backEdges;
+  BBlockPtr head = nullptr;
   std::vector<BBlockPtr> srcs;
+  std::vector<BBlockPtr> entries;
 
-  bool reducible;
+  bool reducible = false;
   bool isRoot;
 
   std::vector<NodePtr> childs; // inner loops
-  NodePtr parent;              // outer loop
+  NodePtr parent = nullptr;    // outer loop
 };
 
 class LoopTree : public GraphTraits<LoopTreeNode> {
 public:
-  LoopTree(const Graph &graph) : graph(graph), domTree(graph) { Init(); }
+  // kNatural finds loops with the dominator tree, irreducible loops get
+  // only the head and the back edge sources. kHavlak uses Havlak's
+  // union-find loop nesting, "Nesting of Reducible and Irreducible
+  // Loops", and gives irreducible regions their bodies and entries.
+  enum Algorithm { kNatural, kHavlak };
+
+  LoopTree(const Graph &graph, Algorithm algorithm = kNatural)
+      : graph(graph) {
+    if (algorithm == kHavlak) {
+      InitHavlak();
+      return;
+    }
+    ownDomTree = std::make_unique<DominatorTree>(graph);
+    domTree = ownDomTree.get();
+    Init();
+  }
+  // reuse an up-to-date dominator tree of the graph
+  LoopTree(const Graph &graph, const DominatorTree &domTree)
+      : graph(graph), domTree(&domTree) {
+    Init();
+  }
 
-  const LoopTreeNodePtr GetRoot() const { return root; }
+  LoopTreeNodePtr GetRoot() const { return root; }
 
-  const LoopTreeNodePtr GetLoopNode(const BBlockPtr bb) const {
-    assert(block2node.count(bb) != 0 && "attempt to get non-existend loop");
-    return block2node.at(bb);
+  // innermost loop of the block, the root for blocks outside of loops
+  LoopTreeNodePtr GetLoopNode(const BBlockPtr bb) const {
+    assert(bb->GetId() < block2node.size() &&
+           "attempt to get non-existend loop");
+    return block2node[bb->GetId()];
   }
 
 private:
   const Graph &graph;
-  const DominatorTree domTree;
+  std::unique_ptr<DominatorTree> ownDomTree;
+  // nullptr for Havlak's construction
+  const DominatorTree *domTree = nullptr;
 
   LoopTreeNodePtr root;
-  std::vector<LoopTreeNodePtr> loops;
-  std::map<BBlockPtr, LoopTreeNodePtr> block2node;
+  // flat array indexed by block id
+  std::vector<LoopTreeNodePtr> block2node;
 
 private:
-  // markers
-  enum Marker { WHITE = 0, GREY, BLACK, GREEN };
-
-  std::map<BBlockPtr, Marker> bb2marker;
-
-  void SetMarker(BBlockPtr bb, Marker m) { bb2marker[bb] = m; }
-
-  Marker GetMarker(BBlockPtr bb) {
-    if (bb2marker.count(bb) == 0) {
-      return WHITE;
-    }
-    return bb2marker.at(bb);
-  }
-
-private:
-  // FIXME: replace with marker?
-  bool IsBackEdge(const BBlockPtr bb) const;
-  bool IsHead(const BBlockPtr bb) const;
-
-  void DfsCollectBackEdges(const BBlockPtr curr);
-
-  void CollectBackEdges() {
-    DfsCollectBackEdges(graph.GetEntry());
-    bb2marker.clear();
-  }
-
-  void ReverseDfsPopulateLoop(const BBlockPtr bb, const LoopTreeNodePtr loop);
-  void PopulateReducibleLoop(const LoopTreeNodePtr loop);
-  void PopulateLoops();
+  // Construction uses explicit worklists only, so neither long chains of
+  // blocks nor deep loop nests grow the native stack.
+
+  // iterative DFS, a loop is created for every target of a back edge,
+  // 'preorder' gets DFS numbers starting from 1, 0 for unreachable blocks
+  void CollectBackEdges(std::vector<uint32_t> &preorder);
+  // build loops with inner headers first, 'outermost' is a union-find
+  // over loop ids that maps an inner loop to the outermost loop built
+  // so far around it
+  void PopulateLoops(const std::vector<uint32_t> &preorder);
+  void PopulateLoop(const LoopTreeNodePtr loop,
+                    const std::vector<uint32_t> &preorder,
+                    std::vector<uint32_t> &outermost,
+                    std::vector<uint32_t> &stamps);
+  static uint32_t FindOutermost(std::vector<uint32_t> &outermost,
+                                uint32_t loopId);
 
   void Init() {
-    root = std::make_shared<LoopTreeNode>(LoopTreeNode(true /* isRoot */));
-    // FIXME: rename GraphTraits::PushBlock
-    PushBlock(root);
-    CollectBackEdges();
-    PopulateLoops();
+    root = CreateNode(true /* isRoot */);
+    std::vector<uint32_t> preorder;
+    CollectBackEdges(preorder);
+    PopulateLoops(preorder);
   }
+
+  // link loops without outer loop and blocks without loop to the root
+  void LinkToRoot();
+  // add blocks entered from outside of their loops to the loop entries
+  void CollectEntries(const BitVector &reachable);
+  void InitHavlak();
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <passes/PassManager.h>
+
+#include <cstdint>
+
+// Unrolling of innermost loops with a constant trip count. A loop is
+// handled if it is reducible, has a single latch ending with 'jeq' or
+// 'jne' which is also the only way out of the loop, and its blocks are
+// contiguous in the layout with the head first. The trip count is found
+// by running the slice of the exit branch with the interpreter semantics:
+// head phis starting from immediates and arithmetic over them. It runs for
+// at most as many iterations as the budget could unroll.
+//
+// Copies of the body are clones of its blocks with the operands and the
+// phi inputs remapped to the values of the copy, the head phis of a copy
+// are replaced with the values of the previous one.
+//  - Full unroll: all iterations but the last one are peeled in front of
+//    the loop, the back edge of the last one is removed.
+//  - Partial unroll by a factor: the remainder of the trip count modulo
+//    the factor is peeled in front of the loop, the rest of the body is
+//    copied factor - 1 times after it. Only the last copy tests for the
+//    exit, the others jump to the next copy.
+// Peeled copies go right before the head in the layout, unrolled copies
+// right after the loop.
+//
+// Full unroll is preferred. Copies are only made while the number of
+// cloned instructions of the function stays within the budget, the
+// factor is decreased to fit in it. Dead exit tests of the copies are
+// left to DCE.
+class LoopUnroll : public FunctionPass {
+public:
+  static constexpr uint32_t kDefaultMaxGrowth = 256;
+  static constexpr uint32_t kDefaultFactor = 4;
+
+  // accumulated over all runs
+  struct Stats {
+    uint64_t numFullyUnrolled = 0;
+    uint64_t numPartiallyUnrolled = 0;
+    // iterations peeled as the remainder of partial unrolls
+    uint64_t numPeeledIterations = 0;
+    uint64_t numClonedInsts = 0;
+  };
+
+  // 'maxGrowth' is the budget of cloned instructions per function
+  explicit LoopUnroll(uint32_t maxGrowth = kDefaultMaxGrowth,
+                      uint32_t factor = kDefaultFactor)
+      : maxGrowth(maxGrowth), factor(factor) {}
+
+  const char *GetName() const override { return "LoopUnroll"; }
+  PreservedAnalyses Run(Graph &graph, AnalysisManager &am) override;
+
+  const Stats &GetStats() const { return stats; }
+
+private:
+  uint32_t maxGrowth;
+  uint32_t factor;
+  Stats stats;
+};
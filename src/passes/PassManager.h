@@ -0,0 +1,245 @@
+#pragma once
+
+#include <IR/include/Graph.h>
+#include <passes/DominanceFrontier.h>
+#include <passes/DominatorTree.h>
+#include <passes/Liveness.h>
+#include <passes/LoopAnalysis.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class AnalysisManager;
+
+// How an analysis is computed. 'kDependsOnInsts' is false for analyses
+// of the CFG only, they survive passes that change instructions only.
+template <class T>
+struct AnalysisInfo;
+
+template <>
+struct AnalysisInfo<DominatorTree> {
+  static constexpr const char *kName = "DominatorTree";
+  static constexpr bool kDependsOnInsts = false;
+  static std::unique_ptr<DominatorTree> Run(const Graph &graph,
+                                            AnalysisManager & /*am*/) {
+    return std::make_unique<DominatorTree>(graph);
+  }
+};
+
+template <>
+struct AnalysisInfo<DominanceFrontier> {
+  static constexpr const char *kName = "DominanceFrontier";
+  static constexpr bool kDependsOnInsts = false;
+  static std::unique_ptr<DominanceFrontier> Run(const Graph &graph,
+                                                AnalysisManager &am);
+};
+
+template <>
+struct AnalysisInfo<LoopTree> {
+  static constexpr const char *kName = "LoopTree";
+  static constexpr bool kDependsOnInsts = false;
+  static std::unique_ptr<LoopTree> Run(const Graph &graph,
+                                       AnalysisManager &am);
+};
+
+template <>
+struct AnalysisInfo<Liveness> {
+  static constexpr const char *kName = "Liveness";
+  static constexpr bool kDependsOnInsts = true;
+  static std::unique_ptr<Liveness> Run(const Graph &graph,
+                                       AnalysisManager &am);
+};
+
+// Analyses still valid after a pass. Unless listed explicitly, an
+// analysis is kept if the pass didn't change the CFG and either didn't
+// change instructions or the analysis doesn't look at them.
+class PreservedAnalyses {
+public:
+  static PreservedAnalyses All() { return PreservedAnalyses(true, true); }
+  static PreservedAnalyses None() { return PreservedAnalyses(false, false); }
+  // instructions changed, blocks and edges are the same
+  static PreservedAnalyses CFG() { return PreservedAnalyses(true, false); }
+
+  // the pass kept the analysis up to date itself
+  template <class T>
+  PreservedAnalyses &Preserve() {
+    preserved.insert(std::type_index(typeid(T)));
+    return *this;
+  }
+
+  bool IsPreserved(std::type_index id, bool dependsOnInsts) const {
+    return preserved.count(id) != 0 ||
+           (cfgPreserved && (instsPreserved || !dependsOnInsts));
+  }
+  bool AreAllPreserved() const { return cfgPreserved && instsPreserved; }
+
+private:
+  PreservedAnalyses(bool cfgPreserved, bool instsPreserved)
+      : cfgPreserved(cfgPreserved), instsPreserved(instsPreserved) {}
+
+  bool cfgPreserved;
+  bool instsPreserved;
+  std::unordered_set<std::type_index> preserved;
+};
+
+// Cache of analyses of one function. An analysis computed while another
+// one is being computed becomes its dependency: invalidating an analysis
+// invalidates everything built on top of it.
+class AnalysisManager {
+public:
+  struct Stats {
+    const char *name = nullptr;
+    // requests answered from the cache
+    uint64_t numHits = 0;
+    uint64_t numComputations = 0;
+    uint64_t numInvalidations = 0;
+    double seconds = 0;
+  };
+
+  AnalysisManager(Graph &graph) : graph(graph) {}
+
+  AnalysisManager(const AnalysisManager &) = delete;
+  AnalysisManager &operator=(const AnalysisManager &) = delete;
+
+  Graph &GetGraph() const { return graph; }
+
+  // cached result, computed on the first request
+  template <class T>
+  T &Get() {
+    std::type_index id(typeid(T));
+    Entry &entry = GetEntry<T>();
+    if (!computing.empty()) {
+      AddDependent(entry, computing.back());
+    }
+    if (entry.result) {
+      ++entry.stats.numHits;
+      return *static_cast<Result<T> &>(*entry.result).value;
+    }
+
+    ++entry.stats.numComputations;
+    computing.push_back(id);
+    auto start = std::chrono::steady_clock::now();
+    auto value = AnalysisInfo<T>::Run(graph, *this);
+    entry.stats.seconds += std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    computing.pop_back();
+
+    T &ref = *value;
+    entry.result = std::make_unique<Result<T>>(std::move(value));
+    return ref;
+  }
+
+  // nullptr if the analysis is not computed
+  template <class T>
+  T *GetCached() const {
+    auto it = entries.find(std::type_index(typeid(T)));
+    if (it == entries.end() || !it->second.result) {
+      return nullptr;
+    }
+    return static_cast<Result<T> &>(*it->second.result).value.get();
+  }
+
+  // drop the analyses not in 'preserved' and their dependents
+  void Invalidate(const PreservedAnalyses &preserved);
+  template <class T>
+  void Invalidate() {
+    Invalidate(std::type_index(typeid(T)));
+  }
+  void Clear();
+
+  template <class T>
+  Stats GetStats() const {
+    auto it = entries.find(std::type_index(typeid(T)));
+    return it != entries.end() ? it->second.stats : Stats{};
+  }
+  void DumpStats(std::ostream &os) const;
+
+private:
+  struct ResultBase {
+    virtual ~ResultBase() = default;
+  };
+  template <class T>
+  struct Result final : ResultBase {
+    Result(std::unique_ptr<T> value) : value(std::move(value)) {}
+    std::unique_ptr<T> value;
+  };
+
+  struct Entry {
+    std::unique_ptr<ResultBase> result;
+    bool dependsOnInsts = true;
+    // analyses computed with this one
+    std::vector<std::type_index> dependents;
+    Stats stats;
+  };
+
+  template <class T>
+  Entry &GetEntry() {
+    auto [it, inserted] = entries.try_emplace(std::type_index(typeid(T)));
+    if (inserted) {
+      it->second.dependsOnInsts = AnalysisInfo<T>::kDependsOnInsts;
+      it->second.stats.name = AnalysisInfo<T>::kName;
+      order.push_back(it->first);
+    }
+    return it->second;
+  }
+
+  void AddDependent(Entry &entry, std::type_index dependent);
+  void Invalidate(std::type_index id);
+
+private:
+  Graph &graph;
+  std::unordered_map<std::type_index, Entry> entries;
+  // analyses in the order of first request, for dumps
+  std::vector<std::type_index> order;
+  // analyses being computed, innermost last
+  std::vector<std::type_index> computing;
+};
+
+// Transformation of one function. Passes get analyses from the manager
+// and report which of them are still valid.
+class FunctionPass {
+public:
+  virtual ~FunctionPass() = default;
+
+  virtual const char *GetName() const = 0;
+  virtual PreservedAnalyses Run(Graph &graph, AnalysisManager &am) = 0;
+};
+
+class PassManager {
+public:
+  struct Stats {
+    const char *name = nullptr;
+    uint64_t numRuns = 0;
+    // runs that changed the function
+    uint64_t numChanges = 0;
+    double seconds = 0;
+  };
+
+  void AddPass(std::unique_ptr<FunctionPass> pass) {
+    passes.push_back(std::move(pass));
+    stats.push_back({passes.back()->GetName()});
+  }
+  template <class P, class... Args>
+  void AddPass(Args &&...args) {
+    AddPass(std::make_unique<P>(std::forward<Args>(args)...));
+  }
+
+  // run the passes in order, invalidate analyses after every pass
+  void Run(Graph &graph, AnalysisManager &am);
+
+  // per pass, in the order of addition
+  const std::vector<Stats> &GetStats() const { return stats; }
+  void DumpStats(std::ostream &os) const;
+
+private:
+  std::vector<std::unique_ptr<FunctionPass>> passes;
+  std::vector<Stats> stats;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <IR/include/BasicBlock.h>
+#include <IR/include/Graph.h>
+#include <passes/Liveness.h>
+#include <passes/LoopAnalysis.h>
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Linear-scan register allocation over SSA live intervals, see "Linear
+// Scan Register Allocation" by Poletto and Sarkar.
+//
+// Blocks are linearized in reverse of the liveness order, so blocks of
+// every loop are contiguous and a value live in a loop has a single
+// interval over it. Every instruction takes two positions: operands are
+// read at the first one, the result is written at the second one. Phi
+// results are written at the start of their block, phi operands are read
+// at the end of the predecessor.
+//
+// When no register is free, the interval with the smallest spill weight
+// is spilled: weight is the number of defs and uses, each one scaled by
+// 10^(loop depth). A spilled value is stored once after its definition
+// and reloaded before every use.
+class RegAlloc {
+public:
+  static constexpr uint32_t kSpilled = UINT32_MAX;
+
+  struct Interval {
+    Inst *value = nullptr;
+    uint32_t start = UINT32_MAX;
+    uint32_t end = 0; // exclusive
+    double weight = 0;
+    uint32_t numUses = 0;
+    uint32_t reg = kSpilled;
+    uint32_t spillSlot = kSpilled;
+  };
+
+  struct Stats {
+    uint32_t numValues = 0;
+    uint32_t numSpilled = 0;
+    // static counts of inserted memory operations
+    uint32_t numSpillStores = 0;
+    uint32_t numReloads = 0;
+    // the same operations weighted by 10^(loop depth)
+    double weightedSpillCost = 0;
+  };
+
+  RegAlloc(const Graph &graph, const LoopTree &loopTree,
+           const Liveness &liveness, uint32_t numRegs);
+
+  uint32_t GetNumRegisters() const { return numRegs; }
+  const std::vector<BBlockPtr> &GetLinearOrder() const { return order; }
+
+  // register of the value, kSpilled if it lives in a stack slot
+  uint32_t GetRegister(const Inst *inst) const {
+    return GetInterval(inst).reg;
+  }
+  bool IsSpilled(const Inst *inst) const {
+    return GetInterval(inst).reg == kSpilled;
+  }
+  const Interval &GetInterval(const Inst *inst) const {
+    return intervals[value2idx.at(inst)];
+  }
+  const std::vector<Interval> &GetIntervals() const { return intervals; }
+
+  const Stats &GetStats() const { return stats; }
+  void DumpReport(std::ostream &os) const;
+
+private:
+  void BuildIntervals(const LoopTree &loopTree, const Liveness &liveness);
+  void Allocate();
+  void Spill(Interval &interval);
+
+private:
+  uint32_t numRegs;
+  std::vector<BBlockPtr> order;
+
+  std::vector<Interval> intervals;
+  std::unordered_map<const Inst *, uint32_t> value2idx;
+  uint32_t numSpillSlots = 0;
+
+  Stats stats;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <passes/PassManager.h>
+
+#include <cstdint>
+
+// Sparse conditional constant propagation, see "Constant Propagation with
+// Conditional Branches" by Wegman and Zadeck. Every value starts as
+// undefined and can only go down to a constant and then to overdefined.
+// Blocks are visited once an incoming edge becomes executable and values
+// are revisited along def-use chains when an operand changes, so a phi
+// ignores the operands of edges which are never taken.
+//
+// The results are applied at once: constant values are replaced with
+// immediates, 'jeq' and 'jne' with a single executable edge become 'jmp',
+// phis left with a single executable edge are replaced with its operand
+// and blocks which are never executed are erased from the graph.
+class SCCP : public FunctionPass {
+public:
+  // accumulated over all runs
+  struct Stats {
+    uint64_t numFoldedInsts = 0;
+    uint64_t numFoldedBranches = 0;
+    uint64_t numErasedBlocks = 0;
+    // instructions of the erased blocks
+    uint64_t numErasedInsts = 0;
+  };
+
+  const char *GetName() const override { return "SCCP"; }
+  PreservedAnalyses Run(Graph &graph, AnalysisManager &am) override;
+
+  const Stats &GetStats() const { return stats; }
+
+private:
+  Stats stats;
+};
@@ -0,0 +1,87 @@
+#include <passes/DCE.h>
+
+#include <support/BitVector.h>
+
+#include <cassert>
+#include <vector>
+
+namespace {
+// mark the defs of the operands of 'inst', defs at 'walked' and above were
+// already passed by the walk and go to the worklist
+void MarkOperands(const Inst *inst, uint32_t walked, BitVector &live,
+                  std::vector<Inst *> &worklist) {
+  for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+    const Operand *opnd = inst->GetOperand(i);
+    if (!opnd->IsInst()) {
+      continue;
+    }
+    Inst *def = static_cast<const InstOperand *>(opnd)->GetInst();
+    assert(def->GetIndex() < live.size() && def->IsLinked() &&
+           "operand is defined outside of the graph");
+    if (live.TestAndSet(def->GetIndex()) && def->GetIndex() >= walked) {
+      worklist.push_back(def);
+    }
+  }
+}
+} // namespace
+
+PreservedAnalyses DCE::Run(Graph &graph, AnalysisManager & /*am*/) {
+  const auto &blocks = graph.GetBlocks();
+  uint32_t numInsts = 0;
+  for (const auto &block : blocks) {
+    numInsts += block->GetInstCount();
+  }
+
+  // number the instructions in layout order, roots are live
+  BitVector live(numInsts);
+  uint32_t index = 0;
+  for (const auto &block : blocks) {
+    for (const auto inst : block->GetInstList()) {
+      if (inst->IsTerminator() || inst->HasSideEffects()) {
+        live.Set(index);
+      }
+      inst->SetIndex(index++);
+    }
+  }
+
+  // Walk backwards and mark the operands of live instructions. Most values
+  // are defined above their uses and are marked before the walk gets to
+  // them, so memory is visited in allocation order instead of chasing
+  // def-use chains. Values the walk has passed, phi operands coming over
+  // back edges, go through the worklist.
+  std::vector<Inst *> worklist;
+  for (auto blockIt = blocks.rbegin(); blockIt != blocks.rend(); ++blockIt) {
+    auto &insts = (*blockIt)->GetInstList();
+    for (auto it = insts.end(); it != insts.begin();) {
+      Inst *inst = *--it;
+      if (live.Test(inst->GetIndex())) {
+        MarkOperands(inst, inst->GetIndex(), live, worklist);
+      }
+    }
+  }
+  while (!worklist.empty()) {
+    Inst *inst = worklist.back();
+    worklist.pop_back();
+    MarkOperands(inst, 0, live, worklist);
+  }
+
+  if (live.Count() == numInsts) {
+    return PreservedAnalyses::All();
+  }
+  // dead instructions are used by dead instructions only, their use lists
+  // empty out as the users are dropped
+  for (const auto &block : blocks) {
+    for (auto it = block->InstBegin(); it != block->InstEnd();) {
+      Inst *inst = *it;
+      if (live.Test(inst->GetIndex())) {
+        ++it;
+        continue;
+      }
+      stats.numErasedPhis += inst->IsPhi();
+      ++stats.numErasedInsts;
+      inst->DropAllReferences();
+      it = block->Erase(inst);
+    }
+  }
+  return PreservedAnalyses::CFG();
+}
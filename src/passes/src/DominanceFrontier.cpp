@@ -0,0 +1,129 @@
+#include <passes/DominanceFrontier.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+
+DominanceFrontier::DominanceFrontier(const Graph &graph,
+                                     const DominatorTree &domTree)
+    : domTree(domTree), frontiers(graph.GetSize()),
+      isDef(graph.GetSize(), 0), inQueue(graph.GetSize(), 0),
+      visited(graph.GetSize(), 0) {
+  using NodePtr = DomTreeNode::NodePtr;
+
+  // Only join points are in frontiers, the entry is a join point if it has
+  // predecessors. Walk up from every predecessor of the join point to its
+  // idom, the join point is in the frontier of every block on the way.
+  for (const auto &block : graph.GetBlocks()) {
+    const auto &preds = block->GetPredessors();
+    bool isJoin = preds.size() >= 2 ||
+                  (block == graph.GetEntry() && !preds.empty());
+    if (!isJoin || !domTree.IsReachable(block)) {
+      continue;
+    }
+    BBlockPtr idom = domTree.GetIDom(block);
+    for (const auto &pred : preds) {
+      if (!domTree.IsReachable(pred)) {
+        continue;
+      }
+      for (BBlockPtr runner = pred; runner != idom;
+           runner = domTree.GetIDom(runner)) {
+        auto &frontier = frontiers[runner->GetId()];
+        // blocks are visited in order, so a duplicate is always the last
+        if (!frontier.empty() && frontier.back() == block) {
+          break;
+        }
+        frontier.push_back(block);
+      }
+    }
+  }
+
+  minJoinLevel.assign(graph.GetSize(), UINT32_MAX);
+  if (graph.GetSize() == 0) {
+    return;
+  }
+  std::vector<NodePtr> preorder = {domTree.GetRoot()};
+  for (size_t i = 0; i < preorder.size(); ++i) {
+    const auto &childs = preorder[i]->GetChildren();
+    preorder.insert(preorder.end(), childs.begin(), childs.end());
+  }
+  // children go after parents, so the reverse order is bottom-up
+  for (auto it = preorder.rbegin(); it != preorder.rend(); ++it) {
+    NodePtr node = *it;
+    uint32_t &level = minJoinLevel[node->GetBBlock()->GetId()];
+    for (const auto &succ : node->GetBBlock()->GetSuccessors()) {
+      NodePtr succNode = domTree.GetNode(succ);
+      if (succNode->GetIDom() != node) {
+        level = std::min(level, succNode->GetLevel());
+      }
+    }
+    if (NodePtr idom = node->GetIDom()) {
+      uint32_t &idomLevel = minJoinLevel[idom->GetBBlock()->GetId()];
+      idomLevel = std::min(idomLevel, level);
+    }
+  }
+}
+
+void DominanceFrontier::GetIteratedFrontier(
+    const std::vector<BBlockPtr> &defBlocks, std::vector<BBlockPtr> &result) {
+  using NodePtr = DomTreeNode::NodePtr;
+
+  result.clear();
+  if (++epoch == 0) {
+    // counter wrapped, forget all old marks
+    std::fill(isDef.begin(), isDef.end(), 0);
+    std::fill(inQueue.begin(), inQueue.end(), 0);
+    std::fill(visited.begin(), visited.end(), 0);
+    epoch = 1;
+  }
+
+  // deepest nodes are processed first
+  std::priority_queue<std::pair<uint32_t, NodePtr>> queue;
+  for (const auto &block : defBlocks) {
+    NodePtr node = domTree.GetNode(block);
+    if (node && Mark(isDef, epoch, block)) {
+      queue.emplace(node->GetLevel(), node);
+    }
+  }
+
+  // Walk the dominator subtree of every queued node. A join edge to a node
+  // not deeper than the root of the walk leads to the iterated frontier.
+  // Subtrees are never walked twice: deeper roots come first.
+  std::vector<NodePtr> worklist;
+  while (!queue.empty()) {
+    NodePtr root = queue.top().second;
+    uint32_t rootLevel = root->GetLevel();
+    queue.pop();
+
+    worklist.assign(1, root);
+    Mark(visited, epoch, root->GetBBlock());
+    while (!worklist.empty()) {
+      NodePtr node = worklist.back();
+      worklist.pop_back();
+
+      for (const auto &succ : node->GetBBlock()->GetSuccessors()) {
+        NodePtr succNode = domTree.GetNode(succ);
+        if (succNode->GetIDom() == node || succNode->GetLevel() > rootLevel ||
+            !Mark(inQueue, epoch, succ)) {
+          // dominator tree edge, too deep or already found
+          continue;
+        }
+        result.push_back(succ);
+        if (isDef[succ->GetId()] != epoch) {
+          queue.emplace(succNode->GetLevel(), succNode);
+        }
+      }
+
+      for (NodePtr child : node->GetChildren()) {
+        if (minJoinLevel[child->GetBBlock()->GetId()] <= rootLevel &&
+            Mark(visited, epoch, child->GetBBlock())) {
+          worklist.push_back(child);
+        }
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end(), [](BBlockPtr lhs, BBlockPtr rhs) {
+    return lhs->GetId() < rhs->GetId();
+  });
+}
@@ -0,0 +1,500 @@
+#include <passes/DominatorTree.h>
+
+#include <queue>
+
+namespace {
+// State of Semi-NCA, all arrays are indexed by DFS preorder number.
+// Number 0 is reserved for "not visited", the DFS root gets number 1.
+class SemiNCAInfo {
+public:
+  // 'num' maps block id to preorder number, it must be all zeros and is
+  // zeroed back on destruction, so it can be reused without clearing
+  explicit SemiNCAInfo(std::vector<uint32_t> &num) : num(num) {}
+
+  ~SemiNCAInfo() {
+    for (size_t i = 1; i < vertex.size(); ++i) {
+      num[vertex[i]->GetId()] = 0;
+    }
+  }
+
+  // DFS from 'root', successor 'succ' of 'curr' is entered only if
+  // 'descend(curr, succ)' is true
+  template <class Descend> void Dfs(BBlockPtr root, Descend descend) {
+    vertex.assign(1, nullptr);
+    idom.assign(1, 0);
+
+    // pairs of (block, preorder number of the parent)
+    std::vector<std::pair<BBlockPtr, uint32_t>> nodesToVisit;
+    nodesToVisit.emplace_back(root, 0);
+    while (!nodesToVisit.empty()) {
+      auto [curr, currParent] = nodesToVisit.back();
+      nodesToVisit.pop_back();
+      if (num[curr->GetId()] != 0) {
+        continue;
+      }
+
+      uint32_t n = vertex.size();
+      num[curr->GetId()] = n;
+      vertex.push_back(curr);
+      idom.push_back(currParent);
+
+      const auto &succs = curr->GetSuccessors();
+      for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+        if (num[(*it)->GetId()] == 0 && descend(curr, *it)) {
+          nodesToVisit.emplace_back(*it, n);
+        }
+      }
+    }
+
+    info.resize(vertex.size());
+    for (uint32_t i = 0; i < vertex.size(); ++i) {
+      info[i] = {idom[i], i, i};
+    }
+  }
+
+  void Run() {
+    uint32_t size = vertex.size();
+    // semidominators in reverse preorder
+    for (uint32_t i = size - 1; i >= 2; --i) {
+      uint32_t &semi = info[i].semi;
+      semi = info[i].parent;
+      for (const auto &pred : vertex[i]->GetPredessors()) {
+        uint32_t v = num[pred->GetId()];
+        if (v == 0) {
+          // predecessor is not visited by the DFS
+          continue;
+        }
+        uint32_t semiU = info[Eval(v, i + 1)].semi;
+        if (semiU < semi) {
+          semi = semiU;
+        }
+      }
+    }
+
+    // immediate dominator is the nearest common ancestor of the DFS parent
+    // and the semidominator
+    for (uint32_t i = 2; i < size; ++i) {
+      uint32_t candidate = idom[i];
+      while (candidate > info[i].semi) {
+        candidate = idom[candidate];
+      }
+      idom[i] = candidate;
+    }
+  }
+
+  uint32_t GetSize() const { return vertex.size(); }
+  BBlockPtr GetVertex(uint32_t i) const { return vertex[i]; }
+  BBlockPtr GetIDom(uint32_t i) const { return vertex[idom[i]]; }
+
+private:
+  // vertex with minimal semidominator on the path from 'v' to the last
+  // linked ancestor, compresses the path on the way
+  uint32_t Eval(uint32_t v, uint32_t lastLinked) {
+    if (info[v].parent < lastLinked) {
+      return info[v].label;
+    }
+
+    evalStack.clear();
+    do {
+      evalStack.push_back(v);
+      v = info[v].parent;
+    } while (info[v].parent >= lastLinked);
+
+    uint32_t p = v;
+    uint32_t pLabel = info[p].label;
+    do {
+      v = evalStack.back();
+      evalStack.pop_back();
+      info[v].parent = info[p].parent;
+      if (info[pLabel].semi < info[info[v].label].semi) {
+        info[v].label = pLabel;
+      } else {
+        pLabel = info[v].label;
+      }
+      p = v;
+    } while (!evalStack.empty());
+
+    return info[v].label;
+  }
+
+private:
+  // fields used together by Eval are kept together
+  struct Info {
+    uint32_t parent; // DFS tree parent, compressed by Eval
+    uint32_t semi;
+    uint32_t label;
+  };
+
+  std::vector<BBlockPtr> vertex;
+  std::vector<Info> info;
+  std::vector<uint32_t> idom;
+  std::vector<uint32_t> evalStack;
+
+  std::vector<uint32_t> &num;
+};
+} // namespace
+
+void DominatorTree::InitFrom(const Graph &graph) {
+  Grow(graph);
+  if (graph.GetSize() == 0) {
+    return;
+  }
+  // the node of the entry is created first, so it is the root
+  RebuildSubtree(GetOrCreateNode(graph.GetEntry()));
+  ComputeDfsIntervals();
+}
+
+void DominatorTree::ComputeDfsIntervals() {
+  intervals.assign(block2node.size(), DfsInterval());
+  if (GetBlocks().empty()) {
+    return;
+  }
+
+  // pairs of (node, index of the next child to visit)
+  std::vector<std::pair<NodePtr, size_t>> nodesToVisit;
+  uint32_t counter = 0;
+  nodesToVisit.emplace_back(GetRoot(), 0);
+  intervals[GetRoot()->GetBBlock()->GetId()].in = counter++;
+  while (!nodesToVisit.empty()) {
+    auto &[node, childIdx] = nodesToVisit.back();
+    const auto &childs = node->GetChildren();
+    if (childIdx == childs.size()) {
+      intervals[node->GetBBlock()->GetId()].out = counter++;
+      nodesToVisit.pop_back();
+      continue;
+    }
+
+    NodePtr child = childs[childIdx++];
+    intervals[child->GetBBlock()->GetId()].in = counter++;
+    nodesToVisit.emplace_back(child, 0);
+  }
+}
+
+void DominatorTree::Grow(const Graph &graph) {
+  // blocks may be created after the tree
+  size_t size = graph.GetSize();
+  if (block2node.size() < size) {
+    idoms.resize(size, nullptr);
+    block2node.resize(size, nullptr);
+    dfsNum.resize(size, 0);
+    stamps.resize(size, 0);
+  }
+}
+
+DominatorTree::NodePtr DominatorTree::GetOrCreateNode(BBlockPtr block) {
+  NodePtr &node = block2node[block->GetId()];
+  if (!node) {
+    node = CreateNode(block, nullptr);
+  }
+  return node;
+}
+
+void DominatorTree::SetIDom(NodePtr node, NodePtr idom) {
+  node->SetIDom(idom);
+  idoms[node->GetBBlock()->GetId()] = idom ? idom->GetBBlock() : nullptr;
+}
+
+void DominatorTree::UpdateLevels(NodePtr node) {
+  std::vector<NodePtr> nodesToVisit = {node};
+  while (!nodesToVisit.empty()) {
+    NodePtr curr = nodesToVisit.back();
+    nodesToVisit.pop_back();
+    for (NodePtr child : curr->GetChildren()) {
+      if (child->GetLevel() != curr->GetLevel() + 1) {
+        child->SetLevel(curr->GetLevel() + 1);
+        nodesToVisit.push_back(child);
+      }
+    }
+  }
+}
+
+DominatorTree::NodePtr DominatorTree::FindNCD(NodePtr lhs,
+                                              NodePtr rhs) const {
+  while (lhs != rhs) {
+    if (lhs->GetLevel() < rhs->GetLevel()) {
+      std::swap(lhs, rhs);
+    }
+    lhs = lhs->GetIDom();
+  }
+  return lhs;
+}
+
+uint32_t DominatorTree::NewEpoch() {
+  if (++epoch == 0) {
+    // counter wrapped, forget all old marks
+    std::fill(stamps.begin(), stamps.end(), 0);
+    epoch = 1;
+  }
+  return epoch;
+}
+
+void DominatorTree::MarkSubtree(NodePtr root, std::vector<NodePtr> &subtree) {
+  NewEpoch();
+  subtree.assign(1, root);
+  Mark(root->GetBBlock());
+  for (size_t i = 0; i < subtree.size(); ++i) {
+    for (NodePtr child : subtree[i]->GetChildren()) {
+      Mark(child->GetBBlock());
+      subtree.push_back(child);
+    }
+  }
+}
+
+bool DominatorTree::HasProperSupport(NodePtr node) const {
+  // the node stays reachable if some predecessor isn't dominated by it
+  for (const auto &pred : node->GetBBlock()->GetPredessors()) {
+    NodePtr predNode = GetNode(pred);
+    if (predNode && FindNCD(node, predNode) != node) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void DominatorTree::RebuildSubtree(NodePtr root) {
+  // After a deletion every block dominated by 'root' is reached from it
+  // without leaving the subtree, so the DFS is restricted to the subtree.
+  // Only the whole tree may gain blocks.
+  bool whole = root == GetRoot();
+  std::vector<NodePtr> subtree;
+  MarkSubtree(root, subtree);
+
+  SemiNCAInfo info(dfsNum);
+  info.Dfs(root->GetBBlock(), [this, whole](BBlockPtr, BBlockPtr succ) {
+    return whole || IsMarked(succ);
+  });
+  info.Run();
+
+  for (NodePtr node : subtree) {
+    if (node == root) {
+      // keep the link to its own idom
+      NodePtr rootIDom = root->GetIDom();
+      SetIDom(root, nullptr);
+      root->Detach();
+      SetIDom(root, rootIDom);
+    } else {
+      node->Detach();
+      idoms[node->GetBBlock()->GetId()] = nullptr;
+    }
+  }
+
+  // nodes are attached in preorder, so the idom node is always attached
+  for (uint32_t i = 2; i < info.GetSize(); ++i) {
+    SetIDom(GetOrCreateNode(info.GetVertex(i)),
+            block2node[info.GetIDom(i)->GetId()]);
+  }
+}
+
+void DominatorTree::InsertReachable(NodePtr from, NodePtr to) {
+  // After insertion of (from, to) a node 'v' is affected iff it is reached
+  // from 'to' by a path where every node is deeper than level(v) - 1 and
+  // level(v) > level(NCD) + 1. Affected nodes are found in the decreasing
+  // level order, every affected node moves right under NCD.
+  NodePtr ncd = FindNCD(from, to);
+  if (ncd == to || ncd->GetLevel() + 1 >= to->GetLevel()) {
+    return;
+  }
+  uint32_t ncdLevel = ncd->GetLevel();
+
+  NewEpoch();
+  std::priority_queue<std::pair<uint32_t, NodePtr>> bucket;
+  std::vector<NodePtr> affected;
+  std::vector<NodePtr> unaffected;
+
+  bucket.emplace(to->GetLevel(), to);
+  Mark(to->GetBBlock());
+  while (!bucket.empty()) {
+    NodePtr node = bucket.top().second;
+    bucket.pop();
+    affected.push_back(node);
+    uint32_t currentLevel = node->GetLevel();
+
+    // deeper nodes are not affected themselves, but lead to affected ones
+    while (true) {
+      for (const auto &succ : node->GetBBlock()->GetSuccessors()) {
+        NodePtr succNode = GetNode(succ);
+        assert(succNode && "successor of reachable block is unreachable");
+        uint32_t succLevel = succNode->GetLevel();
+        if (succLevel <= ncdLevel + 1 || !Mark(succ)) {
+          continue;
+        }
+        if (succLevel > currentLevel) {
+          unaffected.push_back(succNode);
+        } else {
+          bucket.emplace(succLevel, succNode);
+        }
+      }
+      if (unaffected.empty()) {
+        break;
+      }
+      node = unaffected.back();
+      unaffected.pop_back();
+    }
+  }
+
+  for (NodePtr node : affected) {
+    SetIDom(node, ncd);
+  }
+  for (NodePtr node : affected) {
+    UpdateLevels(node);
+  }
+}
+
+void DominatorTree::InsertUnreachable(NodePtr from, BBlockPtr to) {
+  // New blocks are entered only through 'to', so Semi-NCA from 'to' gives
+  // their dominators. Their edges to reachable blocks are inserted after.
+  std::vector<std::pair<BBlockPtr, BBlockPtr>> edgesToReachable;
+  {
+    SemiNCAInfo info(dfsNum);
+    info.Dfs(to, [this, &edgesToReachable](BBlockPtr curr, BBlockPtr succ) {
+      if (IsReachable(succ)) {
+        edgesToReachable.emplace_back(curr, succ);
+        return false;
+      }
+      return true;
+    });
+    info.Run();
+
+    SetIDom(GetOrCreateNode(to), from);
+    for (uint32_t i = 2; i < info.GetSize(); ++i) {
+      SetIDom(GetOrCreateNode(info.GetVertex(i)),
+              block2node[info.GetIDom(i)->GetId()]);
+    }
+  }
+
+  for (const auto &[src, dst] : edgesToReachable) {
+    InsertReachable(GetNode(src), GetNode(dst));
+  }
+}
+
+void DominatorTree::DeleteReachable(NodePtr from, NodePtr to) {
+  NodePtr ncd = FindNCD(from, to);
+  if (to->GetIDom() != from || HasProperSupport(to)) {
+    // 'to' stays reachable
+    RebuildSubtree(ncd);
+    return;
+  }
+
+  // The subtree of 'to' becomes unreachable, blocks it leads to may lose
+  // their dominators. Rebuild from NCD of all of them.
+  std::vector<NodePtr> subtree;
+  MarkSubtree(to, subtree);
+  NodePtr top = ncd;
+  for (NodePtr node : subtree) {
+    for (const auto &succ : node->GetBBlock()->GetSuccessors()) {
+      if (!IsMarked(succ)) {
+        top = FindNCD(top, GetNode(succ));
+      }
+    }
+  }
+  RebuildSubtree(top);
+}
+
+bool DominatorTree::InsertEdgeImpl(Graph &graph, BBlockPtr from,
+                                   BBlockPtr to) {
+  graph.CreateEdge(from, to);
+  Grow(graph);
+
+  NodePtr fromNode = GetNode(from);
+  if (!fromNode) {
+    // unreachable edge changes nothing
+    return false;
+  }
+  if (NodePtr toNode = GetNode(to)) {
+    InsertReachable(fromNode, toNode);
+  } else {
+    InsertUnreachable(fromNode, to);
+  }
+  return true;
+}
+
+bool DominatorTree::DeleteEdgeImpl(Graph &graph, BBlockPtr from,
+                                   BBlockPtr to) {
+  graph.RemoveEdge(from, to);
+  Grow(graph);
+
+  NodePtr fromNode = GetNode(from);
+  NodePtr toNode = GetNode(to);
+  if (!fromNode || !toNode || FindNCD(fromNode, toNode) == toNode) {
+    // unreachable edge or edge to a dominator changes nothing
+    return false;
+  }
+  DeleteReachable(fromNode, toNode);
+  return true;
+}
+
+void DominatorTree::InsertEdge(Graph &graph, BBlockPtr from, BBlockPtr to) {
+  if (InsertEdgeImpl(graph, from, to)) {
+    ComputeDfsIntervals();
+  }
+}
+
+void DominatorTree::DeleteEdge(Graph &graph, BBlockPtr from, BBlockPtr to) {
+  if (DeleteEdgeImpl(graph, from, to)) {
+    ComputeDfsIntervals();
+  }
+}
+
+void DominatorTree::RemoveBlock(Graph &graph, BBlockPtr block) {
+  bool changed = false;
+  while (!block->GetSuccessors().empty()) {
+    changed |= DeleteEdgeImpl(graph, block, block->GetSuccessors().front());
+  }
+  while (!block->GetPredessors().empty()) {
+    changed |= DeleteEdgeImpl(graph, block->GetPredessors().front(), block);
+  }
+  if (changed) {
+    ComputeDfsIntervals();
+  }
+}
+
+void DominatorTree::ApplyUpdates(Graph &graph,
+                                 const std::vector<Update> &updates) {
+  // past this ratio one rebuild is cheaper than separate updates
+  constexpr size_t kRebuildRatio = 16;
+  if (updates.size() * kRebuildRatio <= graph.GetSize()) {
+    bool changed = false;
+    for (const auto &update : updates) {
+      if (update.kind == Update::kInsert) {
+        changed |= InsertEdgeImpl(graph, update.from, update.to);
+      } else {
+        changed |= DeleteEdgeImpl(graph, update.from, update.to);
+      }
+    }
+    if (changed) {
+      ComputeDfsIntervals();
+    }
+    return;
+  }
+
+  for (const auto &update : updates) {
+    if (update.kind == Update::kInsert) {
+      graph.CreateEdge(update.from, update.to);
+    } else {
+      graph.RemoveEdge(update.from, update.to);
+    }
+  }
+  Grow(graph);
+  RebuildSubtree(GetRoot());
+  ComputeDfsIntervals();
+}
+
+bool DominatorTree::Verify(const Graph &graph) const {
+  DominatorTree fresh(graph);
+  for (const auto &block : graph.GetBlocks()) {
+    NodePtr node = GetNode(block);
+    if (IsReachable(block) != fresh.IsReachable(block) ||
+        GetIDom(block) != fresh.GetIDom(block)) {
+      return false;
+    }
+    if (!node || node == GetRoot()) {
+      continue;
+    }
+    NodePtr idom = node->GetIDom();
+    if (idom->GetBBlock() != GetIDom(block) ||
+        node->GetLevel() != idom->GetLevel() + 1) {
+      return false;
+    }
+  }
+  return true;
+}
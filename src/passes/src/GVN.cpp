@@ -0,0 +1,143 @@
+#include <passes/GVN.h>
+
+#include <support/ScopedHashMap.h>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace {
+// opcode and the value numbers of the operands: instructions by address,
+// immediates by value
+struct Expression {
+  uint32_t op = OP_undef;
+  // bit i is set if operand i is an immediate
+  uint32_t immMask = 0;
+  uint64_t lhs = 0;
+  uint64_t rhs = 0;
+
+  bool operator==(const Expression &other) const {
+    return op == other.op && immMask == other.immMask && lhs == other.lhs &&
+           rhs == other.rhs;
+  }
+};
+
+struct ExpressionHash {
+  size_t operator()(const Expression &expr) const {
+    constexpr uint64_t kMul = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = expr.op | uint64_t(expr.immMask) << 16;
+    hash = (hash ^ expr.lhs) * kMul;
+    hash = (hash ^ expr.rhs) * kMul;
+    return hash ^ (hash >> 32);
+  }
+};
+
+using LeaderMap = ScopedHashMap<Expression, Inst *, ExpressionHash>;
+
+std::pair<uint64_t, bool> GetValueNumber(const Operand *opnd) {
+  if (opnd->IsImm()) {
+    return {static_cast<const ImmOperand *>(opnd)->GetValue(), true};
+  }
+  assert(opnd->IsInst() && "value operand expected");
+  auto inst = static_cast<const InstOperand *>(opnd)->GetInst();
+  return {reinterpret_cast<uintptr_t>(inst), false};
+}
+
+bool IsNumbered(Opcode op) {
+  return op == OP_add || op == OP_mul || op == OP_cmp || op == OP_assign;
+}
+
+Expression GetExpression(const Inst *inst) {
+  Expression expr;
+  expr.op = inst->GetOpcode();
+  auto lhs = GetValueNumber(inst->GetOperand(0));
+  auto rhs = inst->GetNumOperands() > 1 ? GetValueNumber(inst->GetOperand(1))
+                                        : std::make_pair(uint64_t(0), false);
+  // 'add a b' and 'add b a' are the same, immediates go second
+  if (inst->IsCommutative() && std::make_pair(lhs.second, lhs.first) >
+                                   std::make_pair(rhs.second, rhs.first)) {
+    std::swap(lhs, rhs);
+  }
+  expr.lhs = lhs.first;
+  expr.rhs = rhs.first;
+  expr.immMask = uint32_t(lhs.second) | uint32_t(rhs.second) << 1;
+  return expr;
+}
+
+class Numbering {
+public:
+  Numbering(Graph &graph, GVN::Stats &stats)
+      : arena(graph.GetArena()), stats(stats) {}
+
+  // true if some instruction was replaced
+  bool Run(const DominatorTree &domTree);
+
+private:
+  void VisitBlock(BBlockPtr block);
+
+private:
+  Arena &arena;
+  GVN::Stats &stats;
+  LeaderMap leaders;
+  bool changed = false;
+};
+
+bool Numbering::Run(const DominatorTree &domTree) {
+  // preorder walk, the scope of a block is popped after its subtree
+  using DomNode = DomTreeNode *;
+  std::vector<std::pair<DomNode, size_t>> stack;
+  leaders.PushScope();
+  VisitBlock(domTree.GetRoot()->GetBBlock());
+  stack.emplace_back(domTree.GetRoot(), 0);
+  while (!stack.empty()) {
+    auto &[node, nextChild] = stack.back();
+    if (nextChild == node->GetChildren().size()) {
+      leaders.PopScope();
+      stack.pop_back();
+      continue;
+    }
+    DomNode child = node->GetChildren()[nextChild++];
+    leaders.PushScope();
+    VisitBlock(child->GetBBlock());
+    stack.emplace_back(child, 0);
+  }
+  return changed;
+}
+
+void Numbering::VisitBlock(BBlockPtr block) {
+  for (auto it = block->InstBegin(); it != block->InstEnd();) {
+    Inst *inst = *it;
+    Operand *replacement = nullptr;
+    if (inst->GetOpcode() == OP_assign && inst->GetOperand(0)->IsInst()) {
+      replacement = inst->GetOperand(0);
+      ++stats.numPropagatedCopies;
+    } else if (IsNumbered(inst->GetOpcode())) {
+      Expression expr = GetExpression(inst);
+      if (Inst **leader = leaders.Find(expr)) {
+        replacement = arena.Create<InstOperand>(*leader);
+        ++stats.numEliminatedInsts;
+      } else {
+        leaders.Insert(expr, inst);
+      }
+    }
+    if (!replacement) {
+      ++it;
+      continue;
+    }
+    // uses are dominated by 'inst' and so by its replacement
+    inst->ReplaceAllUsesWith(replacement);
+    inst->DropAllReferences();
+    it = block->Erase(inst);
+    changed = true;
+  }
+}
+} // namespace
+
+PreservedAnalyses GVN::Run(Graph &graph, AnalysisManager &am) {
+  if (graph.GetSize() == 0) {
+    return PreservedAnalyses::All();
+  }
+  Numbering numbering(graph, stats);
+  bool changed = numbering.Run(am.Get<DominatorTree>());
+  return changed ? PreservedAnalyses::CFG() : PreservedAnalyses::All();
+}
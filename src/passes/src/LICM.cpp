@@ -0,0 +1,285 @@
+#include <passes/LICM.h>
+
+#include <passes/LoopAnalysis.h>
+#include <support/BitVector.h>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace {
+// phis depend on the edge taken, the rest of the values on operands only
+bool IsHoistable(const Inst *inst) {
+  return inst->HasResult() && !inst->IsPhi() && !inst->HasSideEffects();
+}
+
+BBlockPtr GetTarget(const Operand *opnd) {
+  assert(opnd->IsLabel() && "label operand expected");
+  return static_cast<const LabelOperand *>(opnd)->GetLabel()->GetBBlock();
+}
+
+class LoopHoister {
+public:
+  LoopHoister(Graph &graph, LICM::Stats &stats)
+      : graph(graph), stats(stats), numOldBlocks(graph.GetSize()) {}
+
+  // visit the loops inner loops first
+  void Run(const LoopTree &loopTree);
+  // give the created preheaders their place in the layout
+  void PlacePreheaders();
+
+  bool IsCFGChanged() const { return !created.empty(); }
+
+private:
+  struct CreatedPreheader {
+    BBlockPtr head;
+    BBlockPtr preheader;
+    bool beforeHead;
+  };
+
+  void VisitLoop(const LoopTreeNodePtr loop);
+  // blocks of the loop with inner loops and their created preheaders
+  void CollectBody(const LoopTreeNodePtr loop);
+  BBlockPtr GetPreheader(const LoopTreeNodePtr loop);
+  void Hoist(BBlockPtr preheader);
+
+  Graph &graph;
+  LICM::Stats &stats;
+  const size_t numOldBlocks;
+
+  // indexed by loop id
+  std::vector<bool> reducible;
+  std::vector<BBlockPtr> createdPreheaders;
+  std::vector<CreatedPreheader> created;
+
+  // the loop being visited, 'inLoop' is indexed by block id
+  std::vector<BBlockPtr> body;
+  BitVector inLoop;
+  // operands defined in the loop, indexed by Inst::GetIndex
+  std::vector<uint32_t> numLoopOperands;
+  std::vector<Inst *> worklist;
+};
+
+void LoopHoister::Run(const LoopTree &loopTree) {
+  reducible.assign(loopTree.GetSize(), true);
+  createdPreheaders.assign(loopTree.GetSize(), nullptr);
+  // a preheader at most per loop
+  inLoop.Resize(numOldBlocks + loopTree.GetSize());
+
+  // postorder of the loop tree, the root is not a loop
+  std::vector<std::pair<LoopTreeNodePtr, size_t>> stack;
+  stack.emplace_back(loopTree.GetRoot(), 0);
+  while (!stack.empty()) {
+    LoopTreeNodePtr loop = stack.back().first;
+    size_t next = stack.back().second++;
+    if (next < loop->GetInnerLoops().size()) {
+      stack.emplace_back(loop->GetInnerLoops()[next], 0);
+      continue;
+    }
+    stack.pop_back();
+    if (loop != loopTree.GetRoot()) {
+      VisitLoop(loop);
+    }
+  }
+}
+
+void LoopHoister::VisitLoop(const LoopTreeNodePtr loop) {
+  // bodies of irreducible loops are not known, neither are the bodies of
+  // the loops around them
+  bool isReducible = loop->IsReducible();
+  for (const auto &inner : loop->GetInnerLoops()) {
+    isReducible = isReducible && reducible[inner->GetId()];
+  }
+  reducible[loop->GetId()] = isReducible;
+  if (!isReducible) {
+    return;
+  }
+
+  CollectBody(loop);
+  if (BBlockPtr preheader = GetPreheader(loop)) {
+    Hoist(preheader);
+  }
+  for (const auto &block : body) {
+    inLoop.Reset(block->GetId());
+  }
+}
+
+void LoopHoister::CollectBody(const LoopTreeNodePtr loop) {
+  body.clear();
+  std::vector<LoopTreeNodePtr> loops{loop};
+  while (!loops.empty()) {
+    LoopTreeNodePtr curr = loops.back();
+    loops.pop_back();
+    body.push_back(curr->GetHead());
+    const auto &srcs = curr->GetSources();
+    body.insert(body.end(), srcs.begin(), srcs.end());
+    for (const auto &inner : curr->GetInnerLoops()) {
+      loops.push_back(inner);
+      if (BBlockPtr preheader = createdPreheaders[inner->GetId()]) {
+        body.push_back(preheader);
+      }
+    }
+  }
+  for (const auto &block : body) {
+    inLoop.Set(block->GetId());
+  }
+}
+
+BBlockPtr LoopHoister::GetPreheader(const LoopTreeNodePtr loop) {
+  BBlockPtr head = loop->GetHead();
+  if (head == graph.GetEntry()) {
+    // entered from outside of the function
+    return nullptr;
+  }
+  std::vector<BBlockPtr> outside;
+  for (const auto &pred : head->GetPredessors()) {
+    if (!inLoop.Test(pred->GetId())) {
+      outside.push_back(pred);
+    }
+  }
+  assert(!outside.empty() && "loop is not entered through its head");
+  if (outside.size() == 1 && outside.front()->GetSuccessors().size() == 1) {
+    return outside.front();
+  }
+  bool hasPhis = head->PhiBegin() != head->PhiEnd();
+  if (outside.size() > 1 && hasPhis) {
+    // phis take a single value from outside of the loop
+    return nullptr;
+  }
+
+  // Go right before the head so a predecessor falling through to the
+  // head in the layout falls through to the preheader instead. If that
+  // is a block of the loop, the preheader goes to the end of the layout
+  // and the outside predecessors jump to it.
+  BBlockPtr layoutPred = graph.GetBlocks()[head->GetId() - 1];
+  bool beforeHead = !inLoop.Test(layoutPred->GetId());
+
+  BBlockPtr preheader = graph.CreateBlock(head->GetName() + ".preheader");
+  IRBuilder builder(preheader);
+  for (const auto &pred : outside) {
+    graph.RemoveEdge(pred, head);
+    graph.CreateEdge(pred, preheader);
+    Inst *last = pred->GetInstCount() ? pred->GetInstList().Back() : nullptr;
+    if (!last || !last->IsTerminator()) {
+      if (!beforeHead || pred != layoutPred) {
+        builder.SetBBlock(pred);
+        builder.CreateJmp(builder.CreateLabel(preheader));
+      }
+      continue;
+    }
+    // 'jeq' and 'jne' fall through to the other successor
+    size_t labelNo = last->IsJmp() ? 0 : 2;
+    if (last->IsBranch() && GetTarget(last->GetOperand(labelNo)) == head) {
+      last->SetOperand(labelNo, builder.CreateLabel(preheader));
+    }
+  }
+  if (hasPhis) {
+    for (const auto phi : head->GetPhis()) {
+      for (size_t i = 1; i < phi->GetNumOperands(); i += 2) {
+        if (GetTarget(phi->GetOperand(i)) == outside.front()) {
+          phi->SetOperand(i, builder.CreateLabel(preheader));
+        }
+      }
+    }
+  }
+  builder.SetBBlock(preheader);
+  builder.CreateJmp(builder.CreateLabel(head));
+  graph.CreateEdge(preheader, head);
+
+  createdPreheaders[loop->GetId()] = preheader;
+  created.push_back({head, preheader, beforeHead});
+  ++stats.numCreatedPreheaders;
+  return preheader;
+}
+
+void LoopHoister::Hoist(BBlockPtr preheader) {
+  // instructions with all operands defined outside of the loop are
+  // ready, the rest wait for their operands to be hoisted
+  uint32_t numCandidates = 0;
+  for (const auto &block : body) {
+    for (const auto inst : block->GetInstList()) {
+      if (!IsHoistable(inst)) {
+        continue;
+      }
+      uint32_t numInLoop = 0;
+      for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+        const Operand *opnd = inst->GetOperand(i);
+        numInLoop += opnd->IsInst() &&
+                     inLoop.Test(static_cast<const InstOperand *>(opnd)
+                                     ->GetInst()
+                                     ->GetBBlock()
+                                     ->GetId());
+      }
+      inst->SetIndex(numCandidates++);
+      numLoopOperands.push_back(numInLoop);
+      if (!numInLoop) {
+        worklist.push_back(inst);
+      }
+    }
+  }
+
+  // operands are hoisted before their users, so the order of popping is
+  // a valid order in the preheader
+  Inst *last = preheader->GetInstCount() ? preheader->GetInstList().Back()
+                                         : nullptr;
+  Inst *pos = last && last->IsTerminator() ? last : nullptr;
+  while (!worklist.empty()) {
+    Inst *inst = worklist.back();
+    worklist.pop_back();
+    if (pos) {
+      inst->MoveBefore(pos);
+    } else {
+      inst->MoveToEnd(preheader);
+    }
+    ++stats.numHoistedInsts;
+    // a user reading the value twice waits for both uses
+    for (const auto user : inst->GetUsers()) {
+      if (inLoop.Test(user->GetBBlock()->GetId()) && IsHoistable(user) &&
+          --numLoopOperands[user->GetIndex()] == 0) {
+        worklist.push_back(user);
+      }
+    }
+  }
+  numLoopOperands.clear();
+}
+
+void LoopHoister::PlacePreheaders() {
+  if (created.empty()) {
+    return;
+  }
+  std::vector<BBlockPtr> before(numOldBlocks, nullptr);
+  std::vector<BBlockPtr> order;
+  order.reserve(graph.GetSize());
+  for (const auto &preheader : created) {
+    if (preheader.beforeHead) {
+      before[preheader.head->GetId()] = preheader.preheader;
+    }
+  }
+  const auto &blocks = graph.GetBlocks();
+  for (size_t i = 0; i < numOldBlocks; ++i) {
+    if (before[i]) {
+      order.push_back(before[i]);
+    }
+    order.push_back(blocks[i]);
+  }
+  for (const auto &preheader : created) {
+    if (!preheader.beforeHead) {
+      order.push_back(preheader.preheader);
+    }
+  }
+  graph.SetOrder(std::move(order));
+}
+} // namespace
+
+PreservedAnalyses LICM::Run(Graph &graph, AnalysisManager &am) {
+  uint64_t numHoisted = stats.numHoistedInsts;
+  LoopHoister hoister(graph, stats);
+  hoister.Run(am.Get<LoopTree>());
+  hoister.PlacePreheaders();
+
+  if (hoister.IsCFGChanged()) {
+    return PreservedAnalyses::None();
+  }
+  return stats.numHoistedInsts != numHoisted ? PreservedAnalyses::CFG()
+                                             : PreservedAnalyses::All();
+}
@@ -0,0 +1,210 @@
+#include <passes/Liveness.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+static Inst *GetDef(const Operand *opnd) {
+  return opnd->IsInst() ? static_cast<const InstOperand *>(opnd)->GetInst()
+                        : nullptr;
+}
+
+static BBlockPtr GetPred(const PhiInst *phi, size_t numOp) {
+  auto label = static_cast<const LabelOperand *>(phi->GetOperand(numOp + 1));
+  return label->GetLabel()->GetBBlock();
+}
+
+Liveness::Liveness(const Graph &graph, const LoopTree &loopTree)
+    : gen(graph.GetSize()), kill(graph.GetSize()), phiUses(graph.GetSize()) {
+  NumberValues(graph);
+  ComputeLocalSets(graph);
+  liveIn.assign(graph.GetSize(), BitVector(values.size()));
+  liveOut.assign(graph.GetSize(), BitVector(values.size()));
+  ComputeOrder(graph, loopTree);
+  Solve();
+}
+
+void Liveness::NumberValues(const Graph &graph) {
+  for (const auto &block : graph.GetBlocks()) {
+    for (const auto inst : block->GetInstList()) {
+      if (!inst->HasResult()) {
+        continue;
+      }
+      // walk def-use chains, stop at the first non-local use
+      for (const auto use : inst->GetUses()) {
+        Inst *user = use->GetUser();
+        if (user->IsLinked() &&
+            (user->IsPhi() || user->GetBBlock() != block)) {
+          value2idx.emplace(inst, values.size());
+          values.push_back(inst);
+          break;
+        }
+      }
+    }
+  }
+}
+
+void Liveness::ComputeLocalSets(const Graph &graph) {
+  for (const auto &block : graph.GetBlocks()) {
+    auto &blockGen = gen[block->GetId()];
+    auto &blockKill = kill[block->GetId()];
+
+    for (const auto inst : block->GetInstList()) {
+      if (inst->IsPhi()) {
+        auto phi = static_cast<PhiInst *>(inst);
+        for (size_t i = 0; i + 1 < phi->GetNumOperands(); i += 2) {
+          uint32_t idx = GetValueIndex(GetDef(phi->GetOperand(i)));
+          if (idx != npos) {
+            phiUses[GetPred(phi, i)->GetId()].push_back(idx);
+          }
+        }
+      } else {
+        for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+          Inst *def = GetDef(inst->GetOperand(i));
+          uint32_t idx = GetValueIndex(def);
+          // a definition in the same block always goes before the use
+          if (idx != npos && def->GetBBlock() != block) {
+            blockGen.push_back(idx);
+          }
+        }
+      }
+
+      uint32_t idx = GetValueIndex(inst);
+      if (idx != npos) {
+        blockKill.push_back(idx);
+      }
+    }
+  }
+}
+
+void Liveness::ComputeOrder(const Graph &graph, const LoopTree &loopTree) {
+  // base order: successors mostly go before predecessors, unreachable
+  // blocks go last
+  std::vector<uint32_t> rank(graph.GetSize(), UINT32_MAX);
+  auto po = graph.GetPo();
+  uint32_t counter = 0;
+  for (auto it = po.rbegin(); it != po.rend(); ++it) {
+    rank[(*it)->GetId()] = counter++;
+  }
+  for (const auto &block : graph.GetBlocks()) {
+    if (rank[block->GetId()] == UINT32_MAX) {
+      rank[block->GetId()] = counter++;
+    }
+  }
+
+  // Items of a loop are its own blocks and its inner loops. An inner loop
+  // is placed by its last block, for a natural loop it is the header.
+  size_t numLoops = loopTree.GetSize();
+  std::vector<std::vector<BBlockPtr>> loopBlocks(numLoops);
+  for (const auto &block : graph.GetBlocks()) {
+    loopBlocks[loopTree.GetLoopNode(block)->GetId()].push_back(block);
+  }
+
+  // loops in BFS order, outer loops first
+  std::vector<LoopTreeNodePtr> loops = {loopTree.GetRoot()};
+  for (size_t i = 0; i < loops.size(); ++i) {
+    for (const auto &inner : loops[i]->GetInnerLoops()) {
+      loops.push_back(inner);
+    }
+  }
+  std::vector<uint32_t> loopRank(numLoops, 0);
+  for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+    uint32_t &r = loopRank[(*it)->GetId()];
+    for (const auto &block : loopBlocks[(*it)->GetId()]) {
+      r = std::max(r, rank[block->GetId()]);
+    }
+    for (const auto &inner : (*it)->GetInnerLoops()) {
+      r = std::max(r, loopRank[inner->GetId()]);
+    }
+  }
+
+  // item of a loop: (rank, block or inner loop)
+  struct Item {
+    uint32_t rank;
+    BBlockPtr block;
+    LoopTreeNodePtr loop;
+  };
+  auto getItems = [&](LoopTreeNodePtr loop) {
+    std::vector<Item> items;
+    for (const auto &block : loopBlocks[loop->GetId()]) {
+      items.push_back({rank[block->GetId()], block, nullptr});
+    }
+    for (const auto &inner : loop->GetInnerLoops()) {
+      items.push_back({loopRank[inner->GetId()], nullptr, inner});
+    }
+    std::sort(items.begin(), items.end(),
+              [](const Item &lhs, const Item &rhs) {
+                return lhs.rank < rhs.rank;
+              });
+    return items;
+  };
+
+  order.reserve(graph.GetSize());
+  // pairs of (items of a loop, index of the next item)
+  std::vector<std::pair<std::vector<Item>, size_t>> loopsToVisit;
+  loopsToVisit.emplace_back(getItems(loopTree.GetRoot()), 0);
+  while (!loopsToVisit.empty()) {
+    auto &[items, idx] = loopsToVisit.back();
+    if (idx == items.size()) {
+      loopsToVisit.pop_back();
+      continue;
+    }
+    Item item = items[idx++];
+    if (item.block) {
+      order.push_back(item.block);
+    } else {
+      loopsToVisit.emplace_back(getItems(item.loop), 0);
+    }
+  }
+
+  assert(order.size() == graph.GetSize() && "loop tree misses blocks");
+}
+
+void Liveness::Solve() {
+  std::vector<uint32_t> pos(order.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    pos[order[i]->GetId()] = i;
+  }
+
+  // min-heap of positions, every block is queued at most once
+  std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> queue;
+  BitVector queued(order.size(), true);
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    queue.push(i);
+  }
+
+  BitVector newLiveIn(values.size());
+  while (!queue.empty()) {
+    BBlockPtr block = order[queue.top()];
+    queue.pop();
+    queued.Reset(pos[block->GetId()]);
+    ++numVisits;
+
+    uint32_t id = block->GetId();
+    BitVector &out = liveOut[id];
+    for (const auto &succ : block->GetSuccessors()) {
+      out.Union(liveIn[succ->GetId()]);
+    }
+    for (uint32_t idx : phiUses[id]) {
+      out.Set(idx);
+    }
+
+    newLiveIn = out;
+    for (uint32_t idx : kill[id]) {
+      newLiveIn.Reset(idx);
+    }
+    for (uint32_t idx : gen[id]) {
+      newLiveIn.Set(idx);
+    }
+    if (newLiveIn == liveIn[id]) {
+      continue;
+    }
+
+    std::swap(liveIn[id], newLiveIn);
+    for (const auto &pred : block->GetPredessors()) {
+      if (queued.TestAndSet(pos[pred->GetId()])) {
+        queue.push(pos[pred->GetId()]);
+      }
+    }
+  }
+}
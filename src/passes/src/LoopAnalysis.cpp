@@ -1,5 +1,7 @@
 #include <passes/LoopAnalysis.h>
 
+#include <algorithm>
+#include <numeric>
 #include <sstream>
 
 std::string LoopTreeNode::GetName() const {
@@ -40,101 +42,356 @@ void LoopTreeNode::DumpDot(std::ostream &os) const {
   os << "\"]";
 }
 
-bool LoopTree::IsBackEdge(const BBlockPtr bb) const {
-  if (block2node.count(bb) == 0) {
-    return false;
-  }
+void LoopTree::CollectBackEdges(std::vector<uint32_t> &preorder) {
+  size_t size = graph.GetSize();
+  block2node.assign(size, nullptr);
+  preorder.assign(size, 0);
 
-  const auto loopPtr = block2node.at(bb);
-  return loopPtr->GetBackEdges().count(bb) > 0;
-}
+  // blocks on the DFS stack are the targets of back edges
+  BitVector onStack(size);
+  // pairs of (block, index of the next successor)
+  std::vector<std::pair<BBlockPtr, size_t>> stack;
+  uint32_t counter = 0;
+  auto visit = [&](BBlockPtr block) {
+    preorder[block->GetId()] = ++counter;
+    onStack.Set(block->GetId());
+    stack.emplace_back(block, 0);
+  };
 
-bool LoopTree::IsHead(const BBlockPtr bb) const {
-  if (block2node.count(bb) == 0) {
-    return false;
-  }
-
-  const auto loopPtr = block2node.at(bb);
-  return loopPtr->GetHead() == bb;
-}
+  visit(graph.GetEntry());
+  while (!stack.empty()) {
+    auto [curr, idx] = stack.back();
+    const auto &succs = curr->GetSuccessors();
+    if (idx == succs.size()) {
+      onStack.Reset(curr->GetId());
+      stack.pop_back();
+      continue;
+    }
+    ++stack.back().second;
 
-void LoopTree::DfsCollectBackEdges(const BBlockPtr curr) {
-  SetMarker(curr, GREY);
-  for (const auto succ : curr->GetSuccessors()) {
-    auto succMarker = GetMarker(succ);
-    if (succMarker == WHITE) {
-      DfsCollectBackEdges(succ);
-    } else if (succMarker == GREY) {
+    BBlockPtr succ = succs[idx];
+    if (preorder[succ->GetId()] == 0) {
+      visit(succ);
+    } else if (onStack.Test(succ->GetId())) {
       const BBlockPtr head = succ, backEdge = curr;
-      LoopTreeNode loop(head, backEdge);
-      domTree.IsDominate(head, backEdge) ? loop.MarkReducible()
-                                         : loop.MarkIrreducible();
-      auto loopPtr = std::make_shared<LoopTreeNode>(loop);
-      PushBlock(loopPtr);
-      block2node.insert({head, loopPtr});
-      block2node.insert({backEdge, loopPtr});
+      auto loopPtr = block2node[head->GetId()];
+      if (!loopPtr) {
+        loopPtr = CreateNode(head, backEdge);
+        loopPtr->MarkReducible();
+        block2node[head->GetId()] = loopPtr;
+      } else {
+        loopPtr->AddBackEdge(backEdge);
+      }
+      if (!domTree->IsDominate(head, backEdge)) {
+        loopPtr->MarkIrreducible();
+      }
     }
   }
+}
 
-  SetMarker(curr, BLACK);
+uint32_t LoopTree::FindOutermost(std::vector<uint32_t> &outermost,
+                                 uint32_t loopId) {
+  // path halving
+  while (outermost[loopId] != loopId) {
+    outermost[loopId] = outermost[outermost[loopId]];
+    loopId = outermost[loopId];
+  }
+  return loopId;
 }
 
-void LoopTree::ReverseDfsPopulateLoop(const BBlockPtr bb,
-                                      const LoopTreeNodePtr loop) {
-  if (IsBackEdge(bb) && GetMarker(bb) != GREEN) {
-    // populate inner loop
-    auto innerLoop = GetLoopNode(bb);
-    if (innerLoop != loop) {
-      SetMarker(bb, GREEN);
-      PopulateReducibleLoop(innerLoop);
+void LoopTree::PopulateLoop(const LoopTreeNodePtr loop,
+                            const std::vector<uint32_t> &preorder,
+                            std::vector<uint32_t> &outermost,
+                            std::vector<uint32_t> &stamps) {
+  // block is visited by this loop iff stamps[id] == loop id
+  const uint32_t loopId = loop->GetId();
+  // blocks whose predecessors are to be walked
+  std::vector<BBlockPtr> worklist;
+  auto addBlock = [&](BBlockPtr block) {
+    if (stamps[block->GetId()] == loopId) {
+      return;
+    }
+    stamps[block->GetId()] = loopId;
+
+    LoopTreeNodePtr inner = block2node[block->GetId()];
+    if (!inner) {
+      // block without loop, add to sources
+      block2node[block->GetId()] = loop;
+      loop->AddSource(block);
+      worklist.push_back(block);
+      return;
+    }
+
+    uint32_t top = FindOutermost(outermost, inner->GetId());
+    if (top != loopId) {
+      // the outermost loop around the block becomes an inner loop, the
+      // walk continues from its header
+      LoopTreeNodePtr innerLoop = GetBlocks()[top];
       CreateEdge(loop, innerLoop);
-      for (const auto &pred : innerLoop->GetHead()->GetPredessors()) {
-        ReverseDfsPopulateLoop(pred, loop);
+      outermost[top] = loopId;
+      BBlockPtr innerHead = innerLoop->GetHead();
+      if (innerHead == block || stamps[innerHead->GetId()] != loopId) {
+        stamps[innerHead->GetId()] = loopId;
+        worklist.push_back(innerHead);
       }
     }
+    if (!inner->IsReducible()) {
+      // irreducible regions have entries besides the header
+      worklist.push_back(block);
+    }
+  };
+
+  stamps[loop->GetHead()->GetId()] = loopId;
+  for (const auto be : loop->GetBackEdges()) {
+    addBlock(be);
+  }
+  if (!loop->IsReducible()) {
+    // only the head and the back edge sources are known for irreducible
+    // loops
+    return;
   }
 
-  if (GetMarker(bb) != GREEN) {
-    // block without loop, add to sources
-    SetMarker(bb, GREEN);
-    block2node.insert({bb, loop});
-    loop->AddSource(bb);
-    for (const auto &pred : bb->GetPredessors()) {
-      ReverseDfsPopulateLoop(pred, loop);
+  while (!worklist.empty()) {
+    BBlockPtr block = worklist.back();
+    worklist.pop_back();
+    for (const auto &pred : block->GetPredessors()) {
+      // predecessors of a natural loop are dominated by the head, except
+      // the unreachable ones
+      if (preorder[pred->GetId()] != 0) {
+        addBlock(pred);
+      }
     }
   }
 }
 
-void LoopTree::PopulateReducibleLoop(const LoopTreeNodePtr loop) {
-  assert(loop->IsReducible() && "expected reducible loop");
-  BBlockPtr head = loop->GetHead();
-  assert(head);
-  SetMarker(head, GREEN);
-  for (const auto be : loop->GetBackEdges()) {
-    ReverseDfsPopulateLoop(be, loop);
+void LoopTree::PopulateLoops(const std::vector<uint32_t> &preorder) {
+  // inner loops have their heads later in DFS preorder
+  std::vector<LoopTreeNodePtr> loops(GetBlocks().begin() + 1,
+                                     GetBlocks().end());
+  std::sort(loops.begin(), loops.end(),
+            [&preorder](LoopTreeNodePtr lhs, LoopTreeNodePtr rhs) {
+              return preorder[lhs->GetHead()->GetId()] >
+                     preorder[rhs->GetHead()->GetId()];
+            });
+
+  std::vector<uint32_t> outermost(GetSize());
+  std::iota(outermost.begin(), outermost.end(), 0);
+  std::vector<uint32_t> stamps(graph.GetSize(), 0);
+  for (const auto loop : loops) {
+    PopulateLoop(loop, preorder, outermost, stamps);
   }
+  LinkToRoot();
+
+  BitVector reachable(graph.GetSize());
+  for (const auto bb : graph.GetBlocks()) {
+    if (preorder[bb->GetId()] != 0) {
+      reachable.Set(bb->GetId());
+    }
+  }
+  CollectEntries(reachable);
 }
 
-void LoopTree::PopulateLoops() {
-  for (const auto bb : graph.GetPo()) {
-    if (IsHead(bb)) {
-      auto head = bb;
-      auto loop = GetLoopNode(head);
-      // not handled loop
-      if (GetMarker(head) != GREEN) {
-        if (loop->IsReducible()) {
-          PopulateReducibleLoop(loop);
-        }
-        CreateEdge(root, loop);
-      }
+void LoopTree::LinkToRoot() {
+  // outermost loops in creation order
+  for (size_t id = 1; id < GetSize(); ++id) {
+    LoopTreeNodePtr loop = GetBlocks()[id];
+    if (!loop->GetOuterLoop()) {
+      CreateEdge(root, loop);
     }
   }
 
   // blocks without loop, add to root node
   for (const auto bb : graph.GetBlocks()) {
-    if (GetMarker(bb) != GREEN) {
+    if (!block2node[bb->GetId()]) {
       root->AddSource(bb);
-      block2node.insert({bb, root});
+      block2node[bb->GetId()] = root;
+    }
+  }
+}
+
+void LoopTree::CollectEntries(const BitVector &reachable) {
+  // preorder intervals of the loop tree: 'outer' contains 'inner' iff
+  // the interval of 'inner' is nested
+  std::vector<uint32_t> in(GetSize()), out(GetSize());
+  uint32_t counter = 0;
+  // pairs of (loop, index of the next inner loop)
+  std::vector<std::pair<LoopTreeNodePtr, size_t>> stack;
+  in[root->GetId()] = counter++;
+  stack.emplace_back(root, 0);
+  while (!stack.empty()) {
+    auto [loop, idx] = stack.back();
+    if (idx == loop->GetInnerLoops().size()) {
+      out[loop->GetId()] = counter++;
+      stack.pop_back();
+      continue;
+    }
+    ++stack.back().second;
+    LoopTreeNodePtr inner = loop->GetInnerLoops()[idx];
+    in[inner->GetId()] = counter++;
+    stack.emplace_back(inner, 0);
+  }
+  auto contains = [&](LoopTreeNodePtr outer, LoopTreeNodePtr inner) {
+    return in[outer->GetId()] <= in[inner->GetId()] &&
+           out[inner->GetId()] <= out[outer->GetId()];
+  };
+
+  // an edge 'pred -> block' enters every loop around 'block' up to the
+  // first one that contains 'pred', heads are added on creation
+  std::vector<BBlockPtr> lastEntry(GetSize(), nullptr);
+  for (const auto block : graph.GetBlocks()) {
+    if (!reachable.Test(block->GetId())) {
+      continue;
     }
+    for (const auto &pred : block->GetPredessors()) {
+      if (!reachable.Test(pred->GetId())) {
+        continue;
+      }
+      LoopTreeNodePtr predLoop = block2node[pred->GetId()];
+      for (LoopTreeNodePtr loop = block2node[block->GetId()];
+           loop != root && !contains(loop, predLoop);
+           loop = loop->GetOuterLoop()) {
+        if (loop->GetHead() != block && lastEntry[loop->GetId()] != block) {
+          lastEntry[loop->GetId()] = block;
+          loop->AddEntry(block);
+        }
+      }
+    }
+  }
+}
+
+void LoopTree::InitHavlak() {
+  root = CreateNode(true /* isRoot */);
+  size_t size = graph.GetSize();
+  block2node.assign(size, nullptr);
+
+  // iterative DFS: 'number' maps block ids to preorder numbers, 'last' is
+  // the last descendant of every node, so w is an ancestor of v iff
+  // w <= v <= last[w]
+  const uint32_t kUnreached = UINT32_MAX;
+  std::vector<uint32_t> number(size, kUnreached);
+  std::vector<BBlockPtr> blocks;
+  std::vector<uint32_t> last;
+  // pairs of (block, index of the next successor)
+  std::vector<std::pair<BBlockPtr, size_t>> stack;
+  auto visit = [&](BBlockPtr block) {
+    number[block->GetId()] = blocks.size();
+    blocks.push_back(block);
+    last.push_back(0);
+    stack.emplace_back(block, 0);
+  };
+  visit(graph.GetEntry());
+  while (!stack.empty()) {
+    auto [curr, idx] = stack.back();
+    const auto &succs = curr->GetSuccessors();
+    if (idx == succs.size()) {
+      last[number[curr->GetId()]] = blocks.size() - 1;
+      stack.pop_back();
+      continue;
+    }
+    ++stack.back().second;
+    if (number[succs[idx]->GetId()] == kUnreached) {
+      visit(succs[idx]);
+    }
+  }
+
+  const uint32_t numNodes = blocks.size();
+  auto isAncestor = [&last](uint32_t w, uint32_t v) {
+    return w <= v && v <= last[w];
+  };
+
+  // predecessors in preorder numbers, edges from descendants are back
+  // edges
+  std::vector<std::vector<uint32_t>> backPreds(numNodes);
+  std::vector<std::vector<uint32_t>> nonBackPreds(numNodes);
+  for (uint32_t w = 0; w < numNodes; ++w) {
+    for (const auto &pred : blocks[w]->GetPredessors()) {
+      uint32_t v = number[pred->GetId()];
+      if (v == kUnreached) {
+        continue;
+      }
+      if (isAncestor(w, v)) {
+        backPreds[w].push_back(v);
+      } else {
+        nonBackPreds[w].push_back(v);
+      }
+    }
+  }
+
+  // union-find over preorder numbers: a node is collapsed into the head
+  // of the innermost loop processed so far
+  std::vector<uint32_t> header(numNodes);
+  std::iota(header.begin(), header.end(), 0);
+  auto find = [&header](uint32_t v) {
+    while (header[v] != v) {
+      header[v] = header[header[v]];
+      v = header[v];
+    }
+    return v;
+  };
+
+  std::vector<LoopTreeNodePtr> loopOf(numNodes, nullptr);
+  // node is in the body of w iff inBody[node] == w, the same for the
+  // predecessors from outside moved to w
+  std::vector<uint32_t> inBody(numNodes, kUnreached);
+  std::vector<uint32_t> isOuterPred(numNodes, kUnreached);
+  std::vector<uint32_t> body;
+
+  // heads in reverse preorder, inner loops are done first
+  for (uint32_t w = numNodes; w-- > 0;) {
+    if (backPreds[w].empty()) {
+      continue;
+    }
+    BBlockPtr head = blocks[w];
+    LoopTreeNodePtr loop = CreateNode(head, blocks[backPreds[w][0]]);
+    loop->MarkReducible();
+    for (size_t i = 1; i < backPreds[w].size(); ++i) {
+      loop->AddBackEdge(blocks[backPreds[w][i]]);
+    }
+
+    body.clear();
+    for (const auto v : backPreds[w]) {
+      uint32_t x = find(v);
+      if (x != w && inBody[x] != w) {
+        inBody[x] = w;
+        body.push_back(x);
+      }
+    }
+    // 'body' is the worklist as well
+    for (size_t i = 0; i < body.size(); ++i) {
+      for (const auto pred : nonBackPreds[body[i]]) {
+        uint32_t y = find(pred);
+        if (!isAncestor(w, y)) {
+          // the region is entered besides its head, the edge is seen by
+          // outer loops as an edge into w
+          loop->MarkIrreducible();
+          if (isOuterPred[y] != w) {
+            isOuterPred[y] = w;
+            nonBackPreds[w].push_back(y);
+          }
+        } else if (y != w && inBody[y] != w) {
+          inBody[y] = w;
+          body.push_back(y);
+        }
+      }
+    }
+
+    loopOf[w] = loop;
+    block2node[head->GetId()] = loop;
+    for (const auto x : body) {
+      header[x] = w;
+      if (loopOf[x]) {
+        CreateEdge(loop, loopOf[x]);
+      } else {
+        block2node[blocks[x]->GetId()] = loop;
+        loop->AddSource(blocks[x]);
+      }
+    }
+  }
+  LinkToRoot();
+
+  BitVector reachable(size);
+  for (const auto &block : blocks) {
+    reachable.Set(block->GetId());
   }
+  CollectEntries(reachable);
 }
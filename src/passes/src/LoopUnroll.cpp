@@ -0,0 +1,546 @@
+#include <passes/LoopUnroll.h>
+
+#include <passes/LoopAnalysis.h>
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+BBlockPtr GetTarget(const Operand *opnd) {
+  assert(opnd->IsLabel() && "label operand expected");
+  return static_cast<const LabelOperand *>(opnd)->GetLabel()->GetBBlock();
+}
+
+Inst *GetDef(const Operand *opnd) {
+  return opnd->IsInst() ? static_cast<const InstOperand *>(opnd)->GetInst()
+                        : nullptr;
+}
+
+// same semantics as the interpreter
+uint64_t Evaluate(Opcode op, uint64_t lhs, uint64_t rhs) {
+  switch (op) {
+  case OP_assign:
+    return lhs;
+  case OP_add:
+    return lhs + rhs;
+  case OP_mul:
+    return lhs * rhs;
+  case OP_cmp:
+    return lhs < rhs ? 1 : 0;
+  default:
+    assert(false && "can't evaluate the opcode");
+    return 0;
+  }
+}
+
+// innermost loop in the shape the unroller handles
+struct SimpleLoop {
+  BBlockPtr head = nullptr;
+  BBlockPtr latch = nullptr;
+  BBlockPtr exit = nullptr;
+  // contiguous in the layout, head first
+  std::vector<BBlockPtr> body;
+  uint32_t numInsts = 0;
+  // instructions of a copy, the head phis are not copied
+  uint32_t copySize = 0;
+  uint64_t tripCount = 0;
+
+  bool Contains(const BBlockPtr block) const {
+    return block->GetId() >= head->GetId() &&
+           block->GetId() < head->GetId() + body.size();
+  }
+  BBlockPtr GetPredOutside() const {
+    const auto &preds = head->GetPredessors();
+    return preds[0] == latch ? preds[1] : preds[0];
+  }
+};
+
+// phi inputs are (value, label) pairs, returns the operand number of the
+// value coming from 'pred'
+size_t GetIncoming(const Inst *phi, const BBlockPtr pred) {
+  return GetTarget(phi->GetOperand(1)) == pred ? 0 : 2;
+}
+
+class Unroller {
+public:
+  Unroller(Graph &graph, uint32_t maxGrowth, uint32_t factor,
+           LoopUnroll::Stats &stats)
+      : graph(graph), stats(stats), numOldBlocks(graph.GetSize()),
+        budget(maxGrowth), factor(factor), before(numOldBlocks),
+        after(numOldBlocks) {}
+
+  void Run(const LoopTree &loopTree);
+  // give the copies their place in the layout
+  void PlaceCopies();
+
+  bool IsChanged() const { return changed; }
+
+private:
+  bool Analyze(const LoopTreeNodePtr node, SimpleLoop &loop);
+  bool ComputeTripCount(SimpleLoop &loop);
+  void Unroll(const SimpleLoop &loop);
+
+  // value of 'opnd' in a copy, 'valueMap' is indexed by Inst::GetIndex of
+  // the loop instructions, null for the loop itself
+  static Operand *Map(const SimpleLoop &loop,
+                      const std::vector<Operand *> &valueMap, Operand *opnd);
+  // clone the body, 'valueMap' holds the values of the head phis in the
+  // copy and gets the clones. Edges and labels to the head and the exit
+  // are kept, the rest refer to the copy.
+  std::vector<BBlockPtr> CloneBody(const SimpleLoop &loop,
+                                   std::vector<Operand *> &valueMap);
+  // copy of an iteration in front of the loop
+  void Peel(const SimpleLoop &loop);
+  // the loop runs once
+  void RemoveBackEdge(const SimpleLoop &loop);
+  // 'numCopies' - 1 copies after the loop, the last one branches back
+  void UnrollBy(const SimpleLoop &loop, uint32_t numCopies);
+
+  void ReplaceWithJmp(BBlockPtr block, BBlockPtr target);
+  // 'fallsThrough' if 'newTo' follows 'from' in the layout
+  void RedirectEdge(BBlockPtr from, BBlockPtr oldTo, BBlockPtr newTo,
+                    bool fallsThrough);
+
+  Graph &graph;
+  LoopUnroll::Stats &stats;
+  const size_t numOldBlocks;
+  uint64_t budget;
+  uint32_t factor;
+  bool changed = false;
+  // names the copies
+  uint32_t numCopies = 0;
+
+  // copies to place around the blocks, indexed by block id
+  std::vector<std::vector<BBlockPtr>> before;
+  std::vector<std::vector<BBlockPtr>> after;
+};
+
+void Unroller::Run(const LoopTree &loopTree) {
+  // innermost loops are the leaves of the tree
+  std::vector<LoopTreeNodePtr> nodes{loopTree.GetRoot()};
+  while (!nodes.empty()) {
+    LoopTreeNodePtr node = nodes.back();
+    nodes.pop_back();
+    const auto &inner = node->GetInnerLoops();
+    nodes.insert(nodes.end(), inner.begin(), inner.end());
+    SimpleLoop loop;
+    if (node != loopTree.GetRoot() && inner.empty() && Analyze(node, loop)) {
+      Unroll(loop);
+    }
+  }
+}
+
+bool Unroller::Analyze(const LoopTreeNodePtr node, SimpleLoop &loop) {
+  if (!node->IsReducible() || node->GetBackEdges().size() != 1) {
+    return false;
+  }
+  loop.head = node->GetHead();
+  loop.latch = node->GetBackEdges().front();
+  if (loop.head == graph.GetEntry() ||
+      loop.head->GetPredessors().size() != 2) {
+    return false;
+  }
+
+  loop.body.push_back(loop.head);
+  const auto &srcs = node->GetSources();
+  loop.body.insert(loop.body.end(), srcs.begin(), srcs.end());
+  std::sort(loop.body.begin(), loop.body.end(),
+            [](BBlockPtr lhs, BBlockPtr rhs) {
+              return lhs->GetId() < rhs->GetId();
+            });
+  if (loop.body.front() != loop.head ||
+      loop.body.back()->GetId() != loop.head->GetId() + srcs.size()) {
+    return false;
+  }
+
+  // the latch is the only exit
+  for (const auto &block : loop.body) {
+    for (const auto &succ : block->GetSuccessors()) {
+      if (loop.Contains(succ)) {
+        continue;
+      }
+      if (block != loop.latch || loop.exit) {
+        return false;
+      }
+      loop.exit = succ;
+    }
+  }
+  const auto &insts = loop.latch->GetInstList();
+  if (!loop.exit || loop.latch->GetSuccessors().size() != 2 ||
+      insts.empty() || (insts.Back()->GetOpcode() != OP_jeq &&
+                        insts.Back()->GetOpcode() != OP_jne)) {
+    return false;
+  }
+
+  for (const auto &block : loop.body) {
+    for (const auto inst : block->GetInstList()) {
+      inst->SetIndex(loop.numInsts++);
+      loop.copySize += block != loop.head || !inst->IsPhi();
+    }
+  }
+  return ComputeTripCount(loop);
+}
+
+bool Unroller::ComputeTripCount(SimpleLoop &loop) {
+  // not a single copy fits in the budget
+  if (budget < loop.copySize) {
+    return false;
+  }
+  // longer loops can be neither fully unrolled nor unrolled by the factor
+  // within the budget
+  uint64_t maxTripCount =
+      (budget / loop.copySize + 1) * std::max<uint64_t>(factor, 1);
+
+  Inst *branch = loop.latch->GetInstList().Back();
+  bool exitIfTaken = GetTarget(branch->GetOperand(2)) == loop.exit;
+
+  // slice of the branch in the order of evaluation, head phis are its
+  // leaves and bring in the values they take over the back edge
+  std::vector<bool> visited(loop.numInsts);
+  std::vector<Inst *> order;
+  std::vector<Inst *> phis;
+  std::vector<std::pair<Inst *, size_t>> stack;
+  // false if the value is not computed from immediates
+  auto visit = [&](Operand *opnd) {
+    if (opnd->IsImm()) {
+      return true;
+    }
+    Inst *def = GetDef(opnd);
+    if (!def || !loop.Contains(def->GetBBlock())) {
+      return false;
+    }
+    if (visited[def->GetIndex()]) {
+      return true;
+    }
+    visited[def->GetIndex()] = true;
+    if (!def->IsPhi()) {
+      stack.emplace_back(def, 0);
+      return true;
+    }
+    phis.push_back(def);
+    return def->GetBBlock() == loop.head &&
+           def->GetOperand(GetIncoming(def, loop.GetPredOutside()))->IsImm();
+  };
+
+  std::vector<Operand *> roots{branch->GetOperand(0), branch->GetOperand(1)};
+  size_t numRootedPhis = 0;
+  for (size_t r = 0; r < roots.size(); ++r) {
+    if (!visit(roots[r])) {
+      return false;
+    }
+    while (!stack.empty()) {
+      Inst *inst = stack.back().first;
+      size_t next = stack.back().second++;
+      if (next < inst->GetNumOperands()) {
+        if (!visit(inst->GetOperand(next))) {
+          return false;
+        }
+        continue;
+      }
+      order.push_back(inst);
+      stack.pop_back();
+    }
+    for (; numRootedPhis < phis.size(); ++numRootedPhis) {
+      Inst *phi = phis[numRootedPhis];
+      roots.push_back(phi->GetOperand(GetIncoming(phi, loop.latch)));
+    }
+  }
+
+  std::vector<uint64_t> values(loop.numInsts);
+  auto value = [&values](const Operand *opnd) {
+    return opnd->IsImm() ? static_cast<const ImmOperand *>(opnd)->GetValue()
+                         : values[GetDef(opnd)->GetIndex()];
+  };
+  BBlockPtr outside = loop.GetPredOutside();
+  for (const auto phi : phis) {
+    values[phi->GetIndex()] = value(phi->GetOperand(GetIncoming(phi, outside)));
+  }
+  std::vector<uint64_t> nextValues(phis.size());
+  for (uint64_t trip = 1; trip <= maxTripCount; ++trip) {
+    for (const auto inst : order) {
+      uint64_t rhs =
+          inst->GetNumOperands() > 1 ? value(inst->GetOperand(1)) : 0;
+      values[inst->GetIndex()] =
+          Evaluate(inst->GetOpcode(), value(inst->GetOperand(0)), rhs);
+    }
+    bool equal = value(branch->GetOperand(0)) == value(branch->GetOperand(1));
+    bool taken = equal == (branch->GetOpcode() == OP_jeq);
+    if (taken == exitIfTaken) {
+      loop.tripCount = trip;
+      return true;
+    }
+    for (size_t i = 0; i < phis.size(); ++i) {
+      nextValues[i] =
+          value(phis[i]->GetOperand(GetIncoming(phis[i], loop.latch)));
+    }
+    for (size_t i = 0; i < phis.size(); ++i) {
+      values[phis[i]->GetIndex()] = nextValues[i];
+    }
+  }
+  return false;
+}
+
+void Unroller::Unroll(const SimpleLoop &loop) {
+  if ((loop.tripCount - 1) * loop.copySize <= budget) {
+    for (uint64_t i = 1; i < loop.tripCount; ++i) {
+      Peel(loop);
+    }
+    RemoveBackEdge(loop);
+    budget -= (loop.tripCount - 1) * loop.copySize;
+    ++stats.numFullyUnrolled;
+    changed = true;
+    return;
+  }
+  for (uint64_t copies = std::min<uint64_t>(factor, loop.tripCount);
+       copies > 1; --copies) {
+    uint64_t remainder = loop.tripCount % copies;
+    uint64_t growth = (remainder + copies - 1) * loop.copySize;
+    if (growth > budget) {
+      continue;
+    }
+    for (uint64_t i = 0; i < remainder; ++i) {
+      Peel(loop);
+    }
+    UnrollBy(loop, copies);
+    budget -= growth;
+    stats.numPeeledIterations += remainder;
+    ++stats.numPartiallyUnrolled;
+    changed = true;
+    return;
+  }
+}
+
+Operand *Unroller::Map(const SimpleLoop &loop,
+                       const std::vector<Operand *> &valueMap,
+                       Operand *opnd) {
+  Inst *def = GetDef(opnd);
+  if (!def || valueMap.empty() || !loop.Contains(def->GetBBlock())) {
+    return opnd;
+  }
+  Operand *mapped = valueMap[def->GetIndex()];
+  return mapped ? mapped : opnd;
+}
+
+std::vector<BBlockPtr> Unroller::CloneBody(const SimpleLoop &loop,
+                                           std::vector<Operand *> &valueMap) {
+  Arena &arena = graph.GetArena();
+  SymbolTable &symbols = graph.GetSymbols();
+  std::string suffix = "." + std::to_string(++numCopies);
+  std::vector<BBlockPtr> copies;
+  for (const auto &block : loop.body) {
+    copies.push_back(graph.CreateBlock(block->GetName() + suffix));
+  }
+  // branches to the head are back edges and keep it, phi inputs from the
+  // head come from its copy
+  auto copyOf = [&](BBlockPtr block, bool isPhi) {
+    return loop.Contains(block) && (isPhi || block != loop.head)
+               ? copies[block->GetId() - loop.head->GetId()]
+               : block;
+  };
+
+  // every value of the copy is known before the operands are set, phis
+  // may refer to values below them
+  std::vector<std::pair<Inst *, Inst *>> clones;
+  for (size_t i = 0; i < loop.body.size(); ++i) {
+    for (const auto inst : loop.body[i]->GetInstList()) {
+      if (i == 0 && inst->IsPhi()) {
+        continue;
+      }
+      Inst *clone =
+          Inst::Create(arena, inst->GetOpcode(), copies[i],
+                       symbols.Intern(inst->GetName() + suffix));
+      if (clone->IsPhi()) {
+        copies[i]->PushPhi(static_cast<PhiInst *>(clone));
+      } else {
+        copies[i]->PushBack(clone);
+      }
+      if (inst->HasResult()) {
+        valueMap[inst->GetIndex()] = arena.Create<InstOperand>(clone);
+      }
+      clones.emplace_back(inst, clone);
+    }
+  }
+  for (const auto &[inst, clone] : clones) {
+    for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+      Operand *opnd = inst->GetOperand(i);
+      if (opnd->IsLabel()) {
+        BBlockPtr target = GetTarget(opnd);
+        BBlockPtr copy = copyOf(target, clone->IsPhi());
+        if (copy != target) {
+          IRBuilder builder(clone->GetBBlock());
+          opnd = builder.CreateLabel(copy);
+        }
+      } else {
+        opnd = Map(loop, valueMap, opnd);
+      }
+      clone->SetOperand(i, opnd);
+    }
+  }
+  for (size_t i = 0; i < loop.body.size(); ++i) {
+    for (const auto &succ : loop.body[i]->GetSuccessors()) {
+      graph.CreateEdge(copies[i], copyOf(succ, false));
+    }
+  }
+  stats.numClonedInsts += clones.size();
+  return copies;
+}
+
+void Unroller::Peel(const SimpleLoop &loop) {
+  BBlockPtr outside = loop.GetPredOutside();
+  std::vector<Operand *> valueMap(loop.numInsts, nullptr);
+  std::vector<Inst *> phis;
+  for (const auto phi : loop.head->GetPhis()) {
+    valueMap[phi->GetIndex()] = phi->GetOperand(GetIncoming(phi, outside));
+    phis.push_back(phi);
+  }
+  std::vector<BBlockPtr> copies = CloneBody(loop, valueMap);
+  BBlockPtr latchCopy = copies[loop.latch->GetId() - loop.head->GetId()];
+
+  // the loop starts with the values of the copy
+  for (const auto phi : phis) {
+    size_t in = GetIncoming(phi, outside);
+    size_t back = 2 - in;
+    phi->SetOperand(in, Map(loop, valueMap, phi->GetOperand(back)));
+    IRBuilder builder(loop.head);
+    phi->SetOperand(in + 1, builder.CreateLabel(latchCopy));
+  }
+  ReplaceWithJmp(latchCopy, loop.head);
+  auto &placed = before[loop.head->GetId()];
+  RedirectEdge(outside, loop.head, copies.front(),
+               placed.empty() &&
+                   outside->GetId() + 1 == loop.head->GetId());
+  placed.insert(placed.end(), copies.begin(), copies.end());
+}
+
+void Unroller::RemoveBackEdge(const SimpleLoop &loop) {
+  BBlockPtr outside = loop.GetPredOutside();
+  std::vector<Inst *> phis;
+  for (const auto phi : loop.head->GetPhis()) {
+    phis.push_back(phi);
+  }
+  for (const auto phi : phis) {
+    phi->ReplaceAllUsesWith(phi->GetOperand(GetIncoming(phi, outside)));
+  }
+  for (const auto phi : phis) {
+    phi->DropAllReferences();
+    loop.head->Erase(phi);
+  }
+  ReplaceWithJmp(loop.latch, loop.exit);
+}
+
+void Unroller::UnrollBy(const SimpleLoop &loop, uint32_t numCopies) {
+  // the loop is left from the last copy, uses outside of the loop get
+  // its values
+  std::vector<std::pair<Inst *, size_t>> outsideUses;
+  for (const auto &block : loop.body) {
+    for (const auto inst : block->GetInstList()) {
+      for (const auto use : inst->GetUses()) {
+        if (!loop.Contains(use->GetUser()->GetBBlock())) {
+          outsideUses.emplace_back(use->GetUser(), use->GetOperandNo());
+        }
+      }
+    }
+  }
+
+  std::vector<Inst *> phis;
+  for (const auto phi : loop.head->GetPhis()) {
+    phis.push_back(phi);
+  }
+  // the copies are made before the branches of the latches change
+  std::vector<Operand *> prevMap;
+  std::vector<BBlockPtr> latches{loop.latch};
+  std::vector<BBlockPtr> heads;
+  auto &placed = after[loop.body.back()->GetId()];
+  for (uint32_t i = 1; i < numCopies; ++i) {
+    std::vector<Operand *> valueMap(loop.numInsts, nullptr);
+    for (const auto phi : phis) {
+      valueMap[phi->GetIndex()] =
+          Map(loop, prevMap, phi->GetOperand(GetIncoming(phi, loop.latch)));
+    }
+    std::vector<BBlockPtr> copies = CloneBody(loop, valueMap);
+    heads.push_back(copies.front());
+    latches.push_back(copies[loop.latch->GetId() - loop.head->GetId()]);
+    prevMap = std::move(valueMap);
+    placed.insert(placed.end(), copies.begin(), copies.end());
+  }
+  for (size_t i = 0; i < heads.size(); ++i) {
+    ReplaceWithJmp(latches[i], heads[i]);
+  }
+  BBlockPtr prevLatch = latches.back();
+
+  IRBuilder builder(loop.head);
+  for (const auto phi : phis) {
+    size_t back = GetIncoming(phi, loop.latch);
+    phi->SetOperand(back, Map(loop, prevMap, phi->GetOperand(back)));
+    phi->SetOperand(back + 1, builder.CreateLabel(prevLatch));
+  }
+  for (const auto phi : loop.exit->GetPhis()) {
+    for (size_t i = 1; i < phi->GetNumOperands(); i += 2) {
+      if (GetTarget(phi->GetOperand(i)) == loop.latch) {
+        phi->SetOperand(i, builder.CreateLabel(prevLatch));
+      }
+    }
+  }
+  for (const auto &[user, no] : outsideUses) {
+    user->SetOperand(no, Map(loop, prevMap, user->GetOperand(no)));
+  }
+}
+
+void Unroller::ReplaceWithJmp(BBlockPtr block, BBlockPtr target) {
+  Inst *branch = block->GetInstList().Back();
+  assert(branch->IsTerminator() && "branch expected");
+  branch->DropAllReferences();
+  block->Erase(branch);
+  while (!block->GetSuccessors().empty()) {
+    graph.RemoveEdge(block, block->GetSuccessors().front());
+  }
+  IRBuilder builder(block);
+  builder.CreateJmp(builder.CreateLabel(target));
+  graph.CreateEdge(block, target);
+}
+
+void Unroller::RedirectEdge(BBlockPtr from, BBlockPtr oldTo, BBlockPtr newTo,
+                            bool fallsThrough) {
+  graph.RemoveEdge(from, oldTo);
+  graph.CreateEdge(from, newTo);
+  Inst *last = from->GetInstCount() ? from->GetInstList().Back() : nullptr;
+  IRBuilder builder(from);
+  if (!last || !last->IsTerminator()) {
+    if (!fallsThrough) {
+      builder.CreateJmp(builder.CreateLabel(newTo));
+    }
+    return;
+  }
+  // 'jeq' and 'jne' fall through to the other successor
+  size_t labelNo = last->IsJmp() ? 0 : 2;
+  if (last->IsBranch() && GetTarget(last->GetOperand(labelNo)) == oldTo) {
+    last->SetOperand(labelNo, builder.CreateLabel(newTo));
+  }
+}
+
+void Unroller::PlaceCopies() {
+  if (!changed) {
+    return;
+  }
+  std::vector<BBlockPtr> order;
+  order.reserve(graph.GetSize());
+  const auto &blocks = graph.GetBlocks();
+  for (size_t i = 0; i < numOldBlocks; ++i) {
+    order.insert(order.end(), before[i].begin(), before[i].end());
+    order.push_back(blocks[i]);
+    order.insert(order.end(), after[i].begin(), after[i].end());
+  }
+  graph.SetOrder(std::move(order));
+}
+} // namespace
+
+PreservedAnalyses LoopUnroll::Run(Graph &graph, AnalysisManager &am) {
+  Unroller unroller(graph, maxGrowth, factor, stats);
+  unroller.Run(am.Get<LoopTree>());
+  unroller.PlaceCopies();
+  return unroller.IsChanged() ? PreservedAnalyses::None()
+                              : PreservedAnalyses::All();
+}
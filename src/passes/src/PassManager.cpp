@@ -0,0 +1,104 @@
+#include <passes/PassManager.h>
+
+#include <algorithm>
+#include <iomanip>
+
+std::unique_ptr<DominanceFrontier>
+AnalysisInfo<DominanceFrontier>::Run(const Graph &graph,
+                                     AnalysisManager &am) {
+  return std::make_unique<DominanceFrontier>(graph, am.Get<DominatorTree>());
+}
+
+std::unique_ptr<LoopTree> AnalysisInfo<LoopTree>::Run(const Graph &graph,
+                                                      AnalysisManager &am) {
+  return std::make_unique<LoopTree>(graph, am.Get<DominatorTree>());
+}
+
+std::unique_ptr<Liveness> AnalysisInfo<Liveness>::Run(const Graph &graph,
+                                                      AnalysisManager &am) {
+  return std::make_unique<Liveness>(graph, am.Get<LoopTree>());
+}
+
+void AnalysisManager::AddDependent(Entry &entry, std::type_index dependent) {
+  auto &dependents = entry.dependents;
+  if (std::find(dependents.begin(), dependents.end(), dependent) ==
+      dependents.end()) {
+    dependents.push_back(dependent);
+  }
+}
+
+void AnalysisManager::Invalidate(std::type_index id) {
+  auto it = entries.find(id);
+  if (it == entries.end() || !it->second.result) {
+    return;
+  }
+  Entry &entry = it->second;
+  // dependents may refer to the result, drop them first
+  std::vector<std::type_index> dependents;
+  dependents.swap(entry.dependents);
+  for (const auto &dependent : dependents) {
+    Invalidate(dependent);
+  }
+  entry.result.reset();
+  ++entry.stats.numInvalidations;
+}
+
+void AnalysisManager::Invalidate(const PreservedAnalyses &preserved) {
+  if (preserved.AreAllPreserved()) {
+    return;
+  }
+  for (const auto &id : order) {
+    const Entry &entry = entries.at(id);
+    if (entry.result && !preserved.IsPreserved(id, entry.dependsOnInsts)) {
+      Invalidate(id);
+    }
+  }
+}
+
+void AnalysisManager::Clear() {
+  for (const auto &id : order) {
+    Invalidate(id);
+  }
+}
+
+void AnalysisManager::DumpStats(std::ostream &os) const {
+  os << std::left << std::setw(20) << "analysis" << std::right
+     << std::setw(8) << "hits" << std::setw(8) << "runs" << std::setw(8)
+     << "inval" << std::setw(12) << "ms" << std::endl;
+  for (const auto &id : order) {
+    const Stats &stats = entries.at(id).stats;
+    os << std::left << std::setw(20) << stats.name << std::right
+       << std::setw(8) << stats.numHits << std::setw(8)
+       << stats.numComputations << std::setw(8) << stats.numInvalidations
+       << std::setw(12) << std::fixed << std::setprecision(3)
+       << stats.seconds * 1000 << std::endl;
+  }
+}
+
+void PassManager::Run(Graph &graph, AnalysisManager &am) {
+  assert(&am.GetGraph() == &graph && "analyses of another function");
+  for (size_t i = 0; i < passes.size(); ++i) {
+    auto start = std::chrono::steady_clock::now();
+    PreservedAnalyses preserved = passes[i]->Run(graph, am);
+    am.Invalidate(preserved);
+    stats[i].seconds += std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    ++stats[i].numRuns;
+    if (!preserved.AreAllPreserved()) {
+      ++stats[i].numChanges;
+    }
+  }
+}
+
+void PassManager::DumpStats(std::ostream &os) const {
+  os << std::left << std::setw(20) << "pass" << std::right << std::setw(8)
+     << "runs" << std::setw(8) << "changed" << std::setw(12) << "ms"
+     << std::endl;
+  for (const auto &passStats : stats) {
+    os << std::left << std::setw(20) << passStats.name << std::right
+       << std::setw(8) << passStats.numRuns << std::setw(8)
+       << passStats.numChanges << std::setw(12) << std::fixed
+       << std::setprecision(3) << passStats.seconds * 1000 << std::endl;
+  }
+}
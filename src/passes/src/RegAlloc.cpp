@@ -0,0 +1,226 @@
+#include <passes/RegAlloc.h>
+
+#include <algorithm>
+#include <cmath>
+
+static Inst *GetDef(const Operand *opnd) {
+  return opnd->IsInst() ? static_cast<const InstOperand *>(opnd)->GetInst()
+                        : nullptr;
+}
+
+RegAlloc::RegAlloc(const Graph & /*graph*/, const LoopTree &loopTree,
+                   const Liveness &liveness, uint32_t numRegs)
+    : numRegs(numRegs), order(liveness.GetBlockOrder().rbegin(),
+                              liveness.GetBlockOrder().rend()) {
+  assert(numRegs > 0 && "at least one register is required");
+  BuildIntervals(loopTree, liveness);
+  Allocate();
+}
+
+void RegAlloc::BuildIntervals(const LoopTree &loopTree,
+                              const Liveness &liveness) {
+  // number values and instructions in the linear order
+  std::vector<uint32_t> blockFrom(order.size());
+  std::vector<uint32_t> blockTo(order.size());
+  uint32_t pos = 0;
+  for (const auto &block : order) {
+    blockFrom[block->GetId()] = pos;
+    for (const auto inst : block->GetInstList()) {
+      if (inst->HasResult()) {
+        value2idx.emplace(inst, intervals.size());
+        intervals.emplace_back();
+        intervals.back().value = inst;
+      }
+      if (!inst->IsPhi()) {
+        pos += 2;
+      }
+    }
+    blockTo[block->GetId()] = pos;
+  }
+
+  auto extend = [this](uint32_t idx, uint32_t from, uint32_t to) {
+    Interval &interval = intervals[idx];
+    interval.start = std::min(interval.start, from);
+    interval.end = std::max(interval.end, to);
+  };
+
+  // Every block is processed separately: an interval is opened by the last
+  // use (or at the end of the block if the value is live-out) and closed by
+  // the definition or at the start of the block.
+  std::vector<uint32_t> openEnd(intervals.size());
+  std::vector<uint32_t> openStamp(intervals.size(), 0);
+  std::vector<uint32_t> opened;
+  uint32_t stamp = 0;
+
+  for (const auto &block : order) {
+    ++stamp;
+    opened.clear();
+    uint32_t from = blockFrom[block->GetId()];
+    uint32_t to = blockTo[block->GetId()];
+
+    uint32_t depth = 0;
+    for (auto loop = loopTree.GetLoopNode(block);
+         loop && loop != loopTree.GetRoot(); loop = loop->GetOuterLoop()) {
+      ++depth;
+    }
+    double frequency = std::pow(10.0, std::min(depth, 9u));
+
+    auto open = [&](uint32_t idx, uint32_t end) {
+      if (openStamp[idx] != stamp) {
+        openStamp[idx] = stamp;
+        openEnd[idx] = end;
+        opened.push_back(idx);
+      }
+    };
+    auto close = [&](uint32_t idx, uint32_t start) {
+      if (openStamp[idx] == stamp) {
+        extend(idx, start, openEnd[idx]);
+        openStamp[idx] = 0;
+      } else {
+        // result is never used
+        extend(idx, start, start + 1);
+      }
+    };
+
+    const BitVector &liveOut = liveness.GetLiveOut(block);
+    for (size_t v = liveOut.FindFirst(); v != BitVector::npos;
+         v = liveOut.FindNext(v + 1)) {
+      open(value2idx.at(liveness.GetValue(v)), to);
+    }
+
+    // uses by phis of successors are at the end of the block
+    for (const auto &succ : block->GetSuccessors()) {
+      for (const auto phi : succ->GetPhis()) {
+        for (size_t i = 0; i + 1 < phi->GetNumOperands(); i += 2) {
+          auto label = static_cast<LabelOperand *>(phi->GetOperand(i + 1));
+          Inst *def = GetDef(phi->GetOperand(i));
+          if (def && label->GetLabel()->GetBBlock() == block) {
+            Interval &interval = intervals[value2idx.at(def)];
+            interval.weight += frequency;
+            ++interval.numUses;
+          }
+        }
+      }
+    }
+
+    uint32_t instPos = to;
+    auto &instList = block->GetInstList();
+    for (auto it = instList.end(); it != instList.begin();) {
+      Inst *inst = *--it;
+      if (inst->IsPhi()) {
+        close(value2idx.at(inst), from);
+        intervals[value2idx.at(inst)].weight += frequency;
+        continue;
+      }
+
+      instPos -= 2;
+      if (inst->HasResult()) {
+        uint32_t idx = value2idx.at(inst);
+        close(idx, instPos + 1);
+        intervals[idx].weight += frequency;
+      }
+      for (size_t i = 0; i < inst->GetNumOperands(); ++i) {
+        Inst *def = GetDef(inst->GetOperand(i));
+        if (!def) {
+          continue;
+        }
+        uint32_t idx = value2idx.at(def);
+        open(idx, instPos + 1);
+        intervals[idx].weight += frequency;
+        ++intervals[idx].numUses;
+      }
+    }
+
+    // still open values are live-in
+    for (uint32_t idx : opened) {
+      if (openStamp[idx] == stamp) {
+        extend(idx, from, openEnd[idx]);
+      }
+    }
+  }
+}
+
+void RegAlloc::Spill(Interval &interval) {
+  interval.reg = kSpilled;
+  interval.spillSlot = numSpillSlots++;
+  ++stats.numSpilled;
+  ++stats.numSpillStores;
+  stats.numReloads += interval.numUses;
+  stats.weightedSpillCost += interval.weight;
+}
+
+void RegAlloc::Allocate() {
+  stats.numValues = intervals.size();
+
+  std::vector<uint32_t> sorted(intervals.size());
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    sorted[i] = i;
+  }
+  std::sort(sorted.begin(), sorted.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return intervals[lhs].start < intervals[rhs].start;
+  });
+
+  // registers are taken from the back
+  std::vector<uint32_t> freeRegs;
+  for (uint32_t reg = numRegs; reg-- > 0;) {
+    freeRegs.push_back(reg);
+  }
+  // intervals holding registers, sorted by decreasing end
+  std::vector<uint32_t> active;
+
+  for (uint32_t idx : sorted) {
+    Interval &curr = intervals[idx];
+    while (!active.empty() && intervals[active.back()].end <= curr.start) {
+      freeRegs.push_back(intervals[active.back()].reg);
+      active.pop_back();
+    }
+
+    if (freeRegs.empty()) {
+      // cheapest interval goes to memory, among equal ones the longest
+      auto victim = std::min_element(
+          active.begin(), active.end(), [this](uint32_t lhs, uint32_t rhs) {
+            const Interval &l = intervals[lhs];
+            const Interval &r = intervals[rhs];
+            return l.weight != r.weight ? l.weight < r.weight : l.end > r.end;
+          });
+      Interval &victimInterval = intervals[*victim];
+      if (curr.weight > victimInterval.weight ||
+          (curr.weight == victimInterval.weight &&
+           curr.end < victimInterval.end)) {
+        freeRegs.push_back(victimInterval.reg);
+        Spill(victimInterval);
+        active.erase(victim);
+      } else {
+        Spill(curr);
+        continue;
+      }
+    }
+
+    curr.reg = freeRegs.back();
+    freeRegs.pop_back();
+    auto pos = std::lower_bound(active.begin(), active.end(), curr.end,
+                                [this](uint32_t lhs, uint32_t end) {
+                                  return intervals[lhs].end > end;
+                                });
+    active.insert(pos, idx);
+  }
+}
+
+void RegAlloc::DumpReport(std::ostream &os) const {
+  os << "registers: " << numRegs << std::endl;
+  os << "values: " << stats.numValues << std::endl;
+  os << "spilled: " << stats.numSpilled << std::endl;
+  os << "spill stores: " << stats.numSpillStores << std::endl;
+  os << "reloads: " << stats.numReloads << std::endl;
+  os << "weighted spill cost: " << stats.weightedSpillCost << std::endl;
+  for (const auto &interval : intervals) {
+    os << "  " << interval.value->GetName() << " [" << interval.start << ", "
+       << interval.end << ") ";
+    if (interval.reg == kSpilled) {
+      os << "slot" << interval.spillSlot;
+    } else {
+      os << "r" << interval.reg;
+    }
+    os << std::endl;
+  }
+}
@@ -0,0 +1,378 @@
+#include <passes/SCCP.h>
+
+#include <support/BitVector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace {
+// values only go down: undefined, then a constant, then overdefined
+struct LatticeValue {
+  enum Kind : uint8_t { kUndef, kConst, kOverdef };
+
+  Kind kind = kUndef;
+  uint64_t value = 0;
+
+  static LatticeValue Const(uint64_t value) { return {kConst, value}; }
+  static LatticeValue Overdef() { return {kOverdef, 0}; }
+
+  bool IsUndef() const { return kind == kUndef; }
+  bool IsConst() const { return kind == kConst; }
+  bool IsOverdef() const { return kind == kOverdef; }
+
+  bool operator==(const LatticeValue &rhs) const {
+    return kind == rhs.kind && value == rhs.value;
+  }
+  bool operator!=(const LatticeValue &rhs) const { return !(*this == rhs); }
+};
+
+LatticeValue Meet(LatticeValue lhs, LatticeValue rhs) {
+  if (lhs.IsUndef()) {
+    return rhs;
+  }
+  if (rhs.IsUndef() || lhs == rhs) {
+    return lhs;
+  }
+  return LatticeValue::Overdef();
+}
+
+// same semantics as the interpreter
+uint64_t Fold(Opcode op, uint64_t lhs, uint64_t rhs) {
+  switch (op) {
+  case OP_add:
+    return lhs + rhs;
+  case OP_mul:
+    return lhs * rhs;
+  case OP_cmp:
+    return lhs < rhs ? 1 : 0;
+  default:
+    assert(false && "can't fold the opcode");
+    return 0;
+  }
+}
+
+BBlockPtr GetTarget(const Operand *opnd) {
+  assert(opnd->IsLabel() && "label operand expected");
+  return static_cast<const LabelOperand *>(opnd)->GetLabel()->GetBBlock();
+}
+
+class Solver {
+public:
+  explicit Solver(const Graph &graph);
+
+  void Solve();
+
+  bool IsExecutable(const BBlockPtr block) const {
+    return executable.Test(block->GetId());
+  }
+  bool IsEdgeExecutable(const BBlockPtr from, const BBlockPtr to) const {
+    return executableEdges.Test(GetEdgeIndex(from, to));
+  }
+
+  LatticeValue GetValue(const Inst *inst) const {
+    assert(inst->GetIndex() < values.size() && "value outside of the graph");
+    return values[inst->GetIndex()];
+  }
+  LatticeValue GetValue(const Operand *opnd) const {
+    if (opnd->IsImm()) {
+      return LatticeValue::Const(
+          static_cast<const ImmOperand *>(opnd)->GetValue());
+    }
+    assert(opnd->IsInst() && "value operand expected");
+    return GetValue(static_cast<const InstOperand *>(opnd)->GetInst());
+  }
+
+  // operand of the only executable incoming edge of the phi, nullptr if
+  // there are more
+  Operand *GetSingleIncoming(const Inst *phi) const;
+
+private:
+  // edges are numbered by the source and the index of the successor
+  size_t GetEdgeIndex(const BBlockPtr from, const BBlockPtr to) const {
+    const auto &succs = from->GetSuccessors();
+    auto it = std::find(succs.begin(), succs.end(), to);
+    assert(it != succs.end() && "no such edge");
+    return 2 * from->GetId() + (it - succs.begin());
+  }
+
+  void MarkEdge(const BBlockPtr from, const BBlockPtr to);
+  // lower the value of 'inst' to its meet with 'value'
+  void Update(Inst *inst, LatticeValue value);
+
+  void VisitBlock(const BBlockPtr block);
+  void Visit(Inst *inst);
+  void VisitPhi(Inst *phi);
+  void VisitBranch(Inst *inst);
+
+private:
+  const Graph &graph;
+
+  // indexed by Inst::GetIndex
+  std::vector<LatticeValue> values;
+
+  // indexed by block id and by edge number
+  BitVector executable;
+  BitVector executableEdges;
+
+  std::vector<BBlockPtr> blockWorklist;
+  // users of the values which changed
+  std::vector<Inst *> instWorklist;
+};
+
+Solver::Solver(const Graph &graph)
+    : graph(graph), executable(graph.GetSize()),
+      executableEdges(2 * graph.GetSize()) {
+  for (const auto &block : graph.GetBlocks()) {
+    for (const auto inst : block->GetInstList()) {
+      if (inst->HasResult()) {
+        inst->SetIndex(values.size());
+        values.emplace_back();
+      }
+    }
+  }
+}
+
+void Solver::Solve() {
+  if (graph.GetSize() == 0) {
+    return;
+  }
+  executable.Set(0);
+  blockWorklist.push_back(graph.GetEntry());
+
+  while (!blockWorklist.empty() || !instWorklist.empty()) {
+    // let values settle before new blocks are visited
+    while (!instWorklist.empty()) {
+      Inst *inst = instWorklist.back();
+      instWorklist.pop_back();
+      if (inst->IsLinked() && IsExecutable(inst->GetBBlock())) {
+        Visit(inst);
+      }
+    }
+    if (!blockWorklist.empty()) {
+      BBlockPtr block = blockWorklist.back();
+      blockWorklist.pop_back();
+      VisitBlock(block);
+    }
+  }
+}
+
+Operand *Solver::GetSingleIncoming(const Inst *phi) const {
+  Operand *incoming = nullptr;
+  for (size_t i = 0; i + 1 < phi->GetNumOperands(); i += 2) {
+    if (IsEdgeExecutable(GetTarget(phi->GetOperand(i + 1)),
+                         phi->GetBBlock())) {
+      if (incoming) {
+        return nullptr;
+      }
+      incoming = phi->GetOperand(i);
+    }
+  }
+  return incoming;
+}
+
+void Solver::MarkEdge(const BBlockPtr from, const BBlockPtr to) {
+  if (!executableEdges.TestAndSet(GetEdgeIndex(from, to))) {
+    return;
+  }
+  if (executable.TestAndSet(to->GetId())) {
+    blockWorklist.push_back(to);
+    return;
+  }
+  // phis of a visited block meet one more operand
+  for (const auto phi : to->GetPhis()) {
+    instWorklist.push_back(phi);
+  }
+}
+
+void Solver::Update(Inst *inst, LatticeValue value) {
+  assert(inst->GetIndex() < values.size() && "value outside of the graph");
+  LatticeValue &old = values[inst->GetIndex()];
+  LatticeValue lowered = Meet(old, value);
+  if (lowered == old) {
+    return;
+  }
+  old = lowered;
+  for (const auto user : inst->GetUsers()) {
+    instWorklist.push_back(user);
+  }
+}
+
+void Solver::VisitBlock(const BBlockPtr block) {
+  auto &insts = block->GetInstList();
+  for (const auto inst : insts) {
+    Visit(inst);
+  }
+  // no terminator, falls through
+  if (insts.empty() || !insts.Back()->IsTerminator()) {
+    for (const auto &succ : block->GetSuccessors()) {
+      MarkEdge(block, succ);
+    }
+  }
+}
+
+void Solver::Visit(Inst *inst) {
+  switch (inst->GetOpcode()) {
+  case OP_phi:
+    VisitPhi(inst);
+    break;
+  case OP_assign:
+    Update(inst, GetValue(inst->GetOperand(0)));
+    break;
+  case OP_add:
+  case OP_mul:
+  case OP_cmp: {
+    LatticeValue lhs = GetValue(inst->GetOperand(0));
+    LatticeValue rhs = GetValue(inst->GetOperand(1));
+    if (lhs.IsOverdef() || rhs.IsOverdef()) {
+      Update(inst, LatticeValue::Overdef());
+    } else if (lhs.IsConst() && rhs.IsConst()) {
+      Update(inst, LatticeValue::Const(
+                       Fold(inst->GetOpcode(), lhs.value, rhs.value)));
+    }
+    break;
+  }
+  case OP_jmp:
+    MarkEdge(inst->GetBBlock(), GetTarget(inst->GetOperand(0)));
+    break;
+  case OP_jeq:
+  case OP_jne:
+    VisitBranch(inst);
+    break;
+  default:
+    break;
+  }
+}
+
+void Solver::VisitPhi(Inst *phi) {
+  LatticeValue value;
+  for (size_t i = 0; i + 1 < phi->GetNumOperands(); i += 2) {
+    if (IsEdgeExecutable(GetTarget(phi->GetOperand(i + 1)),
+                         phi->GetBBlock())) {
+      value = Meet(value, GetValue(phi->GetOperand(i)));
+    }
+  }
+  Update(phi, value);
+}
+
+void Solver::VisitBranch(Inst *inst) {
+  BBlockPtr block = inst->GetBBlock();
+  LatticeValue lhs = GetValue(inst->GetOperand(0));
+  LatticeValue rhs = GetValue(inst->GetOperand(1));
+  if (lhs.IsOverdef() || rhs.IsOverdef()) {
+    for (const auto &succ : block->GetSuccessors()) {
+      MarkEdge(block, succ);
+    }
+    return;
+  }
+  if (lhs.IsUndef() || rhs.IsUndef()) {
+    return;
+  }
+
+  BBlockPtr taken = GetTarget(inst->GetOperand(2));
+  bool equal = lhs.value == rhs.value;
+  if (equal == (inst->GetOpcode() == OP_jeq)) {
+    MarkEdge(block, taken);
+    return;
+  }
+  // the other successor, the same one if both edges go there
+  for (const auto &succ : block->GetSuccessors()) {
+    if (succ != taken) {
+      MarkEdge(block, succ);
+      return;
+    }
+  }
+  MarkEdge(block, taken);
+}
+} // namespace
+
+PreservedAnalyses SCCP::Run(Graph &graph, AnalysisManager & /*am*/) {
+  Solver solver(graph);
+  solver.Solve();
+  Arena &arena = graph.GetArena();
+  bool instsChanged = false;
+
+  // replace values while the solver still knows the edges
+  for (const auto &block : graph.GetBlocks()) {
+    if (!solver.IsExecutable(block)) {
+      continue;
+    }
+    for (auto it = block->InstBegin(); it != block->InstEnd();) {
+      Inst *inst = *it;
+      Operand *replacement = nullptr;
+      if (inst->HasResult()) {
+        LatticeValue value = solver.GetValue(inst);
+        if (value.IsConst()) {
+          replacement = arena.Create<ImmOperand>(value.value);
+        } else if (inst->IsPhi()) {
+          replacement = solver.GetSingleIncoming(inst);
+        }
+      }
+      if (!replacement) {
+        ++it;
+        continue;
+      }
+      inst->ReplaceAllUsesWith(replacement);
+      inst->DropAllReferences();
+      it = block->Erase(inst);
+      ++stats.numFoldedInsts;
+      instsChanged = true;
+    }
+  }
+
+  // branches with a single executable edge
+  bool cfgChanged = false;
+  for (const auto &block : graph.GetBlocks()) {
+    const auto &succs = block->GetSuccessors();
+    if (!solver.IsExecutable(block) || succs.size() != 2) {
+      continue;
+    }
+    bool first = solver.IsEdgeExecutable(block, succs[0]);
+    bool second = solver.IsEdgeExecutable(block, succs[1]);
+    if (first == second) {
+      assert(first && "executable block without executable edges");
+      continue;
+    }
+    BBlockPtr target = first ? succs[0] : succs[1];
+    BBlockPtr dead = first ? succs[1] : succs[0];
+
+    Inst *branch = block->GetInstList().Back();
+    assert((branch->GetOpcode() == OP_jeq || branch->GetOpcode() == OP_jne) &&
+           "conditional branch expected");
+    Operand *label = branch->GetOperand(2);
+    if (GetTarget(label) != target) {
+      label = arena.Create<LabelOperand>(
+          arena.Create<Label>(target, target->GetSymbol()));
+    }
+    Inst *jmp = Inst::Create(arena, OP_jmp, block, branch->GetSymbol());
+    jmp->SetOperand(0, label);
+    jmp->MoveBefore(branch);
+    branch->DropAllReferences();
+    block->Erase(branch);
+    graph.RemoveEdge(block, dead);
+    ++stats.numFoldedBranches;
+    cfgChanged = true;
+  }
+
+  BitVector erased(graph.GetSize());
+  for (const auto &block : graph.GetBlocks()) {
+    if (solver.IsExecutable(block)) {
+      continue;
+    }
+    erased.Set(block->GetId());
+    for (const auto inst : block->GetInstList()) {
+      inst->DropAllReferences();
+      ++stats.numErasedInsts;
+    }
+    ++stats.numErasedBlocks;
+  }
+  if (erased.Any()) {
+    graph.EraseBlocks(erased);
+    cfgChanged = true;
+  }
+
+  if (cfgChanged) {
+    return PreservedAnalyses::None();
+  }
+  return instsChanged ? PreservedAnalyses::CFG() : PreservedAnalyses::All();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bump allocator. Every object created in the arena lives until the arena
+// itself is destroyed, there is no per-object deallocation. Destructors of
+// non-trivially destructible objects are run in reverse creation order.
+class Arena {
+public:
+  static constexpr size_t kDefaultSlabSize = 64 * 1024;
+
+  explicit Arena(size_t slabSize = kDefaultSlabSize) : slabSize(slabSize) {}
+  ~Arena() { Reset(); }
+
+  // non-movable, non-copyable
+  Arena(const Arena &) = delete;
+  Arena(Arena &&) = delete;
+  Arena &operator=(const Arena &) = delete;
+  Arena &operator=(Arena &&) = delete;
+
+  void *Allocate(size_t size, size_t align) {
+    assert(align != 0 && (align & (align - 1)) == 0 && "invalid alignment");
+    uintptr_t ptr = AlignUp(cur, align);
+    if (cur == 0 || ptr + size > end) {
+      NewSlab(size + align);
+      ptr = AlignUp(cur, align);
+    }
+    cur = ptr + size;
+    allocatedBytes += size;
+    return reinterpret_cast<void *>(ptr);
+  }
+
+  template <class T, class... Args> T *Create(Args &&...args) {
+    void *mem = Allocate(sizeof(T), alignof(T));
+    T *obj = new (mem) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      auto *cleanup = new (Allocate(sizeof(Cleanup), alignof(Cleanup)))
+          Cleanup{obj, [](void *p) { static_cast<T *>(p)->~T(); }, cleanups};
+      cleanups = cleanup;
+    }
+    return obj;
+  }
+
+  // uninitialized storage for 'n' objects, destructors are never run
+  template <class T> T *AllocateArray(size_t n) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena arrays are never destroyed");
+    return static_cast<T *>(Allocate(sizeof(T) * n, alignof(T)));
+  }
+
+  // bytes handed out to clients, without slab headers and padding
+  size_t GetAllocatedBytes() const { return allocatedBytes; }
+
+  // run destructors and release all slabs at once
+  void Reset() {
+    for (Cleanup *c = cleanups; c; c = c->next) {
+      c->dtor(c->obj);
+    }
+    cleanups = nullptr;
+
+    while (slabs) {
+      Slab *next = slabs->next;
+      std::free(slabs);
+      slabs = next;
+    }
+    cur = end = 0;
+    allocatedBytes = 0;
+  }
+
+private:
+  struct Slab {
+    Slab *next;
+  };
+
+  struct Cleanup {
+    void *obj;
+    void (*dtor)(void *);
+    Cleanup *next;
+  };
+
+  static uintptr_t AlignUp(uintptr_t ptr, size_t align) {
+    return (ptr + align - 1) & ~static_cast<uintptr_t>(align - 1);
+  }
+
+  void NewSlab(size_t minSize) {
+    // oversized requests get a dedicated slab
+    size_t size = std::max(slabSize, minSize + sizeof(Slab));
+    auto *slab = static_cast<Slab *>(std::malloc(size));
+    if (!slab) {
+      throw std::bad_alloc();
+    }
+    slab->next = slabs;
+    slabs = slab;
+    cur = reinterpret_cast<uintptr_t>(slab) + sizeof(Slab);
+    end = reinterpret_cast<uintptr_t>(slab) + size;
+  }
+
+private:
+  size_t slabSize;
+  size_t allocatedBytes = 0;
+
+  uintptr_t cur = 0;
+  uintptr_t end = 0;
+
+  Slab *slabs = nullptr;
+  Cleanup *cleanups = nullptr;
+};
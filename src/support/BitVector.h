@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-size set of bits packed into 64-bit words.
+class BitVector {
+public:
+  using Word = uint64_t;
+  static constexpr size_t kWordBits = 64;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  BitVector() = default;
+  explicit BitVector(size_t size, bool value = false) { Resize(size, value); }
+
+  size_t size() const { return numBits; }
+  bool empty() const { return numBits == 0; }
+
+  void Resize(size_t size, bool value = false) {
+    size_t oldSize = numBits;
+    words.resize(NumWords(size), value ? ~Word(0) : Word(0));
+    numBits = size;
+    if (value && oldSize < size && oldSize % kWordBits != 0) {
+      // set the tail of the previously last word
+      words[oldSize / kWordBits] |= ~Word(0) << (oldSize % kWordBits);
+    }
+    ClearUnusedBits();
+  }
+
+  bool Test(size_t idx) const {
+    assert(idx < numBits && "bit index out of range");
+    return (words[idx / kWordBits] >> (idx % kWordBits)) & 1;
+  }
+  bool operator[](size_t idx) const { return Test(idx); }
+
+  void Set(size_t idx) {
+    assert(idx < numBits && "bit index out of range");
+    words[idx / kWordBits] |= Word(1) << (idx % kWordBits);
+  }
+
+  void Reset(size_t idx) {
+    assert(idx < numBits && "bit index out of range");
+    words[idx / kWordBits] &= ~(Word(1) << (idx % kWordBits));
+  }
+
+  // set bit, return true if it was not set before
+  bool TestAndSet(size_t idx) {
+    assert(idx < numBits && "bit index out of range");
+    Word &w = words[idx / kWordBits];
+    Word mask = Word(1) << (idx % kWordBits);
+    bool wasSet = w & mask;
+    w |= mask;
+    return !wasSet;
+  }
+
+  void Clear() { std::fill(words.begin(), words.end(), Word(0)); }
+
+  bool Any() const {
+    return std::any_of(words.begin(), words.end(),
+                       [](Word w) { return w != 0; });
+  }
+
+  size_t Count() const {
+    size_t count = 0;
+    for (Word w : words) {
+      count += __builtin_popcountll(w);
+    }
+    return count;
+  }
+
+  // index of the first set bit at or after 'from', npos if none
+  size_t FindNext(size_t from) const {
+    if (from >= numBits) {
+      return npos;
+    }
+    size_t idx = from / kWordBits;
+    Word w = words[idx] & (~Word(0) << (from % kWordBits));
+    while (true) {
+      if (w != 0) {
+        return idx * kWordBits + __builtin_ctzll(w);
+      }
+      if (++idx == words.size()) {
+        return npos;
+      }
+      w = words[idx];
+    }
+  }
+  size_t FindFirst() const { return FindNext(0); }
+
+  // this |= rhs, return true if any bit changed
+  bool Union(const BitVector &rhs) {
+    assert(numBits == rhs.numBits && "size mismatch");
+    Word changed = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+      Word old = words[i];
+      words[i] |= rhs.words[i];
+      changed |= old ^ words[i];
+    }
+    return changed != 0;
+  }
+
+  // this &= ~rhs
+  void Subtract(const BitVector &rhs) {
+    assert(numBits == rhs.numBits && "size mismatch");
+    for (size_t i = 0; i < words.size(); ++i) {
+      words[i] &= ~rhs.words[i];
+    }
+  }
+
+  // this |= (lhs & ~rhs), return true if any bit changed
+  bool UnionWithDifference(const BitVector &lhs, const BitVector &rhs) {
+    assert(numBits == lhs.numBits && numBits == rhs.numBits &&
+           "size mismatch");
+    Word changed = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+      Word old = words[i];
+      words[i] |= lhs.words[i] & ~rhs.words[i];
+      changed |= old ^ words[i];
+    }
+    return changed != 0;
+  }
+
+  BitVector &operator|=(const BitVector &rhs) {
+    Union(rhs);
+    return *this;
+  }
+
+  BitVector &operator&=(const BitVector &rhs) {
+    assert(numBits == rhs.numBits && "size mismatch");
+    for (size_t i = 0; i < words.size(); ++i) {
+      words[i] &= rhs.words[i];
+    }
+    return *this;
+  }
+
+  bool operator==(const BitVector &rhs) const {
+    return numBits == rhs.numBits && words == rhs.words;
+  }
+  bool operator!=(const BitVector &rhs) const { return !(*this == rhs); }
+
+  const std::vector<Word> &GetWords() const { return words; }
+
+private:
+  static size_t NumWords(size_t bits) {
+    return (bits + kWordBits - 1) / kWordBits;
+  }
+
+  // keep bits past the end zeroed, Count and operator== rely on it
+  void ClearUnusedBits() {
+    if (numBits % kWordBits != 0) {
+      words.back() &= ~(~Word(0) << (numBits % kWordBits));
+    }
+  }
+
+private:
+  std::vector<Word> words;
+  size_t numBits = 0;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+template <class T> class IList;
+
+// Base of every object that can be linked into an IList<T>. Links are
+// embedded into the object itself, so linking never allocates.
+template <class T> class IListNode {
+public:
+  IListNode() = default;
+
+  // links are identity, never copy them
+  IListNode(const IListNode &) = delete;
+  IListNode &operator=(const IListNode &) = delete;
+
+  bool IsLinked() const { return next != nullptr; }
+
+private:
+  friend class IList<T>;
+
+  IListNode *prev = nullptr;
+  IListNode *next = nullptr;
+};
+
+// Intrusive circular doubly-linked list with in-place sentinel.
+// Insertion, removal and moving elements between lists are O(1).
+template <class T> class IList {
+public:
+  using Node = IListNode<T>;
+
+  // iterates over elements as 'V *', V is T or class derived from T
+  template <class V> class IteratorImpl {
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = V *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V **;
+    using reference = V *;
+
+    IteratorImpl() = default;
+    explicit IteratorImpl(Node *node) : node(node) {}
+    template <class U>
+    IteratorImpl(const IteratorImpl<U> &rhs) : node(rhs.GetNode()) {}
+
+    V *operator*() const { return static_cast<V *>(static_cast<T *>(node)); }
+
+    IteratorImpl &operator++() {
+      node = node->next;
+      return *this;
+    }
+    IteratorImpl operator++(int) {
+      auto tmp = *this;
+      node = node->next;
+      return tmp;
+    }
+    IteratorImpl &operator--() {
+      node = node->prev;
+      return *this;
+    }
+    IteratorImpl operator--(int) {
+      auto tmp = *this;
+      node = node->prev;
+      return tmp;
+    }
+
+    template <class U> bool operator==(const IteratorImpl<U> &rhs) const {
+      return node == rhs.GetNode();
+    }
+    template <class U> bool operator!=(const IteratorImpl<U> &rhs) const {
+      return node != rhs.GetNode();
+    }
+
+    Node *GetNode() const { return node; }
+
+  private:
+    Node *node = nullptr;
+  };
+
+  using Iterator = IteratorImpl<T>;
+
+  IList() { sentinel.prev = sentinel.next = &sentinel; }
+
+  // non-movable, non-copyable: elements point to the sentinel
+  IList(const IList &) = delete;
+  IList(IList &&) = delete;
+
+  ~IList() { Clear(); }
+
+  Iterator begin() const { return Iterator(sentinel.next); }
+  Iterator end() const { return Iterator(const_cast<Node *>(&sentinel)); }
+
+  bool empty() const { return count == 0; }
+  size_t size() const { return count; }
+
+  T *Front() const {
+    assert(!empty() && "empty list");
+    return *begin();
+  }
+  T *Back() const {
+    assert(!empty() && "empty list");
+    return *--end();
+  }
+
+  static Iterator IteratorTo(T *elem) { return Iterator(elem); }
+
+  // link 'elem' before 'pos', return iterator to 'elem'
+  Iterator Insert(Iterator pos, T *elem) {
+    Node *node = elem;
+    assert(!node->IsLinked() && "element is already in a list");
+    Node *next = pos.GetNode();
+    node->prev = next->prev;
+    node->next = next;
+    next->prev->next = node;
+    next->prev = node;
+    ++count;
+    return Iterator(node);
+  }
+
+  void PushBack(T *elem) { Insert(end(), elem); }
+  void PushFront(T *elem) { Insert(begin(), elem); }
+
+  // unlink 'elem', return iterator to the next element
+  Iterator Remove(T *elem) {
+    Node *node = elem;
+    assert(node->IsLinked() && "element is not in a list");
+    Node *next = node->next;
+    node->prev->next = next;
+    next->prev = node->prev;
+    node->prev = node->next = nullptr;
+    --count;
+    return Iterator(next);
+  }
+
+  Iterator Remove(Iterator pos) { return Remove(*pos); }
+
+  // unlink all elements, elements themselves are not destroyed
+  void Clear() {
+    while (!empty()) {
+      Remove(begin());
+    }
+  }
+
+private:
+  Node sentinel;
+  size_t count = 0;
+};
+
+template <class It> class IteratorRange {
+public:
+  IteratorRange(It first, It last) : first(first), last(last) {}
+
+  It begin() const { return first; }
+  It end() const { return last; }
+  bool empty() const { return first == last; }
+
+private:
+  It first;
+  It last;
+};
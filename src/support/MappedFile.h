@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Whole file mapped read-only into memory. The mapping is page aligned,
+// so records at 8-byte aligned offsets can be read in place.
+class MappedFile {
+public:
+  // nullptr if the file can't be opened or mapped
+  static std::unique_ptr<MappedFile> Open(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const void *GetData() const { return data; }
+  size_t GetSize() const { return size; }
+
+private:
+  MappedFile(void *data, size_t size) : data(data), size(size) {}
+
+private:
+  void *data;
+  size_t size;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open addressing hash map whose insertions are undone scope by scope, for
+// walks over trees: an entry inserted in a scope shadows the outer one
+// with the same key until the scope is popped. Every insertion is logged
+// with the value it shadowed, PopScope replays the log backwards. Linear
+// probing, erased entries shift the following ones back so no tombstones
+// are left.
+template <class K, class V, class Hash>
+class ScopedHashMap {
+public:
+  ScopedHashMap() { slots.resize(kMinCapacity); }
+
+  size_t size() const { return numElems; }
+  bool empty() const { return numElems == 0; }
+  size_t GetNumScopes() const { return scopes.size(); }
+
+  // value visible for 'key', nullptr if there is none
+  V *Find(const K &key) {
+    Slot &slot = Lookup(key, GetHash(key));
+    return slot.used ? &slot.value : nullptr;
+  }
+
+  // insert 'value' for 'key' in the innermost scope
+  void Insert(const K &key, V value) {
+    assert(!scopes.empty() && "insertion outside of a scope");
+    uint32_t hash = GetHash(key);
+    Slot *slot = &Lookup(key, hash);
+    if (slot->used) {
+      log.push_back({key, std::move(slot->value), true});
+      slot->value = std::move(value);
+      return;
+    }
+    log.push_back({key, V{}, false});
+    if (2 * (numElems + 1) > slots.size()) {
+      Grow();
+      slot = &Lookup(key, hash);
+    }
+    slot->key = key;
+    slot->value = std::move(value);
+    slot->hash = hash;
+    slot->used = true;
+    ++numElems;
+  }
+
+  void PushScope() { scopes.push_back(log.size()); }
+
+  // undo the insertions of the innermost scope, newest first
+  void PopScope() {
+    assert(!scopes.empty() && "no scope to pop");
+    size_t first = scopes.back();
+    scopes.pop_back();
+    while (log.size() > first) {
+      LogEntry &entry = log.back();
+      Slot &slot = Lookup(entry.key, GetHash(entry.key));
+      assert(slot.used && "logged key is missing");
+      if (entry.shadowed) {
+        slot.value = std::move(entry.value);
+      } else {
+        Erase(&slot - slots.data());
+      }
+      log.pop_back();
+    }
+  }
+
+private:
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    K key{};
+    V value{};
+    uint32_t hash = 0;
+    bool used = false;
+  };
+
+  struct LogEntry {
+    K key;
+    // value of the outer scope, valid if 'shadowed'
+    V value;
+    bool shadowed;
+  };
+
+  static uint32_t GetHash(const K &key) {
+    return static_cast<uint32_t>(Hash()(key));
+  }
+
+  // slot of 'key' or the empty slot where it belongs
+  Slot &Lookup(const K &key, uint32_t hash) {
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot &slot = slots[i];
+      if (!slot.used || (slot.hash == hash && slot.key == key)) {
+        return slot;
+      }
+    }
+  }
+
+  // empty slot 'hole' and move back the entries probed past it
+  void Erase(size_t hole) {
+    size_t mask = slots.size() - 1;
+    slots[hole].used = false;
+    --numElems;
+    for (size_t i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask) {
+      size_t home = slots[i].hash & mask;
+      // the entry may move unless the hole is before its home slot
+      if (((i - home) & mask) >= ((i - hole) & mask)) {
+        slots[hole] = std::move(slots[i]);
+        slots[i].used = false;
+        hole = i;
+      }
+    }
+  }
+
+  void Grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (auto &slot : old) {
+      if (!slot.used) {
+        continue;
+      }
+      size_t i = slot.hash & mask;
+      while (slots[i].used) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = std::move(slot);
+    }
+  }
+
+private:
+  std::vector<Slot> slots;
+  size_t numElems = 0;
+  std::vector<LogEntry> log;
+  // size of the log when the scope was pushed
+  std::vector<size_t> scopes;
+};
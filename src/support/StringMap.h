@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Open addressing hash map from strings to values with linear probing.
+// Keys are views, the strings must outlive the map. Slots are stamped with
+// the epoch they were filled in, Clear is O(1) and keeps the capacity.
+template <class T>
+class StringMap {
+public:
+  StringMap() { slots.resize(kMinCapacity); }
+
+  size_t size() const { return numElems; }
+  bool empty() const { return numElems == 0; }
+
+  // pointer to the value of 'key', nullptr if there is none
+  T *Find(std::string_view key) {
+    Slot &slot = Lookup(key, Hash(key));
+    return slot.epoch == epoch ? &slot.value : nullptr;
+  }
+  const T *Find(std::string_view key) const {
+    return const_cast<StringMap *>(this)->Find(key);
+  }
+
+  // insert 'value' unless 'key' is present, the second element is true if
+  // inserted
+  std::pair<T *, bool> Insert(std::string_view key, T value) {
+    uint32_t hash = Hash(key);
+    Slot *slot = &Lookup(key, hash);
+    if (slot->epoch == epoch) {
+      return {&slot->value, false};
+    }
+    if (2 * (numElems + 1) > slots.size()) {
+      Grow();
+      slot = &Lookup(key, hash);
+    }
+    slot->key = key;
+    slot->hash = hash;
+    slot->epoch = epoch;
+    slot->value = std::move(value);
+    ++numElems;
+    return {&slot->value, true};
+  }
+
+  void Clear() {
+    numElems = 0;
+    if (++epoch == 0) {
+      // stamps wrapped around, reset them for real
+      for (auto &slot : slots) {
+        slot.epoch = 0;
+      }
+      epoch = 1;
+    }
+  }
+
+  // FNV-1a
+  static uint32_t Hash(std::string_view key) {
+    uint32_t hash = 2166136261u;
+    for (char c : key) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+  }
+
+private:
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    std::string_view key;
+    uint32_t hash = 0;
+    // the slot is occupied if stamped with the current epoch
+    uint32_t epoch = 0;
+    T value{};
+  };
+
+  // slot of 'key' or the empty slot where it belongs
+  Slot &Lookup(std::string_view key, uint32_t hash) {
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot &slot = slots[i];
+      if (slot.epoch != epoch || (slot.hash == hash && slot.key == key)) {
+        return slot;
+      }
+    }
+  }
+
+  void Grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    uint32_t oldEpoch = epoch;
+    epoch = 1;
+    size_t mask = slots.size() - 1;
+    for (auto &slot : old) {
+      if (slot.epoch != oldEpoch) {
+        continue;
+      }
+      size_t i = slot.hash & mask;
+      while (slots[i].epoch == epoch) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = std::move(slot);
+      slots[i].epoch = epoch;
+    }
+  }
+
+private:
+  std::vector<Slot> slots;
+  size_t numElems = 0;
+  uint32_t epoch = 1;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a task queue: it takes its
+// own tasks from the back and, when the queue is empty, steals from the
+// front of the other queues. Submitted tasks are spread over the queues
+// round-robin.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(size_t numThreads);
+  // wait for the submitted tasks and join the workers
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void Submit(Task task);
+  // block until every submitted task has finished, must not be called
+  // from a task
+  void Wait();
+
+  // run 'func(i)' for every i in [0, size) and wait for all of them
+  template <class Func>
+  void ParallelFor(size_t size, const Func &func) {
+    for (size_t i = 0; i < size; ++i) {
+      Submit([&func, i] { func(i); });
+    }
+    Wait();
+  }
+
+  size_t GetNumThreads() const { return workers.size(); }
+  // tasks taken from the queue of another worker
+  uint64_t GetNumSteals() const { return numSteals.load(); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void WorkerLoop(size_t index);
+  bool PopOwn(size_t index, Task &task);
+  bool Steal(size_t index, Task &task);
+
+private:
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> nextQueue{0};
+
+  // 'queued' grows under 'mutex' only, so a worker going to sleep can't
+  // miss a new task
+  std::mutex mutex;
+  std::condition_variable workAvailable;
+  std::condition_variable allDone;
+  std::atomic<size_t> queued{0};
+  std::atomic<size_t> unfinished{0};
+  bool stop = false;
+
+  std::atomic<uint64_t> numSteals{0};
+};
@@ -0,0 +1,36 @@
+#include <support/MappedFile.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  size_t size = st.st_size;
+  void *data = nullptr;
+  // empty files can't be mapped
+  if (size != 0) {
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // the mapping outlives the descriptor
+  close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(new MappedFile(data, size));
+}
+
+MappedFile::~MappedFile() {
+  if (data) {
+    munmap(data, size);
+  }
+}
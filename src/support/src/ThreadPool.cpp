@@ -0,0 +1,94 @@
+#include <support/ThreadPool.h>
+
+#include <cassert>
+
+ThreadPool::ThreadPool(size_t numThreads) {
+  assert(numThreads != 0 && "empty thread pool");
+  for (size_t i = 0; i < numThreads; ++i) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 0; i < numThreads; ++i) {
+    workers.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  workAvailable.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Submit(Task task) {
+  ++unfinished;
+  // counted before it can be taken, so a worker's decrement never goes
+  // below zero
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++queued;
+  }
+  Queue &queue = *queues[nextQueue++ % queues.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  workAvailable.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  allDone.wait(lock, [this] { return unfinished.load() == 0; });
+}
+
+bool ThreadPool::PopOwn(size_t index, Task &task) {
+  Queue &queue = *queues[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::Steal(size_t index, Task &task) {
+  for (size_t i = 1; i < queues.size(); ++i) {
+    Queue &queue = *queues[(index + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      ++numSteals;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+  Task task;
+  while (true) {
+    if (PopOwn(index, task) || Steal(index, task)) {
+      --queued;
+      task();
+      task = nullptr;
+      if (--unfinished == 0) {
+        // 'Wait' checks the counter under the mutex
+        std::lock_guard<std::mutex> lock(mutex);
+        allDone.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workAvailable.wait(lock, [this] { return stop || queued.load() != 0; });
+    if (stop && queued.load() == 0) {
+      return;
+    }
+  }
+}